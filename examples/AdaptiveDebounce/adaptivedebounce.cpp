@@ -0,0 +1,209 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Simulation of bouncing switches and an encoder on DebouncedIn, runs on a Linux host:
+//
+//   make -C host test
+//
+// Every trace is played with a fixed and with an adaptive debounce time. An event is correct if it reports
+// the level of the transition that just settled, and it comes before the next transition starts. The latency
+// is measured from the last raw edge of a transition to its event.
+
+#include <mbedExt.h>
+#include <DebouncedIn.h>
+#include <vector>
+
+#define FIRST_PIN 64
+
+typedef struct transition {
+    uint64_t settleUs;
+    uint64_t nextUs;
+    int level;
+}transition_t;
+
+typedef struct result {
+    uint32_t correct;
+    uint32_t events;
+    double latencyUs;
+}result_t;
+
+uint32_t rngState = 4711;
+int pinCount = 0;
+int failures = 0;
+
+// xorshift32, reproducible on every host
+uint32_t rng() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+uint32_t randomBetween(uint32_t min, uint32_t max) {
+    return min + rng() % (max - min + 1);
+}
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * Generates transitions with up to maxBounces bounces, the gaps between the bounce edges are within the given limits
+ */
+std::vector<transition_t> generate(int count, uint32_t maxBounces, uint32_t minGapUs, uint32_t maxGapUs,
+        uint32_t minStableUs, uint32_t maxStableUs, std::vector<std::vector<uint64_t>> & edges) {
+    std::vector<transition_t> transitions;
+    uint64_t now = 100000;
+    int level = 0;
+
+    for (int i = 0; i < count; i++) {
+        level = !level;
+        std::vector<uint64_t> burst;
+        uint32_t bounces = randomBetween(0, maxBounces);
+        for (uint32_t j = 0; j < bounces * 2; j++) {
+            burst.push_back(now);
+            now += randomBetween(minGapUs, maxGapUs);
+        }
+        burst.push_back(now);
+        edges.push_back(burst);
+
+        if (!transitions.empty()) {
+            transitions.back().nextUs = burst.front();
+        }
+        transitions.push_back({now, UINT64_MAX, level});
+        now += randomBetween(minStableUs, maxStableUs);
+    }
+    return transitions;
+}
+
+/**
+ * Plays the edges on a new pin and compares the events of a DebouncedIn with the transitions
+ */
+result_t play(const std::vector<transition_t> & transitions, const std::vector<std::vector<uint64_t>> & edges,
+        uint32_t debounceUs, bool adaptive, uint32_t minUs, uint32_t maxUs, DebouncedIn ** out = nullptr) {
+    int pin = FIRST_PIN + pinCount++;
+    SimGpio::set(pin, 0);
+    uint64_t start = SimClock::now();
+
+    std::vector<std::pair<uint64_t, int>> events;
+    DebouncedIn * input = new DebouncedIn((PinName)pin, PullNone, debounceUs);
+    if (adaptive) {
+        input->setAdaptive(true, minUs, maxUs);
+    }
+    input->rise([&events]() {events.push_back({SimClock::now(), 1});});
+    input->fall([&events]() {events.push_back({SimClock::now(), 0});});
+
+    uint64_t end = 0;
+    for (size_t i = 0; i < edges.size(); i++) {
+        int level = transitions[i].level;
+        for (size_t j = 0; j < edges[i].size(); j++) {
+            int value = j % 2 == 0 ? level : !level;
+            SimClock::schedule((start + edges[i][j]) * 1000, [pin, value]() {SimGpio::set(pin, value);});
+        }
+        end = start + edges[i].back();
+    }
+    SimClock::advance(end + 1000000 - SimClock::now());
+
+    result_t result = {0, (uint32_t)events.size(), 0};
+    double latency = 0;
+    size_t next = 0;
+    for (const transition_t & transition : transitions) {
+        // the first event after the transition settled
+        while (next < events.size() && events[next].first - start < transition.settleUs) {
+            next++;
+        }
+        if (next < events.size() && events[next].first - start < transition.nextUs && events[next].second == transition.level) {
+            result.correct++;
+            latency += events[next].first - start - transition.settleUs;
+            next++;
+        }
+    }
+    result.latencyUs = result.correct > 0 ? latency / result.correct : 0;
+
+    if (out != nullptr) {
+        *out = input;
+    }else{
+        delete input;
+    }
+    return result;
+}
+
+void print(const char * what, size_t transitions, const result_t & result) {
+    printf("%-24s %4u / %4u correct, %4u events, latency %8.1f us\n", what, (unsigned)result.correct,
+            (unsigned)transitions, (unsigned)result.events, result.latencyUs);
+}
+
+int main() {
+    // switch bouncing for up to 3 ms, the gaps are at most 500 us
+    std::vector<std::vector<uint64_t>> edges;
+    std::vector<transition_t> transitions = generate(116, 6, 20, 500, 50000, 300000, edges);
+    result_t fixed = play(transitions, edges, DEFAULT_DEBOUNCE_TIME_US, false, 0, 0);
+    result_t adaptive = play(transitions, edges, DEFAULT_DEBOUNCE_TIME_US, true, DEFAULT_ADAPTIVE_MIN_US, DEFAULT_ADAPTIVE_MAX_US);
+
+    printf("bouncing switch, %u transitions\n", (unsigned)transitions.size());
+    print("  fixed 10 ms", transitions.size(), fixed);
+    print("  adaptive from 10 ms", transitions.size(), adaptive);
+    check(fixed.correct == transitions.size() && fixed.events == transitions.size(), "switch: fixed events");
+    check(adaptive.correct == transitions.size() && adaptive.events == transitions.size(), "switch: adaptive events");
+    check(adaptive.latencyUs < fixed.latencyUs / 2, "switch: adaptive latency below half");
+
+    // worn switch with gaps of up to 12 ms between its bounces
+    edges.clear();
+    transitions = generate(49, 3, 100, 12000, 200000, 600000, edges);
+    result_t short10 = play(transitions, edges, 10000, false, 0, 0);
+    result_t long30 = play(transitions, edges, 30000, false, 0, 0);
+    DebouncedIn * worn;
+    adaptive = play(transitions, edges, 10000, true, DEFAULT_ADAPTIVE_MIN_US, DEFAULT_ADAPTIVE_MAX_US, &worn);
+    debounce_stats_t stats = worn->getStats();
+
+    printf("\nworn switch, %u transitions\n", (unsigned)transitions.size());
+    print("  fixed 10 ms", transitions.size(), short10);
+    print("  fixed 30 ms", transitions.size(), long30);
+    print("  adaptive from 10 ms", transitions.size(), adaptive);
+    printf("  adaptive: %u undershoots, %u glitches, debounce time %u us\n", (unsigned)stats.undershoots,
+            (unsigned)stats.glitches, (unsigned)worn->getDebounceTime());
+    check(short10.events > transitions.size(), "worn: fixed 10 ms has extra events");
+    check(long30.correct == transitions.size() && long30.events == transitions.size(), "worn: fixed 30 ms events");
+    check(adaptive.correct == transitions.size() && adaptive.events == transitions.size(), "worn: adaptive events");
+    check(adaptive.latencyUs < long30.latencyUs, "worn: adaptive latency below 30 ms");
+    // the undershoots must have raised the debounce time above the longest gap
+    check(stats.undershoots > 0 && worn->getDebounceTime() > 12000, "worn: undershoots raise debounce time");
+    delete worn;
+
+    // encoder channel with edges every 2.5 to 6 ms and short bounces
+    edges.clear();
+    transitions = generate(4515, 2, 10, 150, 2500, 6000, edges);
+    fixed = play(transitions, edges, 1000, false, 0, 0);
+    adaptive = play(transitions, edges, 1000, true, 100, 2000);
+
+    printf("\nencoder, %u transitions\n", (unsigned)transitions.size());
+    print("  fixed 1 ms", transitions.size(), fixed);
+    print("  adaptive from 1 ms", transitions.size(), adaptive);
+    check(fixed.correct == transitions.size() && fixed.events == transitions.size(), "encoder: fixed events");
+    check(adaptive.correct == transitions.size() && adaptive.events == transitions.size(), "encoder: adaptive events");
+    check(adaptive.latencyUs < 500, "encoder: adaptive latency below 0.5 ms");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,71 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <mbedExt.h>
+#include <I2CUtil.h>
+
+#define MPU6050_ADDRESS 0x68
+#define MPU6050_RA_ACCEL_CONFIG 0x1C
+
+// fields of the MPU6050 ACCEL_CONFIG register
+typedef BitField<3, 2> AccelRange;
+typedef BitField<5> SelfTestZ;
+typedef BitField<6> SelfTestY;
+typedef BitField<7> SelfTestX;
+typedef Register<uint8_t, AccelRange, SelfTestZ, SelfTestY, SelfTestX> AccelConfig;
+
+// everything is evaluated at compile time
+static_assert(AccelRange::mask == 0x18, "mask is computed from offset and width");
+static_assert(AccelRange::maxValue == 0x03, "a 2-bit field holds values up to 3");
+static_assert(AccelRange::get(0xFF) == 0x03, "get extracts and shifts the field");
+static_assert(AccelRange::set(0x00, 0x02) == 0x10, "set shifts the value into position");
+static_assert(AccelRange::set(0xFF, 0x00) == 0xE7, "set leaves the other bits untouched");
+static_assert(AccelRange::set(0x00, 0x07) == 0x18, "values wider than the field are truncated");
+static_assert(AccelConfig::mask == 0xF8, "register mask covers all fields");
+static_assert(AccelConfig::modify(0x07, AccelRange::of(1) | SelfTestX::of(1)) == 0x8F, "multiple fields in one step");
+static_assert(AccelConfig::modify(0x00, AccelRange::of(3) | AccelRange::of(1)) == 0x08, "the last value of a field wins");
+static_assert(!AccelConfig::replacesAll(AccelRange::of(1)), "a single field needs a read-modify-write");
+static_assert(AccelConfig::get<SelfTestY>(0x40) == 1, "fields can be read through the register");
+static_assert(BitField<0, 16, uint16_t>::maxValue == 0xFFFF, "fields can span the whole register");
+static_assert(bitWrite<uint8_t>(0x00, 7, true) == 0x80 && bitRead<uint8_t>(0x80, 7), "typed bit helpers");
+static_assert(highByte(0xABCD) == 0xAB && lowByte(0xABCD) == 0xCD && combineUint16(0xAB, 0xCD) == 0xABCD, "byte helpers");
+
+I2C i2c(I2C_SDA, I2C_SCL);
+Serial serial(USBTX, USBRX);
+
+int main() {
+  uint8_t config;
+
+  if (I2CUtil::readByte(&i2c, MPU6050_ADDRESS, MPU6050_RA_ACCEL_CONFIG, &config) == I2C_OK) {
+    // set the +-8g range and disable all self tests with a single write
+    config = AccelConfig::modify(config, AccelRange::of(2) | SelfTestX::of(0) | SelfTestY::of(0) | SelfTestZ::of(0));
+    I2CUtil::writeByte(&i2c, MPU6050_ADDRESS, MPU6050_RA_ACCEL_CONFIG, config);
+
+    serial.printf("Accelerometer range: %d\n", AccelConfig::get<AccelRange>(config));
+  }
+
+  while(1) {
+    sleep();
+  }
+}
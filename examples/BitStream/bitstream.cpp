@@ -0,0 +1,214 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Round-trip fuzz test and benchmark of BitWriter / BitReader, runs on a Linux host:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <BitStream.h>
+#include <Benchmark.h>
+
+#define FUZZ_ROUNDS 10000
+#define MAX_FIELDS 64
+
+typedef enum field_kind {
+    FIELD_UNSIGNED,
+    FIELD_SIGNED,
+    FIELD_VARINT,
+    FIELD_SIGNED_VARINT
+}field_kind_t;
+
+typedef struct field {
+    field_kind_t kind;
+    uint8_t numBits;
+    uint32_t value;
+}field_t;
+
+uint32_t rngState = 1234;
+int failures = 0;
+
+// xorshift32, reproducible on every host
+uint32_t rng() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+uint32_t mask(uint8_t numBits) {
+    return numBits == 32 ? 0xFFFFFFFF : ((uint32_t)1 << numBits) - 1;
+}
+
+// random value that fits into the field, biased towards small and extreme values
+field_t randomField() {
+    field_t field;
+    field.kind = (field_kind_t)(rng() % 4);
+    field.numBits = 1 + rng() % 32;
+
+    uint32_t value = rng();
+    switch (rng() % 4) {
+        case 0: value &= 0xFF; break;
+        case 1: value = 0xFFFFFFFF; break;
+        case 2: value = 0; break;
+    }
+
+    if (field.kind == FIELD_SIGNED) {
+        // a zigzag encoded value of numBits holds -2^(numBits - 1) ... 2^(numBits - 1) - 1
+        int32_t v = (int32_t)value >> (32 - field.numBits);
+        field.value = (uint32_t)v;
+    } else if (field.kind == FIELD_UNSIGNED) {
+        field.value = value & mask(field.numBits);
+    } else {
+        field.value = value >> (rng() % 32);
+    }
+    return field;
+}
+
+bool writeField(BitWriter * writer, const field_t & field) {
+    switch (field.kind) {
+        case FIELD_UNSIGNED: return writer->write(field.value, field.numBits);
+        case FIELD_SIGNED: return writer->writeSigned((int32_t)field.value, field.numBits);
+        case FIELD_VARINT: return writer->writeVarint(field.value);
+        default: return writer->writeSignedVarint((int32_t)field.value);
+    }
+}
+
+uint32_t readField(BitReader * reader, const field_t & field) {
+    switch (field.kind) {
+        case FIELD_UNSIGNED: return reader->read(field.numBits);
+        case FIELD_SIGNED: return (uint32_t)reader->readSigned(field.numBits);
+        case FIELD_VARINT: return reader->readVarint();
+        default: return (uint32_t)reader->readSignedVarint();
+    }
+}
+
+// writes random fields into a buffer of random size and reads them back
+bool fuzzRound() {
+    field_t fields[MAX_FIELDS];
+    uint8_t buffer[MAX_FIELDS * 5 + 8];
+    size_t numFields = 1 + rng() % MAX_FIELDS;
+    size_t size = rng() % sizeof(buffer);
+
+    BitWriter writer(buffer, size);
+    size_t written = 0;
+    for (size_t i = 0; i < numFields; i++) {
+        fields[i] = randomField();
+        size_t before = writer.bitsWritten();
+        if (!writeField(&writer, fields[i])) {
+            // a rejected field must not change the stream
+            if (writer.bitsWritten() != before || !writer.hasOverflowed()) {
+                return false;
+            }
+            break;
+        }
+        written++;
+    }
+
+    size_t bits = writer.bitsWritten();
+    size_t bytes = writer.flush();
+    if (bytes != (bits + 7) / 8 || bytes > size) {
+        return false;
+    }
+
+    BitReader reader(buffer, bytes);
+    for (size_t i = 0; i < written; i++) {
+        if (readField(&reader, fields[i]) != fields[i].value || reader.hasOverflowed()) {
+            return false;
+        }
+    }
+
+    // only the padding of the last byte is left
+    if (reader.bitsRemaining() >= 8) {
+        return false;
+    }
+    reader.read(8);
+    return reader.hasOverflowed();
+}
+
+uint8_t packet[4096];
+uint16_t samples[2048];
+
+int main() {
+    // fixed layout
+    uint8_t buffer[8] = {};
+    BitWriter writer(buffer, sizeof(buffer));
+    writer.write(0x3FF, 10);
+    writer.write(0x000, 12);
+    writer.writeSigned(-3, 5);
+    writer.writeBool(true);
+    check(writer.flush() == 4 && buffer[0] == 0xFF && buffer[1] == 0x03 && buffer[2] == 0x40 && buffer[3] == 0x09, "fields are packed LSB first");
+    check(BitWriter::zigzagEncode(-1) == 1 && BitWriter::zigzagEncode(1) == 2 && BitReader::zigzagDecode(0xFFFFFFFF) == INT32_MIN, "zigzag encoding");
+
+    BitWriter varints(buffer, sizeof(buffer));
+    varints.writeVarint(300);
+    check(varints.flush() == 2 && buffer[0] == 0xAC && buffer[1] == 0x02, "varint encoding");
+
+    bool ok = true;
+    for (int i = 0; i < FUZZ_ROUNDS && ok; i++) {
+        ok = fuzzRound();
+    }
+    check(ok, "fuzzed round trips");
+
+    // 12-bit samples, like the ADC values of an uplink
+    for (size_t i = 0; i < 2048; i++) {
+        samples[i] = rng() & 0xFFF;
+    }
+    const size_t packedBytes = 2048 * 12 / 8;
+
+    printf("\n2048 12-bit fields (%u bytes)\n", (unsigned)packedBytes);
+    benchmarkReport("BitWriter", benchmarkNs([] {
+        BitWriter writer(packet, sizeof(packet));
+        for (size_t i = 0; i < 2048; i++) {
+            writer.write(samples[i], 12);
+        }
+        writer.flush();
+        benchmarkKeep(packet);
+    }), packedBytes);
+    benchmarkReport("BitReader", benchmarkNs([] {
+        BitReader reader(packet, packedBytes);
+        uint32_t sum = 0;
+        for (size_t i = 0; i < 2048; i++) {
+            sum += reader.read(12);
+        }
+        benchmarkKeep(&sum);
+    }), packedBytes);
+    benchmarkReport("bit by bit", benchmarkNs([] {
+        memset(packet, 0, packedBytes);
+        size_t pos = 0;
+        for (size_t i = 0; i < 2048; i++) {
+            for (uint8_t b = 0; b < 12; b++, pos++) {
+                packet[pos / 8] |= ((samples[i] >> b) & 1) << (pos % 8);
+            }
+        }
+        benchmarkKeep(packet);
+    }), packedBytes);
+
+    return failures == 0 ? 0 : 1;
+}
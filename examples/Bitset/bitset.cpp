@@ -0,0 +1,124 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Benchmark of scanning sparse bitsets, runs on a Linux host:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <Bitset.h>
+#include <Benchmark.h>
+
+#define NUM_BITS 1024
+
+// set at compile time
+constexpr Bitset<NUM_BITS> makeSparse() {
+    Bitset<NUM_BITS> set;
+    set.set(3);
+    set.set(500);
+    set.set(1023);
+    return set;
+}
+static_assert(makeSparse().count() == 3 && makeSparse().findFirst() == 3 && makeSparse().findNext(3) == 500, "constexpr operations");
+static_assert(makeSparse().findLast() == 1023 && makeSparse().findNext(1023) == NUM_BITS, "search to the end");
+static_assert((~makeSparse()).count() == NUM_BITS - 3, "complement");
+
+Bitset<NUM_BITS> sparse;
+Bitset<NUM_BITS> other;
+uint8_t bytes[NUM_BITS / 8];
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+int main() {
+    // 16 bits set, like a few dirty channels or devices on a bus
+    uint32_t expectedSum = 0;
+    for (size_t i = 0; i < 16; i++) {
+        size_t pos = (i * 613 + 41) % NUM_BITS;
+        sparse.set(pos);
+        bit_set(bytes[pos / 8], pos % 8);
+        expectedSum += pos;
+    }
+    for (size_t i = 0; i < NUM_BITS; i += 3) {
+        other.set(i);
+    }
+
+    uint32_t sum = 0;
+    size_t last = 0;
+    bool ascending = true;
+    for (size_t pos : sparse) {
+        ascending &= sum == 0 || pos > last;
+        sum += pos;
+        last = pos;
+    }
+    check(sparse.count() == 16 && sum == expectedSum && ascending, "iteration over set bits");
+
+    size_t common = 0;
+    for (size_t i = 0; i < NUM_BITS; i++) {
+        common += sparse.test(i) && other.test(i);
+    }
+    check((sparse & other).count() == common, "intersection");
+    check((sparse | other).count() == sparse.count() + other.count() - common, "union");
+    check((sparse ^ sparse).none() && (sparse | ~sparse).all(), "complement and difference");
+
+    printf("\n%d bits, 16 set\n", NUM_BITS);
+    benchmarkReport("scan byte array with bit_read", benchmarkNs([] {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < NUM_BITS; i++) {
+            if (bit_read(bytes[i / 8], i % 8)) {
+                sum += i;
+            }
+        }
+        benchmarkKeep(&sum);
+    }));
+    benchmarkReport("scan Bitset with test()", benchmarkNs([] {
+        uint32_t sum = 0;
+        for (size_t i = 0; i < NUM_BITS; i++) {
+            if (sparse.test(i)) {
+                sum += i;
+            }
+        }
+        benchmarkKeep(&sum);
+    }));
+    benchmarkReport("iterate Bitset", benchmarkNs([] {
+        uint32_t sum = 0;
+        for (size_t pos : sparse) {
+            sum += pos;
+        }
+        benchmarkKeep(&sum);
+    }));
+    benchmarkReport("count()", benchmarkNs([] {
+        size_t count = sparse.count();
+        benchmarkKeep(&count);
+    }));
+    benchmarkReport("intersection", benchmarkNs([] {
+        Bitset<NUM_BITS> result = sparse & other;
+        benchmarkKeep(&result);
+    }));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -27,6 +27,7 @@ SOFTWARE.
 
 // nucleo64 userbutton needs to be configured as FALL_TO_RISE
 Button button(USER_BUTTON, FALL_TO_RISE);
+StaticButtonEventQueue<8> buttonEvents;
 DigitalOut led(LED1);
 
 void onClick() {
@@ -54,17 +55,28 @@ void onDoubleClick() {
 }
 
 int main() {
-  // attach ISR for button click
+  // attach handler for button click
   button.onClick(&onClick);
 
-  // attach ISR for button double click
+  // attach handler for button double click
   button.onDoubleClick(&onDoubleClick);
 
-  // attach ISR for button press
+  // attach handler for button long click
   button.onLongClick(&onLongClick);
 
+  // the handlers block with wait_us, so don't call them in the ISR but from the main loop
+  buttonEvents.attach(&button);
+
   while(1) {
-    // do nothing, everything is handled by interrupts
-    sleep();
+    // call the handlers of the posted events
+    buttonEvents.dispatch();
+
+    // an event posted after dispatch() returned would otherwise wait for the next interrupt. With
+    // interrupts disabled, a pending interrupt still ends the sleep and runs after the critical section
+    core_util_critical_section_enter();
+    if (buttonEvents.size() == 0) {
+      sleep();
+    }
+    core_util_critical_section_exit();
   }
 }
@@ -0,0 +1,283 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Simulation of thousands of button presses, runs on a Linux host:
+//
+//   make -C host test
+//
+// Random clicks, double clicks and long clicks with bouncing contacts are played on 16 buttons. The events
+// of ButtonManager and of 16 Button objects are compared with the gestures that were played.
+// Then the timing, N clicks, auto repeat, chords and the limit of setTiming are checked on single buttons.
+
+#include <mbedExt.h>
+#include <Button.h>
+#include <ButtonManager.h>
+#include <vector>
+
+#define NUM_BUTTONS 16
+#define FIRST_PIN 32
+#define DURATION_US 300000000ULL
+#define MAX_BOUNCES 8
+
+uint32_t rngState = 4711;
+std::vector<uint8_t> expected[NUM_BUTTONS];
+std::vector<uint8_t> managerEvents[NUM_BUTTONS];
+std::vector<uint8_t> buttonEvents[NUM_BUTTONS];
+uint32_t rawEdges = 0;
+int failures = 0;
+
+// xorshift32, reproducible on every host
+uint32_t rng() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+uint32_t randomBetween(uint32_t min, uint32_t max) {
+    return min + rng() % (max - min + 1);
+}
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+void schedule(uint64_t us, int pin, int level) {
+    SimClock::schedule(us * 1000, [pin, level]() {SimGpio::set(pin, level);});
+    rawEdges++;
+}
+
+/**
+ * Schedules an edge with up to 8 bounces within 2 ms before the final level
+ */
+void scheduleEdge(uint64_t us, int pin, int level) {
+    int bounces = randomBetween(0, MAX_BOUNCES);
+    for (int i = 0; i < bounces; i++) {
+        schedule(us + i * 250, pin, i % 2 == 0 ? level : !level);
+    }
+    schedule(us + bounces * 250, pin, level);
+}
+
+/**
+ * Presses a button at a time for a duration
+ * @return the time of the release in us
+ */
+uint64_t press(uint64_t us, int button, uint32_t durationMs) {
+    scheduleEdge(us, FIRST_PIN + button, 1);
+    scheduleEdge(us + durationMs * 1000, FIRST_PIN + button, 0);
+    return us + durationMs * 1000;
+}
+
+/**
+ * Plays random gestures on a button until the end of the simulation. The timing keeps a safe distance
+ * to the press threshold (500 ms) and the double click delay (250 ms) of both implementations
+ */
+void generateGestures(int button) {
+    uint64_t now = randomBetween(0, 500) * 1000;
+
+    while (now + 2000000 < DURATION_US) {
+        switch (rng() % 3) {
+            case 0:
+                now = press(now, button, randomBetween(30, 300));
+                expected[button].push_back(BUTTON_CLICK);
+                break;
+            case 1:
+                now = press(now, button, randomBetween(40, 100));
+                now = press(now + randomBetween(40, 100) * 1000, button, randomBetween(40, 100));
+                expected[button].push_back(BUTTON_DOUBLE_CLICK);
+                break;
+            default:
+                now = press(now, button, randomBetween(700, 1500));
+                expected[button].push_back(BUTTON_LONG_CLICK);
+                break;
+        }
+
+        // idle until the next gesture, longer than the double click delay
+        now += randomBetween(400, 1200) * 1000;
+    }
+}
+
+/**
+ * Runs the simulation for a time and reads the events of a manager
+ */
+template<size_t N>
+std::vector<button_event_t> runFor(ButtonManager<N> & manager, uint32_t ms) {
+    std::vector<button_event_t> events;
+    SimClock::advance(ms * 1000ULL);
+    button_event_t event;
+    while (manager.read(&event)) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+int main() {
+    size_t gestures = 0;
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        generateGestures(i);
+        gestures += expected[i].size();
+    }
+
+    // the default event mask reports clicks, double clicks and long clicks
+    ButtonManager<NUM_BUTTONS> manager;
+
+    Button * buttons[NUM_BUTTONS];
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        manager.add(FIRST_PIN + i);
+
+        buttons[i] = new Button(FIRST_PIN + i, RISE_TO_FALL);
+        buttons[i]->onClick([i]() {buttonEvents[i].push_back(BUTTON_CLICK);});
+        buttons[i]->onDoubleClick([i]() {buttonEvents[i].push_back(BUTTON_DOUBLE_CLICK);});
+        buttons[i]->onLongClick([i]() {buttonEvents[i].push_back(BUTTON_LONG_CLICK);});
+    }
+
+    while (SimClock::now() < DURATION_US) {
+        SimClock::advance(10000);
+
+        button_event_t event;
+        while (manager.read(&event)) {
+            managerEvents[event.button].push_back(event.type);
+        }
+    }
+
+    printf("%d buttons, %.0f s, %u gestures, %u raw edges\n", NUM_BUTTONS, DURATION_US / 1e6, (unsigned)gestures, (unsigned)rawEdges);
+
+    bool managerOk = manager.getDropped() == 0;
+    bool buttonOk = true;
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        managerOk &= managerEvents[i] == expected[i];
+        buttonOk &= buttonEvents[i] == expected[i];
+    }
+    check(managerOk, "ButtonManager events");
+    check(buttonOk, "Button events");
+
+    printf("RAM: ButtonManager<%d> %u bytes, Button %u bytes each\n", NUM_BUTTONS, (unsigned)sizeof(manager), (unsigned)sizeof(Button));
+    printf("ButtonManager: %u ticks, Button: %u edge interrupts\n", (unsigned)(DURATION_US / DEFAULT_BUTTON_TICK_US), (unsigned)rawEdges);
+
+    manager.stop();
+    for (int i = 0; i < NUM_BUTTONS; i++) {
+        delete buttons[i];
+    }
+
+    // timeouts with ticks that are not a whole number of ms
+    printf("\n");
+    const uint32_t ticks[] = {1500, 2500, 700};
+    for (uint32_t tickUs : ticks) {
+        static const button_gesture_config_t holdOnly = {500, 0, 1, 0, 0};
+        ButtonManager<1> timing(tickUs, 1);
+        timing.add(FIRST_PIN + NUM_BUTTONS, RISE_TO_FALL, PullNone, &holdOnly);
+        timing.setEventMask((1UL << BUTTON_DOWN) | (1UL << BUTTON_HOLD));
+
+        uint64_t start = SimClock::now();
+        press(start + 10000, NUM_BUTTONS, 800);
+        SimClock::advance(1000000);
+        timing.stop();
+
+        button_event_t down = {}, hold = {};
+        bool ok = timing.read(&down) && timing.read(&hold) && down.type == BUTTON_DOWN && hold.type == BUTTON_HOLD;
+        uint32_t holdUs = hold.timestamp - down.timestamp;
+
+        char what[64];
+        snprintf(what, sizeof(what), "hold after 500 ms with %u us tick", (unsigned)tickUs);
+        // the state machine counts whole ms, so the hold may come up to 1 ms early
+        check(ok && holdUs > 499000 && holdUs < 500000 + tickUs, what);
+    }
+
+    // N clicks: up to 5 clicks are counted and reported with their count
+    int pin = NUM_BUTTONS + 1;
+    static const button_gesture_config_t multi = {500, 250, 5, 0, 0};
+    ButtonManager<1> clicks;
+    clicks.add(FIRST_PIN + pin, RISE_TO_FALL, PullNone, &multi);
+    clicks.setEventMask((1UL << BUTTON_CLICK) | (1UL << BUTTON_DOUBLE_CLICK) | (1UL << BUTTON_MULTI_CLICK));
+
+    bool ok = true;
+    for (uint8_t n = 1; n <= 5; n++) {
+        uint64_t now = SimClock::now() + 10000;
+        for (uint8_t i = 0; i < n; i++) {
+            now = press(now, pin, 60) + 100000;
+        }
+        std::vector<button_event_t> events = runFor(clicks, 1000);
+        uint8_t type = n == 1 ? BUTTON_CLICK : n == 2 ? BUTTON_DOUBLE_CLICK : BUTTON_MULTI_CLICK;
+        ok &= events.size() == 1 && events[0].type == type && events[0].count == n;
+    }
+    check(ok, "1 to 5 clicks");
+    clicks.stop();
+
+    // auto repeat: hold after 500 ms, first repeat 400 ms later, then every 100 ms until the release
+    pin++;
+    static const button_gesture_config_t arrowKeys = {500, 0, 1, 400, 100};
+    ButtonManager<1> repeat;
+    repeat.add(FIRST_PIN + pin, RISE_TO_FALL, PullNone, &arrowKeys);
+    repeat.setEventMask((1UL << BUTTON_HOLD) | (1UL << BUTTON_REPEAT) | (1UL << BUTTON_LONG_CLICK));
+
+    press(SimClock::now() + 10000, pin, 1450);
+    std::vector<button_event_t> events = runFor(repeat, 2000);
+    ok = events.size() == 8 && events[0].type == BUTTON_HOLD && events[7].type == BUTTON_LONG_CLICK;
+    for (size_t i = 1; ok && i < 7; i++) {
+        uint32_t sinceHold = events[i].timestamp - events[0].timestamp;
+        uint32_t expectedUs = 400000 + (i - 1) * 100000;
+        ok &= events[i].type == BUTTON_REPEAT && sinceHold > expectedUs - 2000 && sinceHold < expectedUs + 2000;
+    }
+    check(ok, "hold, 6 repeats and long click");
+    repeat.stop();
+
+    // chord: both buttons pressed together give one chord event and no clicks, alone they still click
+    pin++;
+    ButtonManager<2> chord;
+    int a = chord.add(FIRST_PIN + pin);
+    int b = chord.add(FIRST_PIN + pin + 1);
+    int both = chord.addChord((1UL << a) | (1UL << b));
+    chord.setEventMask((1UL << BUTTON_CLICK) | (1UL << BUTTON_CHORD));
+
+    uint64_t now = SimClock::now() + 10000;
+    press(now, pin, 200);
+    press(now + 30000, pin + 1, 100);
+    events = runFor(chord, 1000);
+    check(events.size() == 1 && events[0].type == BUTTON_CHORD && events[0].button == both, "chord without clicks");
+
+    press(SimClock::now() + 10000, pin + 1, 100);
+    events = runFor(chord, 1000);
+    check(events.size() == 1 && events[0].type == BUTTON_CLICK && events[0].button == b, "click after chord");
+    chord.stop();
+
+    // timing above 65535 ms is limited instead of wrapping (100000 would become 34464 ms)
+    pin += 2;
+    ButtonManager<1> slow;
+    slow.add(FIRST_PIN + pin);
+    slow.setTiming(100000, 250);
+    Button slowButton(FIRST_PIN + pin, RISE_TO_FALL);
+    slowButton.setTiming(100000, 250);
+    int buttonClicks = 0, buttonLongClicks = 0;
+    slowButton.onClick([&buttonClicks]() {buttonClicks++;});
+    slowButton.onLongClick([&buttonLongClicks]() {buttonLongClicks++;});
+
+    press(SimClock::now() + 10000, pin, 40000);
+    events = runFor(slow, 41000);
+    check(events.size() == 1 && events[0].type == BUTTON_CLICK, "ButtonManager timing limited to 65535 ms");
+    check(buttonClicks == 1 && buttonLongClicks == 0, "Button timing limited to 65535 ms");
+    slow.stop();
+
+    return failures == 0 ? 0 : 1;
+}
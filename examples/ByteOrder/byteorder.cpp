@@ -0,0 +1,112 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Benchmark of the bulk sample decoding, runs on a Linux host:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <ByteOrder.h>
+#include <Benchmark.h>
+
+// a full 1k sample FIFO of 3-axis samples, MSB first like most sensors deliver them
+#define NUM_SAMPLES 1024
+#define NUM_BYTES (NUM_SAMPLES * 6)
+
+uint8_t fifo[NUM_BYTES];
+int16_t values[NUM_SAMPLES * 3];
+int16_t reference[NUM_SAMPLES * 3];
+Vector3<int16_t> vectors[NUM_SAMPLES];
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+// sample by sample with the macros of Bytes.h
+void decodeWithMacros(const uint8_t * src, int16_t * dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = uint16_to_int16(combine_uint16(src[2 * i], src[2 * i + 1]));
+    }
+}
+
+int main() {
+    for (size_t i = 0; i < NUM_BYTES; i++) {
+        fifo[i] = (uint8_t)(i * 131 + 7);
+    }
+
+    // correctness against the macros
+    decodeWithMacros(fifo, reference, NUM_SAMPLES * 3);
+    unpackInt16(fifo, values, NUM_SAMPLES * 3, MSB_FIRST);
+    check(memcmp(values, reference, sizeof(values)) == 0, "unpackInt16 MSB first");
+
+    unpackVector3(fifo, vectors, NUM_SAMPLES, MSB_FIRST);
+    bool equal = true;
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        equal &= vectors[i].x == reference[3 * i] && vectors[i].y == reference[3 * i + 1] && vectors[i].z == reference[3 * i + 2];
+    }
+    check(equal, "unpackVector3");
+
+    // only the x axis of every sample
+    unpackInt16(fifo, values, NUM_SAMPLES, MSB_FIRST, 6);
+    equal = true;
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        equal &= values[i] == reference[3 * i];
+    }
+    check(equal, "unpackInt16 with stride");
+
+    unpackInt16(fifo, values, NUM_SAMPLES * 3, LSB_FIRST);
+    check(values[0] == (int16_t)(fifo[0] | fifo[1] << 8) && values[NUM_SAMPLES * 3 - 1] == (int16_t)(fifo[NUM_BYTES - 2] | fifo[NUM_BYTES - 1] << 8), "unpackInt16 LSB first");
+
+    int32_t words[NUM_BYTES / 4];
+    unpackInt32(fifo, words, NUM_BYTES / 4, MSB_FIRST);
+    check(words[1] == (int32_t)((uint32_t)fifo[4] << 24 | fifo[5] << 16 | fifo[6] << 8 | fifo[7]), "unpackInt32");
+
+    // decoding in place
+    uint8_t copy[NUM_BYTES];
+    memcpy(copy, fifo, NUM_BYTES);
+    unpackInt16(copy, (int16_t *)copy, NUM_SAMPLES * 3, MSB_FIRST);
+    check(memcmp(copy, reference, sizeof(copy)) == 0, "unpackInt16 in place");
+
+    printf("\n1k samples (%d bytes)\n", NUM_BYTES);
+    benchmarkReport("Bytes.h macros", benchmarkNs([] {
+        decodeWithMacros(fifo, values, NUM_SAMPLES * 3);
+        benchmarkKeep(values);
+    }), NUM_BYTES);
+    benchmarkReport("unpackInt16", benchmarkNs([] {
+        unpackInt16(fifo, values, NUM_SAMPLES * 3, MSB_FIRST);
+        benchmarkKeep(values);
+    }), NUM_BYTES);
+    benchmarkReport("unpackInt16 native order", benchmarkNs([] {
+        unpackInt16(fifo, values, NUM_SAMPLES * 3, LSB_FIRST);
+        benchmarkKeep(values);
+    }), NUM_BYTES);
+    benchmarkReport("unpackVector3", benchmarkNs([] {
+        unpackVector3(fifo, vectors, NUM_SAMPLES, MSB_FIRST);
+        benchmarkKeep(vectors);
+    }), NUM_BYTES);
+
+    return failures == 0 ? 0 : 1;
+}
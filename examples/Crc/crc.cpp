@@ -0,0 +1,113 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Check values and benchmark of the CRC engine, runs on a Linux host:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <Crc.h>
+#include <Benchmark.h>
+
+// the standard check input of the CRC catalogue
+const uint8_t CHECK_INPUT[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+#define BENCHMARK_BYTES 4096
+uint8_t data[BENCHMARK_BYTES];
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * Checks the table driven and the bitwise calculation against the check value and each other
+ */
+template<typename C>
+void checkCrc(const char * name, typename C::value_type checkValue) {
+    char what[64];
+
+    snprintf(what, sizeof(what), "%s check value", name);
+    check(C::compute(CHECK_INPUT, sizeof(CHECK_INPUT)) == checkValue, what);
+
+    snprintf(what, sizeof(what), "%s bitwise check value", name);
+    check(C::computeBitwise(CHECK_INPUT, sizeof(CHECK_INPUT)) == checkValue, what);
+
+    // all lengths and split points, which covers the sliced loops and the remaining bytes
+    bool equal = true;
+    for (size_t length = 0; length <= 64; length++) {
+        typename C::value_type expected = C::computeBitwise(data, length);
+        equal &= C::compute(data, length) == expected;
+        for (size_t split = 0; split <= length; split++) {
+            equal &= C::finalize(C::update(C::update(C::initial, data, split), data + split, length - split)) == expected;
+        }
+    }
+    snprintf(what, sizeof(what), "%s table matches bitwise", name);
+    check(equal, what);
+}
+
+/**
+ * Compares the throughput of the table driven and the bitwise calculation
+ */
+template<typename C>
+void benchmarkCrc(const char * name) {
+    char what[64];
+
+    snprintf(what, sizeof(what), "%s table", name);
+    benchmarkReport(what, benchmarkNs([] {
+        typename C::value_type crc = C::compute(data, BENCHMARK_BYTES);
+        benchmarkKeep(&crc);
+    }), BENCHMARK_BYTES);
+
+    snprintf(what, sizeof(what), "%s bitwise", name);
+    benchmarkReport(what, benchmarkNs([] {
+        typename C::value_type crc = C::computeBitwise(data, BENCHMARK_BYTES);
+        benchmarkKeep(&crc);
+    }), BENCHMARK_BYTES);
+}
+
+int main() {
+    for (size_t i = 0; i < BENCHMARK_BYTES; i++) {
+        data[i] = (uint8_t)(i * 167 + 13);
+    }
+
+    checkCrc<Crc8Smbus>("CRC-8/SMBus", 0xF4);
+    checkCrc<Crc8Sensirion>("CRC-8/Sensirion", 0xF7);
+    checkCrc<Crc16Ccitt>("CRC-16/CCITT-FALSE", 0x29B1);
+    checkCrc<Crc32>("CRC-32 slicing-by-4", 0xCBF43926);
+    checkCrc<Crc32Fast>("CRC-32 slicing-by-8", 0xCBF43926);
+
+    // example from the Sensirion datasheets
+    const uint8_t word[] = {0xBE, 0xEF};
+    check(Crc8Sensirion::compute(word, 2) == 0x92, "CRC-8/Sensirion datasheet example");
+
+    printf("\n%d bytes\n", BENCHMARK_BYTES);
+    benchmarkCrc<Crc8Smbus>("CRC-8/SMBus");
+    benchmarkCrc<Crc16Ccitt>("CRC-16/CCITT-FALSE");
+    benchmarkCrc<Crc32>("CRC-32 slicing-by-4");
+    benchmarkCrc<Crc32Fast>("CRC-32 slicing-by-8");
+
+    return failures == 0 ? 0 : 1;
+}
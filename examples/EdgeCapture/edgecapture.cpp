@@ -0,0 +1,166 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Simulation of edge capturing at 50k edges/s, runs on a Linux host:
+//
+//   make -C host test
+//
+// A 25 kHz PWM with 30 % duty cycle and a 1.2 kHz signal are captured from InterruptIn inputs, a bouncing
+// button from a DebouncedIn on a second EdgeCapture. The main loop drains the buffers every 10 ms, once
+// with a buffer that is large enough and once with one that overflows.
+
+#include <mbedExt.h>
+#include <EdgeCapture.h>
+
+#define PWM_PIN 96
+#define TACHO_PIN 97
+#define BUTTON_PIN 98
+#define OTHER_PIN 99
+
+#define DURATION_US 1000000
+#define DRAIN_US 10000
+
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+void setAt(uint64_t ns, int pin, int level) {
+    SimClock::schedule(ns, [pin, level]() {SimGpio::set(pin, level);});
+}
+
+/**
+ * Schedules one second of the PWM and the 1.2 kHz signal, starting at the current time
+ * @return the number of scheduled edges of the PWM, the 1.2 kHz signal only counts its rising edges
+ */
+uint32_t scheduleSignals(uint32_t * tachoEdges) {
+    uint64_t start = SimClock::nowNanos();
+    uint32_t pwmEdges = 0;
+    for (uint64_t us = 40; us < DURATION_US; us += 40) {
+        setAt(start + us * 1000, PWM_PIN, 1);
+        setAt(start + (us + 12) * 1000, PWM_PIN, 0);
+        pwmEdges += 2;
+    }
+
+    *tachoEdges = 0;
+    for (uint32_t i = 1; i < 1200; i++) {
+        uint64_t ns = start + i * 1000000000ULL / 1200;
+        setAt(ns, TACHO_PIN, 1);
+        setAt(ns + 100000, TACHO_PIN, 0);
+        (*tachoEdges)++;
+    }
+    return pwmEdges;
+}
+
+/**
+ * Runs one second and drains the capture every 10 ms
+ * @return the number of read events
+ */
+uint32_t run(EdgeCapture & capture, EdgeTimer * timers, size_t numTimers) {
+    edge_event_t events[64];
+    uint32_t read = 0;
+    for (uint32_t us = 0; us < DURATION_US + DRAIN_US; us += DRAIN_US) {
+        SimClock::advance(DRAIN_US);
+        size_t n;
+        while ((n = capture.read(events, 64)) > 0) {
+            for (size_t i = 0; i < numTimers; i++) {
+                timers[i].add(events, n);
+            }
+            read += n;
+        }
+    }
+    return read;
+}
+
+int main() {
+    InterruptIn pwm((PinName)PWM_PIN);
+    InterruptIn tacho((PinName)TACHO_PIN);
+    DebouncedIn button((PinName)BUTTON_PIN);
+
+    // room for 20 ms of edges, drained every 10 ms
+    StaticEdgeCapture<1024> capture;
+    int pwmChannel = capture.attach(&pwm, CAPTURE_BOTH);
+    int tachoChannel = capture.attach(&tacho, CAPTURE_RISE);
+    check(pwmChannel == 0 && tachoChannel == 1, "InterruptIn channels");
+    // the debounced edges come from the timer interrupt, they need their own capture
+    check(capture.attach(&button) == -1, "DebouncedIn rejected next to InterruptIn");
+
+    StaticEdgeCapture<16> buttonCapture;
+    DebouncedIn other((PinName)OTHER_PIN);
+    InterruptIn otherRaw((PinName)OTHER_PIN);
+    check(buttonCapture.attach(&button) == 0, "DebouncedIn channel");
+    check(buttonCapture.attach(&otherRaw) == -1, "InterruptIn rejected next to DebouncedIn");
+    check(buttonCapture.attach(&other) == 1, "second DebouncedIn channel");
+
+    // bouncing press at 0.5 s and release at 0.7 s
+    uint64_t pressNs = SimClock::nowNanos() + 500000000ULL;
+    uint64_t releaseNs = pressNs + 200000000ULL;
+    const uint32_t bounceUs[] = {0, 300, 700, 1000, 1200};
+    for (int i = 0; i < 5; i++) {
+        setAt(pressNs + bounceUs[i] * 1000, BUTTON_PIN, i % 2 == 0);
+        setAt(releaseNs + bounceUs[i] * 1000, BUTTON_PIN, i % 2 != 0);
+    }
+
+    uint32_t tachoEdges;
+    uint32_t pwmEdges = scheduleSignals(&tachoEdges);
+    EdgeTimer timers[2] = {EdgeTimer(pwmChannel), EdgeTimer(tachoChannel)};
+    uint32_t read = run(capture, timers, 2);
+
+    printf("%u edges in %.1f s, %u read, %u overflows\n", (unsigned)(pwmEdges + tachoEdges), DURATION_US / 1e6,
+            (unsigned)read, (unsigned)capture.getOverflows());
+    printf("PWM %.1f Hz, duty %.4f, tacho %.2f Hz\n", timers[0].getFrequency(), timers[0].getDutyCycle(), timers[1].getFrequency());
+    check(read == pwmEdges + tachoEdges && capture.getOverflows() == 0, "all edges read");
+    check(fabsf(timers[0].getFrequency() - 25000) < 1, "PWM frequency");
+    check(fabsf(timers[0].getDutyCycle() - 0.3f) < 0.001f, "PWM duty cycle");
+    check(fabsf(timers[1].getFrequency() - 1200) < 0.1f, "tacho frequency");
+
+    edge_event_t press, release;
+    bool ok = buttonCapture.read(&press, 1) == 1 && buttonCapture.read(&release, 1) == 1;
+    // the timestamps are the first edges of the bounces, not the end of the debounce time
+    check(ok && press.edge == EDGE_RISING && press.timestamp == pressNs / 1000
+            && release.edge == EDGE_FALLING && release.timestamp == releaseNs / 1000, "debounced edges at first bounce");
+
+    // the same traffic on a buffer for 5 ms of edges
+    StaticEdgeCapture<256> small;
+    small.attach(&pwm, CAPTURE_BOTH);
+    small.attach(&tacho, CAPTURE_RISE);
+    pwmEdges = scheduleSignals(&tachoEdges);
+    read = run(small, nullptr, 0);
+
+    uint32_t overflows = small.getOverflows();
+    printf("\n256 entries: %u read, %u overflows\n", (unsigned)read, (unsigned)overflows);
+    check(overflows > 0 && read + overflows == pwmEdges + tachoEdges, "overflows counted");
+
+    // clear() keeps the producer's counter and only moves the base
+    small.clear();
+    check(small.getOverflows() == 0 && small.available() == 0, "clear resets overflows");
+    for (int i = 0; i < 300; i++) {
+        small.capture(0, EDGE_RISING, i);
+    }
+    check(small.getOverflows() == 300 - 256 && small.available() == 256, "overflows counted after clear");
+
+    return failures == 0 ? 0 : 1;
+}
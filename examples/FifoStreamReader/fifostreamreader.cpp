@@ -0,0 +1,204 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Streams the FIFO of a simulated IMU with FifoStreamReader on a Linux host:
+//
+//   make -C host test
+
+// included first, the min / max macros of mbedExt.h break the standard headers
+#include <deque>
+#include <mbedExt.h>
+#include <FifoStreamReader.h>
+
+#define IMU_ADDRESS 0x68
+#define IMU_RA_FIFO_COUNTH 0x72
+#define IMU_RA_FIFO_COUNTL 0x73
+#define IMU_RA_FIFO_R_W 0x74
+#define IMU_INT 10
+#define IMU_FIFO_SIZE 1024
+#define FRAME_SIZE 12
+#define SAMPLE_US 1000
+#define FRAMES_PER_BLOCK 50
+#define DURATION_US 2000000
+
+const fifo_stream_config_t IMU_FIFO = {IMU_ADDRESS, IMU_RA_FIFO_COUNTH, MSB_FIRST, 0x1FFF, IMU_RA_FIFO_R_W, FRAME_SIZE, 0};
+
+/**
+ * Simulated IMU that pushes a 12-byte frame into its FIFO every millisecond. A frame starts with a 32-bit
+ * sequence number, the interrupt pin is high while the FIFO holds at least the watermark
+ */
+class SimFifoImu : public SimI2CDevice
+{
+public:
+    SimFifoImu(int watermarkFrames) : SimI2CDevice(IMU_ADDRESS), sequence(0), overflows(0), maxFill(0), watermark(watermarkFrames * FRAME_SIZE) {
+        setFifoRegister(IMU_RA_FIFO_R_W);
+        SimGpio::set(IMU_INT, 0);
+        sampler.attach_us(callback(this, &SimFifoImu::sample), SAMPLE_US);
+    };
+
+    void stop() {sampler.detach();};
+
+    uint32_t sequence;
+    uint32_t overflows;
+    size_t maxFill;
+protected:
+    uint8_t onRead(uint8_t reg) override {
+        if (reg == IMU_RA_FIFO_COUNTH) {
+            return highByte(fifo.size());
+        } else if (reg == IMU_RA_FIFO_COUNTL) {
+            return lowByte(fifo.size());
+        } else if (reg == IMU_RA_FIFO_R_W) {
+            uint8_t value = 0;
+            if (!fifo.empty()) {
+                value = fifo.front();
+                fifo.pop_front();
+            }
+            updateInterrupt();
+            return value;
+        }
+        return SimI2CDevice::onRead(reg);
+    };
+private:
+    Ticker sampler;
+    std::deque<uint8_t> fifo;
+    size_t watermark;
+
+    void sample() {
+        if (fifo.size() + FRAME_SIZE > IMU_FIFO_SIZE) {
+            overflows++;
+        } else {
+            for (int i = 0; i < FRAME_SIZE; i++) {
+                fifo.push_back(i < 4 ? (uint8_t)(sequence >> (24 - 8 * i)) : (uint8_t)(sequence + i));
+            }
+            maxFill = max(maxFill, fifo.size());
+        }
+        sequence++;
+        updateInterrupt();
+    };
+
+    void updateInterrupt() {
+        SimGpio::set(IMU_INT, fifo.size() >= watermark);
+    };
+};
+
+typedef struct stream_result {
+    uint32_t frames;
+    uint32_t gaps;
+    uint32_t transfers;
+    double busy;
+    fifo_stream_stats_t stats;
+    uint32_t overflows;
+    size_t maxFill;
+}stream_result_t;
+
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * Streams the simulated IMU for 2 s
+ * @param watermarkFrames the FIFO level at which the interrupt is raised
+ * @param maxBurst the burst limit of the reader, 0 for none
+ * @param handlerUs the time the block handler needs per block
+ */
+stream_result_t stream(int watermarkFrames, uint16_t maxBurst, uint32_t handlerUs) {
+    static uint8_t buffer[2 * FRAMES_PER_BLOCK * FRAME_SIZE];
+    stream_result_t result = {};
+    uint32_t expected = 0;
+
+    SimClock::reset();
+    SimI2CBus bus;
+    SimFifoImu imu(watermarkFrames);
+    bus.attach(&imu);
+    I2C i2c(I2C_SDA, I2C_SCL);
+    i2c.attachBus(&bus);
+    i2c.frequency(400000);
+    I2CAsync async(&i2c);
+
+    fifo_stream_config_t config = IMU_FIFO;
+    config.maxBurst = maxBurst;
+    FifoStreamReader reader(&async, IMU_INT, config, buffer, FRAMES_PER_BLOCK);
+    reader.onBlock([&](const uint8_t * frames, size_t numFrames) {
+        for (size_t i = 0; i < numFrames; i++) {
+            const uint8_t * frame = frames + i * FRAME_SIZE;
+            uint32_t sequence = (uint32_t)frame[0] << 24 | (uint32_t)frame[1] << 16 | (uint32_t)frame[2] << 8 | frame[3];
+            result.gaps += sequence != expected;
+            expected = sequence + 1;
+        }
+        result.frames += numFrames;
+        wait_us(handlerUs);
+    });
+    reader.start();
+
+    // the main loop
+    while (SimClock::now() < DURATION_US) {
+        if (IsrUtil::global()->size() == 0) {
+            sleep();
+        }
+        runAllFromIsr();
+    }
+    reader.stop();
+    imu.stop();
+
+    result.transfers = bus.getStats().transfers;
+    result.busy = bus.getStats().busyNs / 1000.0 / SimClock::now();
+    result.stats = reader.getStats();
+    result.overflows = imu.overflows;
+    result.maxFill = imu.maxFill;
+    return result;
+}
+
+void print(const char * name, const stream_result_t & result) {
+    printf("  %s: %u frames, %u blocks, %u bursts, %u transfers, %.1f%% busy, FIFO max %u bytes\n", name, (unsigned)result.frames,
+           (unsigned)result.stats.blocks, (unsigned)result.stats.bursts, (unsigned)result.transfers, result.busy * 100, (unsigned)result.maxFill);
+}
+
+int main() {
+    stream_result_t batched = stream(10, 0, 0);
+    print("watermark 10", batched);
+    check(batched.frames >= (DURATION_US / SAMPLE_US) - 2 * FRAMES_PER_BLOCK && batched.frames % FRAMES_PER_BLOCK == 0, "all full blocks are delivered");
+    check(batched.gaps == 0 && batched.overflows == 0 && batched.stats.overruns == 0 && batched.stats.errors == 0, "no frame is lost");
+    check(batched.maxFill < 2 * 10 * FRAME_SIZE, "FIFO is drained at the watermark");
+
+    stream_result_t single = stream(1, 0, 0);
+    print("watermark 1", single);
+    check(single.gaps == 0 && single.overflows == 0, "no frame is lost per sample");
+    check(batched.transfers * 5 < single.transfers && batched.busy < single.busy, "bursts save transfers and bus time");
+
+    stream_result_t limited = stream(10, 50, 0);
+    print("max burst 50", limited);
+    check(limited.gaps == 0 && limited.overflows == 0, "no frame is lost with burst limit");
+    check(limited.stats.bursts >= limited.frames / 4, "bursts are limited to whole frames");
+
+    // the next read only starts when the main loop is back, the FIFO of the sensor holds the backlog
+    stream_result_t slow = stream(10, 0, 30000);
+    print("30 ms handler", slow);
+    check(slow.gaps == 0 && slow.overflows == 0, "slow handler loses no frame");
+    check(slow.maxFill > 30 * FRAME_SIZE && slow.maxFill <= IMU_FIFO_SIZE, "sensor FIFO buffers the backlog");
+
+    return failures == 0 ? 0 : 1;
+}
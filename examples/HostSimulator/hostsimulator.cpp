@@ -0,0 +1,202 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Runs on a Linux host against the simulated I2C bus, no board required:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <I2CUtil.h>
+#include <I2CRegisterCache.h>
+#include <I2CScript.h>
+#include <RegisterMap.h>
+#include <Crc.h>
+
+#define MPU6050_ADDRESS 0x68
+#define MPU6050_RA_SMPLRT_DIV 0x19
+#define MPU6050_RA_CONFIG 0x1A
+#define MPU6050_RA_GYRO_CONFIG 0x1B
+#define MPU6050_RA_ACCEL_CONFIG 0x1C
+#define MPU6050_RA_ACCEL_XOUT_H 0x3B
+#define MPU6050_RA_PWR_MGMT_1 0x6B
+#define MPU6050_RA_WHO_AM_I 0x75
+#define EEPROM_ADDRESS 0x50
+#define SMBUS_RA_STATUS 0x20
+
+/**
+ * Simulated accelerometer whose output registers change with every sample
+ */
+class SimAccelerometer : public SimI2CDevice
+{
+public:
+    SimAccelerometer() : SimI2CDevice(MPU6050_ADDRESS), sample(0) {
+        setRegister(MPU6050_RA_WHO_AM_I, 0x68);
+        setReadOnly(MPU6050_RA_WHO_AM_I);
+    };
+
+    int16_t sample;
+protected:
+    uint8_t onRead(uint8_t reg) override {
+        if (reg >= MPU6050_RA_ACCEL_XOUT_H && reg < MPU6050_RA_ACCEL_XOUT_H + 6) {
+            // x = sample, y = -sample, z = 2 * sample, MSB first
+            int axis = (reg - MPU6050_RA_ACCEL_XOUT_H) / 2;
+            uint16_t value = (uint16_t)(axis == 0 ? sample : axis == 1 ? -sample : 2 * sample);
+            return (reg - MPU6050_RA_ACCEL_XOUT_H) % 2 == 0 ? highByte(value) : lowByte(value);
+        }
+        return SimI2CDevice::onRead(reg);
+    };
+};
+
+// write-only register with two fields
+struct SIGNAL_PATH_RESET : RegisterDef<0x68, REG_WRITE_ONLY> {
+    typedef RegField<SIGNAL_PATH_RESET, 1> ACCEL_RESET;
+    typedef RegField<SIGNAL_PATH_RESET, 2> GYRO_RESET;
+};
+
+constexpr i2c_script_op_t MPU6050_CONFIG[] = {
+    scriptWrite(MPU6050_RA_PWR_MGMT_1, 0x01),
+    scriptWrite(MPU6050_RA_SMPLRT_DIV, 0x07),
+    scriptWrite(MPU6050_RA_CONFIG, 0x03),
+    scriptWriteBits(MPU6050_RA_GYRO_CONFIG, 0x18, 0x08),
+    scriptWriteBits(MPU6050_RA_ACCEL_CONFIG, 0x18, 0x10),
+    scriptWriteBits(MPU6050_RA_ACCEL_CONFIG, 0x80, 0x00),
+};
+
+I2C i2c(I2C_SDA, I2C_SCL);
+SimAccelerometer accel;
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+void report(const char * what) {
+    const sim_i2c_stats_t & stats = SimI2CBus::global()->getStats();
+    printf("%-40s %3u transfers %4u bytes %7.2f ms bus time\n", what, stats.transfers, stats.bytes, stats.busyNs / 1e6);
+    SimI2CBus::global()->resetStats();
+}
+
+int main() {
+    SimI2CBus::global()->attach(&accel);
+
+    uint8_t byte = 0;
+    bool bit = false;
+    uint8_t bytes[6];
+    int16_t samples[3];
+
+    // basic register access
+    check(I2CUtil::probeAddress(&i2c, MPU6050_ADDRESS), "probeAddress finds device");
+    check(!I2CUtil::probeAddress(&i2c, 0x69), "probeAddress empty address");
+    check(I2CUtil::readByte(&i2c, MPU6050_ADDRESS, MPU6050_RA_WHO_AM_I, &byte) == I2C_OK && byte == 0x68, "readByte");
+    check(I2CUtil::writeByte(&i2c, MPU6050_ADDRESS, MPU6050_RA_SMPLRT_DIV, 0x42) == I2C_OK && accel.getRegister(MPU6050_RA_SMPLRT_DIV) == 0x42, "writeByte");
+    const uint8_t config[] = {0x01, 0x02, 0x03};
+    check(I2CUtil::writeBytes(&i2c, MPU6050_ADDRESS, MPU6050_RA_CONFIG, config, 3) == I2C_OK && accel.getRegister(MPU6050_RA_GYRO_CONFIG) == 0x02, "writeBytes");
+    check(I2CUtil::readBytes(&i2c, MPU6050_ADDRESS, MPU6050_RA_SMPLRT_DIV, bytes, 4) == I2C_OK && bytes[0] == 0x42 && bytes[3] == 0x03, "readBytes");
+    check(I2CUtil::writeBit(&i2c, MPU6050_ADDRESS, MPU6050_RA_CONFIG, 7, true) == I2C_OK && accel.getRegister(MPU6050_RA_CONFIG) == 0x81, "writeBit");
+    check(I2CUtil::readBit(&i2c, MPU6050_ADDRESS, MPU6050_RA_CONFIG, 7, &bit) == I2C_OK && bit, "readBit");
+    check(I2CUtil::writeBits(&i2c, MPU6050_ADDRESS, MPU6050_RA_CONFIG, 0x0F, 0x0A) == I2C_OK && accel.getRegister(MPU6050_RA_CONFIG) == 0x8A, "writeBits");
+    check(I2CUtil::readBits(&i2c, MPU6050_ADDRESS, MPU6050_RA_CONFIG, 0xF0, &byte) == I2C_OK && byte == 0x80, "readBits");
+    accel.sample = -1234;
+    check(I2CUtil::readInt16s(&i2c, MPU6050_ADDRESS, MPU6050_RA_ACCEL_XOUT_H, samples, 3) == I2C_OK && samples[0] == -1234 && samples[1] == 1234 && samples[2] == -2468, "readInt16s");
+
+    // SMBus packet error code, the device returns the PEC as the register following the data
+    const uint8_t status[] = {0x12, 0x34};
+    const uint8_t pecHeader[] = {I2C_ADDR_8BIT(MPU6050_ADDRESS), SMBUS_RA_STATUS, I2C_ADDR_8BIT(MPU6050_ADDRESS) | 0x01};
+    uint8_t pec = Crc8Smbus::finalize(Crc8Smbus::update(Crc8Smbus::update(Crc8Smbus::initial, pecHeader, 3), status, 2));
+    accel.setRegister(SMBUS_RA_STATUS, status[0]);
+    accel.setRegister(SMBUS_RA_STATUS + 1, status[1]);
+    accel.setRegister(SMBUS_RA_STATUS + 2, pec);
+    memset(bytes, 0, sizeof(bytes));
+    check(I2CUtil::readBytesPec(&i2c, MPU6050_ADDRESS, SMBUS_RA_STATUS, bytes, 2) == I2C_OK && bytes[0] == 0x12 && bytes[1] == 0x34, "readBytesPec");
+    accel.setRegister(SMBUS_RA_STATUS + 2, pec ^ 0x01);
+    memset(bytes, 0, sizeof(bytes));
+    check(I2CUtil::readBytesPec(&i2c, MPU6050_ADDRESS, SMBUS_RA_STATUS, bytes, 2) == I2C_ERROR && bytes[0] == 0x00, "readBytesPec detects corruption");
+    const uint8_t pecWriteHeader[] = {I2C_ADDR_8BIT(MPU6050_ADDRESS), SMBUS_RA_STATUS};
+    pec = Crc8Smbus::finalize(Crc8Smbus::update(Crc8Smbus::update(Crc8Smbus::initial, pecWriteHeader, 2), status, 2));
+    check(I2CUtil::writeBytesPec(&i2c, MPU6050_ADDRESS, SMBUS_RA_STATUS, status, 2) == I2C_OK && accel.getRegister(SMBUS_RA_STATUS + 2) == pec, "writeBytesPec");
+
+    // bus scan
+    SimI2CDevice eeprom(EEPROM_ADDRESS);
+    SimI2CBus::global()->attach(&eeprom);
+    Bitset<128> present;
+    present.set(0x10);
+    check(I2CUtil::scanAddresses(&i2c, &present) == 2 && present.test(MPU6050_ADDRESS) && present.test(EEPROM_ADDRESS) && present.count() == 2, "scanAddresses");
+    check(I2CUtil::scanAddresses(&i2c, &present, 0x60, 0x6F) == 1 && present.test(MPU6050_ADDRESS) && present.count() == 1, "scanAddresses range");
+    eeprom.setPresent(false);
+
+    // write-only registers keep the fields known to the cache
+    RegisterMap<I2CRegisterCache<>> registers(&i2c, MPU6050_ADDRESS);
+    registers.write(SIGNAL_PATH_RESET::GYRO_RESET::of(1));
+    registers.write(SIGNAL_PATH_RESET::ACCEL_RESET::of(1));
+    check(accel.getRegister(SIGNAL_PATH_RESET::address) == 0x02, "write-only register without cache");
+    registers.setCacheable(SIGNAL_PATH_RESET::address);
+    registers.setKnownValue(SIGNAL_PATH_RESET::address, 0x00);
+    registers.write(SIGNAL_PATH_RESET::GYRO_RESET::of(1));
+    registers.write(SIGNAL_PATH_RESET::ACCEL_RESET::of(1));
+    check(accel.getRegister(SIGNAL_PATH_RESET::address) == 0x06, "write-only register with known value");
+    RegisterMap<> direct(&i2c, MPU6050_ADDRESS);
+    direct.write(SIGNAL_PATH_RESET::GYRO_RESET::of(1));
+    check(accel.getRegister(SIGNAL_PATH_RESET::address) == 0x04, "write-only register of direct map");
+
+    // error handling
+    accel.injectNack();
+    check(I2CUtil::readByte(&i2c, MPU6050_ADDRESS, MPU6050_RA_WHO_AM_I, &byte) == I2C_ERROR, "NACK is reported");
+    I2CUtil::writeByte(&i2c, MPU6050_ADDRESS, MPU6050_RA_WHO_AM_I, 0x00);
+    check(accel.getRegister(MPU6050_RA_WHO_AM_I) == 0x68, "read-only register");
+
+    // bus utilization of the same configuration with different approaches
+    printf("\n");
+    SimI2CBus::global()->resetStats();
+
+    I2CUtil::writeByte(&i2c, MPU6050_ADDRESS, MPU6050_RA_PWR_MGMT_1, 0x01);
+    I2CUtil::writeByte(&i2c, MPU6050_ADDRESS, MPU6050_RA_SMPLRT_DIV, 0x07);
+    I2CUtil::writeByte(&i2c, MPU6050_ADDRESS, MPU6050_RA_CONFIG, 0x03);
+    I2CUtil::writeBits(&i2c, MPU6050_ADDRESS, MPU6050_RA_GYRO_CONFIG, 0x18, 0x08);
+    I2CUtil::writeBits(&i2c, MPU6050_ADDRESS, MPU6050_RA_ACCEL_CONFIG, 0x18, 0x10);
+    I2CUtil::writeBit(&i2c, MPU6050_ADDRESS, MPU6050_RA_ACCEL_CONFIG, 7, false);
+    report("I2CUtil, one call per setting");
+
+    I2CRegisterCache<> cache(&i2c, MPU6050_ADDRESS, WRITE_BACK);
+    cache.setCacheableRange(MPU6050_RA_SMPLRT_DIV, MPU6050_RA_ACCEL_CONFIG);
+    cache.setCacheable(MPU6050_RA_PWR_MGMT_1);
+    cache.setBurstWrites(true);
+    cache.readBytes(MPU6050_RA_SMPLRT_DIV, bytes, 4);
+    cache.writeByte(MPU6050_RA_PWR_MGMT_1, 0x01);
+    cache.writeByte(MPU6050_RA_SMPLRT_DIV, 0x07);
+    cache.writeByte(MPU6050_RA_CONFIG, 0x03);
+    cache.writeBits(MPU6050_RA_GYRO_CONFIG, 0x18, 0x08);
+    cache.writeBits(MPU6050_RA_ACCEL_CONFIG, 0x18, 0x10);
+    cache.writeBit(MPU6050_RA_ACCEL_CONFIG, 7, false);
+    cache.flush();
+    report("I2CRegisterCache, write-back");
+
+    I2CScript script(MPU6050_CONFIG);
+    script.run(&i2c, MPU6050_ADDRESS);
+    report("I2CScript");
+    check(accel.getRegister(MPU6050_RA_SMPLRT_DIV) == 0x07 && accel.getRegister(MPU6050_RA_ACCEL_CONFIG) == 0x13, "all approaches configure the device");
+
+    printf("\nvirtual time: %.2f ms\n", SimClock::now() / 1000.0);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Runs I2CAsync against the simulated I2C bus on a Linux host:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <I2CAsync.h>
+
+#define SENSOR_ADDRESS 0x68
+#define MISSING_ADDRESS 0x29
+#define SENSOR_RA_DATA 0x3B
+#define SENSOR_RA_CONFIG 0x1A
+
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * The main loop: sleeps until the next interrupt and runs the deferred functions, until the bus is idle
+ */
+void runUntilIdle(I2CAsync * bus) {
+    while (bus->pending() > 0 || IsrUtil::global()->size() > 0) {
+        if (IsrUtil::global()->size() == 0) {
+            sleep();
+        }
+        runAllFromIsr();
+    }
+}
+
+int main() {
+    I2C i2c(I2C_SDA, I2C_SCL);
+    i2c.frequency(400000);
+    I2CAsync bus(&i2c);
+
+    SimI2CDevice sensor(SENSOR_ADDRESS);
+    SimI2CBus::global()->attach(&sensor);
+    for (int i = 0; i < 6; i++) {
+        sensor.setRegister(SENSOR_RA_DATA + i, 0x10 + i);
+    }
+
+    // transactions queued from the main loop are transferred back to back
+    I2CTransaction reads[4];
+    uint8_t data[4][6];
+    int callbacks = 0;
+    bool callbackInInterrupt = false;
+    SimI2CBus::global()->resetStats();
+    uint64_t start = SimClock::nowNanos();
+    for (int i = 0; i < 4; i++) {
+        bus.read(&reads[i], SENSOR_ADDRESS, SENSOR_RA_DATA, data[i], 6, [&](I2CTransaction * transaction) {
+            callbacks++;
+            callbackInInterrupt |= SimClock::inInterrupt();
+            (void)transaction;
+        });
+    }
+    check(bus.pending() == 4 && bus.isBusy(), "reads are queued");
+    check(bus.read(&reads[0], SENSOR_ADDRESS, SENSOR_RA_DATA, data[0], 6) == I2C_ERROR, "pending transaction is rejected");
+    runUntilIdle(&bus);
+
+    bool valid = true;
+    for (int i = 0; i < 4; i++) {
+        valid &= reads[i].getStatus() == I2C_TRANSACTION_DONE && memcmp(data[i], "\x10\x11\x12\x13\x14\x15", 6) == 0;
+    }
+    check(valid, "reads return the registers");
+    check(callbacks == 4 && !callbackInInterrupt, "callbacks run in the main loop");
+    uint64_t elapsed = SimClock::nowNanos() - start;
+    check(elapsed == SimI2CBus::global()->getStats().busyNs, "bus has no gaps between transfers");
+    printf("  4 reads of 6 bytes in %.1f us\n", elapsed / 1000.0);
+
+    // a callback in interrupt context queues the next read, like FifoStreamReader and I2CPoller do
+    I2CTransaction first;
+    I2CTransaction chained;
+    uint8_t chainedData[6];
+    first.setDeferred(false);
+    bool chainedQueued = false;
+    bus.read(&first, SENSOR_ADDRESS, SENSOR_RA_DATA, data[0], 2, [&](I2CTransaction * transaction) {
+        (void)transaction;
+        chainedQueued = SimClock::inInterrupt() && bus.read(&chained, SENSOR_ADDRESS, SENSOR_RA_DATA, chainedData, 6) == I2C_OK;
+    });
+    runUntilIdle(&bus);
+    check(chainedQueued && chained.getStatus() == I2C_TRANSACTION_DONE, "read queued in interrupt context");
+
+    // writes are copied, so the buffer can be reused immediately
+    I2CTransaction write;
+    uint8_t config[2] = {0x03, 0x18};
+    bus.write(&write, SENSOR_ADDRESS, SENSOR_RA_CONFIG, config, 2);
+    config[0] = 0;
+    runUntilIdle(&bus);
+    check(write.getStatus() == I2C_TRANSACTION_DONE && sensor.getRegister(SENSOR_RA_CONFIG) == 0x03 && sensor.getRegister(SENSOR_RA_CONFIG + 1) == 0x18,
+          "write reaches the registers");
+
+    uint8_t large[I2C_ASYNC_WRITE_BUFFER_SIZE + 1] = {0};
+    check(bus.write(&write, SENSOR_ADDRESS, SENSOR_RA_CONFIG, large, sizeof(large)) == I2C_ERROR, "too large write is rejected");
+
+    // a missing slave fails its transaction, the next one is transferred anyway
+    I2CTransaction missing;
+    I2CTransaction after;
+    uint32_t failed = bus.getFailedCount();
+    bus.read(&missing, MISSING_ADDRESS, 0x00, data[0], 1);
+    bus.read(&after, SENSOR_ADDRESS, SENSOR_RA_DATA, data[1], 6);
+    runUntilIdle(&bus);
+    check(missing.getStatus() == I2C_TRANSACTION_FAILED && missing.result() == I2C_ERROR && bus.getFailedCount() == failed + 1, "NACK fails the transaction");
+    check(after.getStatus() == I2C_TRANSACTION_DONE, "queue continues after a failure");
+    check(bus.pending() == 0 && !bus.isBusy(), "bus is idle");
+
+    printf("\nvirtual time: %.2f ms\n", SimClock::now() / 1000.0);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Shares the simulated I2C bus between host threads with I2CBusArbiter:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <I2CBusArbiter.h>
+#include <vector>
+
+#define DEVICE_ADDRESS 0x68
+#define NUM_THREADS 4
+#define READS_PER_THREAD 5000
+
+/**
+ * Simulated device that gives other threads a chance to run on every byte, so unprotected register
+ * selects and reads of different threads interleave
+ */
+class SimYieldingDevice : public SimI2CDevice
+{
+public:
+    SimYieldingDevice() : SimI2CDevice(DEVICE_ADDRESS) {
+        // thread t reads 4 bytes at register 4 * t, all of them have the value t
+        for (int t = 0; t < NUM_THREADS; t++) {
+            for (int i = 0; i < 4; i++) {
+                setRegister(4 * t + i, t);
+            }
+        }
+    };
+protected:
+    uint8_t onRead(uint8_t reg) override {
+        std::this_thread::yield();
+        return SimI2CDevice::onRead(reg);
+    };
+};
+
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * Reads the registers of every thread from NUM_THREADS threads at once
+ * @param arbiter the arbiter to use, nullptr to use I2CUtil directly
+ * @return the number of reads that returned registers of another thread
+ */
+int readConcurrently(I2C * i2c, I2CBusArbiter * arbiter) {
+    std::atomic<int> corrupted(0);
+    rtos::Thread threads[NUM_THREADS];
+
+    for (int t = 0; t < NUM_THREADS; t++) {
+        threads[t].start([=, &corrupted]() {
+            uint8_t data[4];
+            for (int i = 0; i < READS_PER_THREAD; i++) {
+                i2c_return_code result = arbiter ? arbiter->readBytes(DEVICE_ADDRESS, 4 * t, data, 4)
+                                                 : I2CUtil::readBytes(i2c, DEVICE_ADDRESS, 4 * t, data, 4);
+                corrupted += result != I2C_OK || data[0] != t || data[3] != t;
+            }
+        });
+    }
+    for (int t = 0; t < NUM_THREADS; t++) {
+        threads[t].join();
+    }
+
+    return corrupted;
+}
+
+int main() {
+    I2C i2c(I2C_SDA, I2C_SCL);
+    i2c.frequency(400000);
+    SimYieldingDevice device;
+    SimI2CBus::global()->attach(&device);
+    I2CBusArbiter arbiter(&i2c);
+
+    // register selects and reads of different threads interleave without the arbiter, how often depends on the host
+    int unprotected = readConcurrently(&i2c, nullptr);
+    int arbitrated = readConcurrently(&i2c, &arbiter);
+    printf("%d threads x %d reads: %d corrupted without arbiter, %d with\n", NUM_THREADS, READS_PER_THREAD, unprotected, arbitrated);
+    check(arbitrated == 0, "arbitrated reads are atomic");
+    check(arbiter.getStats().accesses == NUM_THREADS * READS_PER_THREAD, "every access is counted");
+
+    // waiters are granted by priority, in request order within a priority
+    const i2c_priority_t priorities[] = {I2C_PRIORITY_LOW, I2C_PRIORITY_HIGH, I2C_PRIORITY_NORMAL, I2C_PRIORITY_HIGH, I2C_PRIORITY_REALTIME};
+    const int expected[] = {4, 1, 3, 2, 0};
+    const int numWaiters = sizeof(priorities) / sizeof(priorities[0]);
+    std::vector<int> granted;
+    rtos::Thread waiters[numWaiters];
+
+    arbiter.resetStats();
+    arbiter.acquire();
+    for (int w = 0; w < numWaiters; w++) {
+        waiters[w].start([&, w]() {
+            arbiter.execute([&, w](I2C * bus) {
+                granted.push_back(w);
+                uint8_t data;
+                return I2CUtil::readByte(bus, DEVICE_ADDRESS, 0, &data);
+            }, priorities[w]);
+        });
+
+        // wait until the thread is queued, so the request order is known
+        while (arbiter.getQueueDepth() < (uint32_t)w + 1) {
+            std::this_thread::yield();
+        }
+    }
+
+    // hold the bus for 1 ms of virtual time
+    wait_us(1000);
+    arbiter.release();
+    for (int w = 0; w < numWaiters; w++) {
+        waiters[w].join();
+    }
+
+    check(granted.size() == numWaiters && std::equal(granted.begin(), granted.end(), expected), "waiters are granted by priority");
+    const i2c_arbiter_stats_t & stats = arbiter.getStats();
+    check(stats.contended == numWaiters && stats.maxQueueDepth == numWaiters, "contention and queue depth");
+    check(stats.maxWaitUs >= 1000 && arbiter.getAverageWaitUs() >= 1000 * numWaiters / (numWaiters + 1), "waiting times");
+    printf("  max wait %u us, average %u us, utilization %.2f\n", (unsigned)stats.maxWaitUs, (unsigned)arbiter.getAverageWaitUs(), arbiter.getUtilization());
+
+    return failures == 0 ? 0 : 1;
+}
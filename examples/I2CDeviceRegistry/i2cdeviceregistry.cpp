@@ -0,0 +1,139 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Tracks simulated devices that are plugged and removed with I2CDeviceRegistry, runs on a Linux host:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <I2CDeviceRegistry.h>
+
+#define IMU_ADDRESS 0x68
+#define BARO_ADDRESS 0x76
+#define EEPROM_ADDRESS 0x50
+#define DISPLAY_ADDRESS 0x3C
+#define LOOP_US 5000
+
+int failures = 0;
+uint32_t longestPollUs = 0;
+int connected = 0;
+int removed = 0;
+uint8_t lastAddress = 0;
+uint64_t lastChangeUs = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * One iteration of the main loop: poll, deliver the events and do 5 ms of other work
+ */
+void loop(I2CDeviceRegistry * registry) {
+    uint64_t start = SimClock::now();
+    registry->poll();
+    longestPollUs = max(longestPollUs, (uint32_t)(SimClock::now() - start));
+    runAllFromIsr();
+    wait_us(LOOP_US);
+}
+
+/**
+ * Runs the main loop until a condition is met
+ * @return the virtual time it took in us
+ */
+template<typename F>
+uint64_t loopUntil(I2CDeviceRegistry * registry, F condition, uint64_t timeoutUs) {
+    uint64_t start = SimClock::now();
+    while (!condition() && SimClock::now() - start < timeoutUs) {
+        loop(registry);
+    }
+    return SimClock::now() - start;
+}
+
+int main() {
+    I2C i2c(I2C_SDA, I2C_SCL);
+    i2c.frequency(100000);
+
+    SimI2CDevice imu(IMU_ADDRESS);
+    SimI2CDevice baro(BARO_ADDRESS);
+    SimI2CDevice eeprom(EEPROM_ADDRESS);
+    SimI2CDevice display(DISPLAY_ADDRESS);
+    display.setPresent(false);
+    SimI2CBus::global()->attach(&imu);
+    SimI2CBus::global()->attach(&baro);
+    SimI2CBus::global()->attach(&eeprom);
+    SimI2CBus::global()->attach(&display);
+
+    // the blocking scan stalls everything else
+    Bitset<128> found;
+    uint64_t start = SimClock::now();
+    I2CUtil::scanAddresses(&i2c, &found);
+    uint32_t blockingUs = SimClock::now() - start;
+    printf("blocking scanAddresses: %.1f ms bus stall\n", blockingUs / 1000.0);
+
+    I2CDeviceRegistry registry(&i2c);
+    registry.registerDevice(IMU_ADDRESS);
+    registry.registerDevice(BARO_ADDRESS);
+    registry.onChange([](uint8_t address, bool present) {
+        connected += present;
+        removed += !present;
+        lastAddress = address;
+        lastChangeUs = SimClock::now();
+    });
+
+    // registered devices are probed first
+    start = SimClock::now();
+    registry.poll();
+    uint32_t registeredUs = SimClock::now() - start;
+    runAllFromIsr();
+    check(registry.isPresent(IMU_ADDRESS) && registry.isPresent(BARO_ADDRESS) && connected == 2, "registered devices after first poll");
+
+    uint64_t scanUs = loopUntil(&registry, [&]() {return registry.isScanComplete();}, 1000000);
+    printf("registry: registered devices after %.2f ms, longest poll %.2f ms, scan complete after %.0f ms\n",
+           registeredUs / 1000.0, longestPollUs / 1000.0, scanUs / 1000.0);
+    check(registry.isScanComplete() && registry.getPresent() == found && connected == 3, "scan finds the same devices");
+    check(longestPollUs * 10 < blockingUs, "polls do not stall the bus");
+    check(registry.getProbeCount() == 0x77 - 0x08 + 1, "every address is probed once");
+
+    // a hot-plugged device is found by the next pass of the background scan
+    display.setPresent(true);
+    uint64_t plugUs = loopUntil(&registry, []() {return connected == 4;}, 10000000);
+    printf("  plugged device reported after %.0f ms\n", plugUs / 1000.0);
+    check(connected == 4 && lastAddress == DISPLAY_ADDRESS && plugUs <= DEFAULT_REGISTRY_RESCAN_INTERVAL * 1000 + scanUs, "plugged device within a rescan interval");
+
+    // a removed registered device is noticed by the next check
+    imu.setPresent(false);
+    uint64_t removeUs = loopUntil(&registry, []() {return removed == 1;}, 10000000);
+    printf("  removed device reported after %.0f ms\n", removeUs / 1000.0);
+    check(removed == 1 && lastAddress == IMU_ADDRESS && !registry.isPresent(IMU_ADDRESS), "removed device is reported");
+    check(removeUs <= DEFAULT_REGISTRY_CHECK_INTERVAL * 1000 + 2 * LOOP_US, "removed device within a check interval");
+
+    // unregistered devices are only covered by the background scan
+    registry.unregisterDevice(BARO_ADDRESS);
+    baro.setPresent(false);
+    uint64_t unregisteredUs = loopUntil(&registry, []() {return removed == 2;}, 10000000);
+    check(removed == 2 && lastAddress == BARO_ADDRESS && unregisteredUs > DEFAULT_REGISTRY_CHECK_INTERVAL * 1000, "unregistered device by the scan");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,221 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Polls simulated sensors at different rates with I2CPoller and compares the jitter with one Ticker per sensor,
+// runs on a Linux host:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <I2CPoller.h>
+
+#define NUM_SENSORS 12
+#define SENSOR_BYTES 6
+#define DURATION_US 5000000
+
+const uint16_t RATES_HZ[NUM_SENSORS] = {400, 200, 100, 100, 50, 50, 25, 20, 10, 5, 2, 1};
+
+/**
+ * Timing of the reads of one sensor, the same measure as i2c_poll_stats_t
+ */
+typedef struct read_timing {
+    uint32_t samples;
+    uint32_t lastTimestamp;
+    uint32_t maxJitterUs;
+    uint64_t sumJitterUs;
+}read_timing_t;
+
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * The main loop, runs until the given virtual time
+ */
+void runUntil(uint64_t us) {
+    while (SimClock::now() < us) {
+        if (IsrUtil::global()->size() == 0 && !SimClock::advanceToNextEvent()) {
+            // nothing scheduled anymore
+            SimClock::advance(us - SimClock::now());
+        }
+        runAllFromIsr();
+    }
+}
+
+/**
+ * A sensor read by its own Ticker, the approach I2CPoller replaces
+ */
+class TickerSensor
+{
+public:
+    void start(I2CAsync * bus, uint8_t address, uint32_t periodUs) {
+        this->bus = bus;
+        this->address = address;
+        this->periodUs = periodUs;
+        memset(&timing, 0, sizeof(timing));
+        transaction.setDeferred(false);
+        ticker.attach_us(callback(this, &TickerSensor::onTick), periodUs);
+    };
+
+    void stop() {ticker.detach();};
+
+    read_timing_t timing;
+private:
+    I2CAsync * bus;
+    uint8_t address;
+    uint32_t periodUs;
+    Ticker ticker;
+    I2CTransaction transaction;
+    uint8_t data[SENSOR_BYTES];
+
+    void onTick() {
+        if (!transaction.isPending()) {
+            bus->read(&transaction, address, 0x00, data, SENSOR_BYTES, callback(this, &TickerSensor::onRead));
+        }
+    };
+
+    void onRead(I2CTransaction *) {
+        uint32_t now = us_ticker_read();
+        if (timing.samples > 0) {
+            int32_t deviation = (int32_t)(now - timing.lastTimestamp) - (int32_t)periodUs;
+            uint32_t jitter = deviation < 0 ? -deviation : deviation;
+            timing.sumJitterUs += jitter;
+            timing.maxJitterUs = max(timing.maxJitterUs, jitter);
+        }
+        timing.samples++;
+        timing.lastTimestamp = now;
+    };
+};
+
+int main() {
+    I2C i2c(I2C_SDA, I2C_SCL);
+    i2c.frequency(400000);
+    I2CAsync bus(&i2c);
+
+    SimI2CDevice * devices[NUM_SENSORS];
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        devices[i] = new SimI2CDevice(0x10 + i);
+        SimI2CBus::global()->attach(devices[i]);
+    }
+
+    // one Ticker per sensor, all started at once
+    TickerSensor tickerSensors[NUM_SENSORS];
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        tickerSensors[i].start(&bus, 0x10 + i, 1000000 / RATES_HZ[i]);
+    }
+    runUntil(DURATION_US);
+
+    uint64_t sumJitter = 0;
+    uint32_t numIntervals = 0;
+    uint32_t maxJitter = 0;
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        tickerSensors[i].stop();
+        sumJitter += tickerSensors[i].timing.sumJitterUs;
+        numIntervals += tickerSensors[i].timing.samples - 1;
+        maxJitter = max(maxJitter, tickerSensors[i].timing.maxJitterUs);
+    }
+    uint32_t tickerMeanJitter = sumJitter / numIntervals;
+    printf("one Ticker per sensor: mean jitter %u us, worst %u us\n", (unsigned)tickerMeanJitter, (unsigned)maxJitter);
+
+    // the same sensors with the poller
+    runUntil(SimClock::now() + 100000);
+    StaticRingBuffer<i2c_poll_sample_t, 16> queues[NUM_SENSORS];
+    I2CPoller poller(&bus);
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        poller.addSensor(0x10 + i, 0x00, SENSOR_BYTES, RATES_HZ[i], &queues[i]);
+    }
+    check(poller.start(), "poller starts");
+    check(poller.getTickUs() == 2500, "tick is the gcd of the periods");
+
+    uint32_t received[NUM_SENSORS] = {0};
+    bool ordered = true;
+    uint64_t end = SimClock::now() + DURATION_US;
+    while (SimClock::now() < end) {
+        if (IsrUtil::global()->size() == 0) {
+            sleep();
+        }
+        runAllFromIsr();
+
+        // the consumer
+        for (int i = 0; i < NUM_SENSORS; i++) {
+            i2c_poll_sample_t sample;
+            while (queues[i].pop(&sample)) {
+                ordered &= sample.sensor == i && sample.length == SENSOR_BYTES;
+                received[i]++;
+            }
+        }
+    }
+    poller.stop();
+
+    bool exact = true;
+    bool clean = true;
+    bool complete = true;
+    sumJitter = 0;
+    numIntervals = 0;
+    maxJitter = 0;
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        const i2c_poll_stats_t & stats = poller.getStats(i);
+        exact &= poller.getPeriodUs(i) == 1000000u / RATES_HZ[i] && fabsf(poller.getAchievedRate(i) - RATES_HZ[i]) < 0.001f * RATES_HZ[i];
+        clean &= stats.skipped == 0 && stats.errors == 0 && stats.dropped == 0;
+        // the read of the last period may still be on the bus
+        complete &= received[i] == stats.samples && stats.samples >= (uint32_t)RATES_HZ[i] * DURATION_US / 1000000 - 1;
+        sumJitter += stats.sumJitterUs;
+        numIntervals += stats.samples - 1;
+        maxJitter = max(maxJitter, stats.maxJitterUs);
+    }
+    uint32_t pollerMeanJitter = sumJitter / numIntervals;
+    printf("I2CPoller, %u us tick:   mean jitter %u us, worst %u us\n", (unsigned)poller.getTickUs(), (unsigned)pollerMeanJitter, (unsigned)maxJitter);
+    check(exact, "all rates are exact");
+    check(clean, "no skipped, failed or dropped reads");
+    check(complete && ordered, "consumer receives every sample");
+    check(maxJitter < tickerMeanJitter && maxJitter <= 100, "phases avoid collisions");
+
+    // an overloaded bus skips reads instead of queueing them without limit, a full queue drops samples
+    i2c.frequency(100000);
+    StaticRingBuffer<i2c_poll_sample_t, 4> small;
+    I2CPoller overloaded(&bus);
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        overloaded.addSensor(0x10 + i, 0x00, I2C_POLL_MAX_BYTES, 400, &small);
+    }
+    overloaded.start();
+    runUntil(SimClock::now() + 100000);
+    overloaded.stop();
+    runUntil(SimClock::now() + 50000);
+
+    uint32_t skipped = 0;
+    uint32_t dropped = 0;
+    for (int i = 0; i < NUM_SENSORS; i++) {
+        skipped += overloaded.getStats(i).skipped;
+        dropped += overloaded.getStats(i).dropped;
+    }
+    printf("  overloaded bus: %u skipped, %u dropped, sensor 0 at %.0f Hz\n", (unsigned)skipped, (unsigned)dropped, overloaded.getAchievedRate(0));
+    check(skipped > 0 && overloaded.getAchievedRate(0) < 400, "overload skips reads");
+    check(dropped > 0 && small.isFull(), "full queue drops samples");
+    check(bus.pending() == 0, "bus is idle after stop");
+
+    return failures == 0 ? 0 : 1;
+}
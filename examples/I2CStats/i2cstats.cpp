@@ -0,0 +1,149 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Checks the I2C transaction statistics against the simulated bus on a Linux host. The statistics are
+// compiled out by default, so this program and the library are built with MBED_EXT_I2C_STATS=1:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <I2CUtil.h>
+#include <I2CAsync.h>
+#include <I2CStats.h>
+#include <BitStream.h>
+#include <Crc.h>
+
+#if !MBED_EXT_I2C_STATS
+#error "build with -DMBED_EXT_I2C_STATS=1"
+#endif
+
+#define SENSOR_ADDRESS 0x68
+#define MISSING_ADDRESS 0x29
+#define SENSOR_RA_DATA 0x3B
+#define SENSOR_RA_CONFIG 0x1A
+#define SENSOR_RA_STATUS 0x20
+#define SENSOR_RA_FIFO 0x74
+
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * Checks that an entry exists and has the given counters
+ */
+bool hasCounts(uint8_t slaveAddress, uint8_t registerAddress, uint32_t transactions, uint32_t bytes, uint16_t nacks, uint16_t errors) {
+    const i2c_stats_entry_t * entry = I2CStats::find(slaveAddress, registerAddress);
+    return entry != nullptr && entry->transactions == transactions && entry->bytes == bytes && entry->nacks == nacks && entry->errors == errors;
+}
+
+int main() {
+    I2C i2c(I2C_SDA, I2C_SCL);
+    i2c.frequency(400000);
+
+    SimI2CDevice sensor(SENSOR_ADDRESS);
+    sensor.setFifoRegister(SENSOR_RA_FIFO);
+    SimI2CBus::global()->attach(&sensor);
+
+    // blocking reads, the latency is the modelled bus time
+    uint8_t data[64];
+    uint64_t start = SimClock::now();
+    for (int i = 0; i < 10; i++) {
+        I2CUtil::readBytes(&i2c, SENSOR_ADDRESS, SENSOR_RA_DATA, data, 6);
+    }
+    uint32_t readUs = (SimClock::now() - start) / 10;
+    const i2c_stats_entry_t * reads = I2CStats::find(SENSOR_ADDRESS, SENSOR_RA_DATA);
+    check(hasCounts(SENSOR_ADDRESS, SENSOR_RA_DATA, 10, 60, 0, 0), "reads are counted");
+    check(reads != nullptr && reads->latency[I2CStats::latencyBucket(readUs)] == 10, "read latency bucket");
+    printf("  read of 6 bytes: %u us, bucket %u\n", (unsigned)readUs, I2CStats::latencyBucket(readUs));
+
+    // writes, including a NACK and a write larger than the stack buffer
+    I2CUtil::writeByte(&i2c, SENSOR_ADDRESS, SENSOR_RA_CONFIG, 0x03);
+    sensor.injectNack();
+    check(I2CUtil::writeByte(&i2c, SENSOR_ADDRESS, SENSOR_RA_CONFIG, 0x03) == I2C_ERROR, "injected NACK fails the write");
+    check(hasCounts(SENSOR_ADDRESS, SENSOR_RA_CONFIG, 2, 1, 1, 0), "NACK is counted");
+
+    memset(data, 0xA5, sizeof(data));
+    check(I2CUtil::writeBytes(&i2c, SENSOR_ADDRESS, SENSOR_RA_FIFO, data, I2C_WRITE_BUFFER_SIZE + 8) == I2C_OK, "large write");
+    check(hasCounts(SENSOR_ADDRESS, SENSOR_RA_FIFO, 1, I2C_WRITE_BUFFER_SIZE + 8, 0, 0), "large write is counted");
+
+    // a wrong checksum is an error of a transaction that was acknowledged
+    sensor.setRegister(SENSOR_RA_STATUS, 0x12);
+    sensor.setRegister(SENSOR_RA_STATUS + 1, 0x00);
+    check(I2CUtil::readBytesPec(&i2c, SENSOR_ADDRESS, SENSOR_RA_STATUS, data, 1) == I2C_ERROR, "wrong PEC is detected");
+    check(hasCounts(SENSOR_ADDRESS, SENSOR_RA_STATUS, 1, 2, 0, 1), "wrong PEC is counted as error");
+
+    // missing slave
+    I2CUtil::readBytes(&i2c, MISSING_ADDRESS, 0x00, data, 1);
+    check(hasCounts(MISSING_ADDRESS, 0x00, 1, 0, 1, 0), "missing slave is counted as NACK");
+
+    // asynchronous transactions are recorded when they finish
+    I2CAsync bus(&i2c);
+    I2CTransaction transaction;
+    bus.read(&transaction, SENSOR_ADDRESS, SENSOR_RA_DATA, data, 6);
+    start = SimClock::now();
+    while (transaction.isPending()) {
+        sleep();
+        runAllFromIsr();
+    }
+    uint32_t asyncUs = SimClock::now() - start;
+    check(hasCounts(SENSOR_ADDRESS, SENSOR_RA_DATA, 11, 66, 0, 0), "async read is counted");
+    check(reads->latency[I2CStats::latencyBucket(asyncUs)] >= 1, "async read latency bucket");
+    check(I2CStats::numEntries() == 5 && I2CStats::getDropped() == 0, "one entry per register");
+
+    // the snapshot decodes to the same values
+    uint8_t snapshot[I2CStats::snapshotSize()];
+    size_t length = I2CStats::snapshot(snapshot, sizeof(snapshot));
+    BitReader reader(snapshot, length);
+    bool decoded = reader.read(8) == I2C_STATS_SNAPSHOT_VERSION && reader.readVarint() == I2CStats::numEntries() && reader.readVarint() == 0;
+    for (size_t i = 0; decoded && i < I2CStats::numEntries(); i++) {
+        uint8_t slaveAddress = reader.read(7);
+        uint8_t registerAddress = reader.read(8);
+        const i2c_stats_entry_t * entry = I2CStats::find(slaveAddress, registerAddress);
+        decoded = entry != nullptr && reader.readVarint() == entry->transactions && reader.readVarint() == entry->bytes
+               && reader.readVarint() == entry->nacks && reader.readVarint() == entry->errors;
+
+        uint16_t bucketMask = reader.read(I2C_STATS_LATENCY_BUCKETS);
+        for (uint8_t bucket = 0; decoded && bucket < I2C_STATS_LATENCY_BUCKETS; bucket++) {
+            uint32_t count = (bucketMask >> bucket) & 1 ? reader.readVarint() : 0;
+            decoded = count == entry->latency[bucket];
+        }
+    }
+    check(length > 0 && decoded && !reader.hasOverflowed(), "snapshot round trip");
+    check(I2CStats::snapshot(snapshot, 4) == 0, "snapshot into a too small buffer");
+    printf("  snapshot of %u entries: %u bytes\n", (unsigned)I2CStats::numEntries(), (unsigned)length);
+
+    // registers beyond the table size are dropped
+    I2CStats::reset();
+    check(I2CStats::numEntries() == 0 && I2CStats::find(SENSOR_ADDRESS, SENSOR_RA_DATA) == nullptr, "reset clears the table");
+    for (int reg = 0; reg < I2C_STATS_MAX_ENTRIES + 4; reg++) {
+        I2CUtil::readByte(&i2c, SENSOR_ADDRESS, reg, data);
+    }
+    check(I2CStats::numEntries() == I2C_STATS_MAX_ENTRIES && I2CStats::getDropped() == 4, "full table drops transactions");
+
+    printf("\nvirtual time: %.2f ms\n", SimClock::now() / 1000.0);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Scan of an 8x8 key matrix against an electrical model, runs on a Linux host:
+//
+//   make -C host test
+//
+// The model pulls a column low if a pressed key connects it to a row that is driven low. Without diodes
+// current also flows backwards through other keys, so pressed keys in other rows and columns connect them
+// (ghosting), and two outputs that are connected with different levels are counted as a short.
+
+#include <mbedExt.h>
+#include <KeypadMatrix.h>
+#include <vector>
+
+#define ROWS 8
+#define COLUMNS 8
+#define ROW_PORT PortC
+#define ROW_SHIFT 0
+#define COLUMN_PORT PortD
+#define COLUMN_SHIFT 8
+
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * The switches, diodes and pull ups of the matrix
+ */
+class MatrixModel
+{
+public:
+    MatrixModel() : shorts(0), directionChanges(0), diodes(false) {
+        memset(keys, 0, sizeof(keys));
+        for (int row = 0; row < ROWS; row++) {
+            int pin = ROW_PORT * 32 + ROW_SHIFT + row;
+            ids.push_back(SimGpio::listen(pin, [this](int) {update();}));
+            ids.push_back(SimGpio::listenDirection(pin, [this](int) {directionChanges++; update();}));
+        }
+        update();
+    };
+
+    ~MatrixModel() {
+        for (int id : ids) {
+            SimGpio::unlisten(id);
+        }
+    };
+
+    void setDiodes(bool diodes) {this->diodes = diodes; update();};
+
+    void set(int row, int column, bool pressed) {
+        if (pressed) {
+            keys[row] |= 1 << column;
+        }else{
+            keys[row] &= ~(1 << column);
+        }
+        update();
+    };
+
+    uint32_t shorts;
+    uint32_t directionChanges;
+private:
+    uint8_t keys[ROWS];
+    std::vector<int> ids;
+    bool diodes;
+
+    void update() {
+        int low[ROWS], high[ROWS];
+        for (int row = 0; row < ROWS; row++) {
+            int pin = ROW_PORT * 32 + ROW_SHIFT + row;
+            bool output = SimGpio::isOutput(pin);
+            low[row] = output && !SimGpio::get(pin);
+            high[row] = output && SimGpio::get(pin);
+        }
+
+        uint8_t lowColumns = 0;
+        if (diodes) {
+            // current only flows from a column through the diode of a key into its row
+            for (int row = 0; row < ROWS; row++) {
+                if (low[row]) {
+                    lowColumns |= keys[row];
+                }
+            }
+        }else{
+            // every set of rows and columns that is connected by pressed keys is one node
+            uint8_t rows = 0;
+            uint8_t done = 0;
+            for (int start = 0; start < ROWS; start++) {
+                if (done & (1 << start)) {
+                    continue;
+                }
+                rows = 1 << start;
+                uint8_t columns = 0;
+                for (bool grown = true; grown;) {
+                    grown = false;
+                    for (int row = 0; row < ROWS; row++) {
+                        if ((rows & (1 << row)) && (keys[row] & ~columns)) {
+                            columns |= keys[row];
+                            grown = true;
+                        }
+                        if (!(rows & (1 << row)) && (keys[row] & columns)) {
+                            rows |= 1 << row;
+                            grown = true;
+                        }
+                    }
+                }
+                done |= rows;
+
+                bool anyLow = false, anyHigh = false;
+                for (int row = 0; row < ROWS; row++) {
+                    if (rows & (1 << row)) {
+                        anyLow |= low[row];
+                        anyHigh |= high[row];
+                    }
+                }
+                if (anyLow && anyHigh) {
+                    shorts++;
+                }
+                if (anyLow) {
+                    lowColumns |= columns;
+                }
+            }
+        }
+
+        for (int column = 0; column < COLUMNS; column++) {
+            SimGpio::set(COLUMN_PORT * 32 + COLUMN_SHIFT + column, !(lowColumns & (1 << column)));
+        }
+    };
+};
+
+std::vector<bool> pressed(ROWS * COLUMNS);
+uint32_t keyEvents = 0;
+
+void onKey(int key, bool isPressed) {
+    pressed[key] = isPressed;
+    keyEvents++;
+}
+
+KeypadMatrix * createKeypad() {
+    KeypadMatrix * keypad = new KeypadMatrix(ROW_PORT, 0xFF << ROW_SHIFT, COLUMN_PORT, 0xFF << COLUMN_SHIFT);
+    keypad->onKey(onKey);
+    return keypad;
+}
+
+int main() {
+    MatrixModel model;
+
+    // without diodes three corners of a rectangle make the fourth key look pressed
+    KeypadMatrix * keypad = createKeypad();
+    model.set(0, 0, true);
+    SimClock::advance(50000);
+    model.set(0, 1, true);
+    SimClock::advance(50000);
+    model.set(1, 0, true);
+    SimClock::advance(50000);
+    keypad_stats_t stats = keypad->getStats();
+    check(pressed[0] && pressed[1] && !pressed[8] && !pressed[9] && stats.ghostFrames > 0, "ambiguous keys not reported");
+
+    // once the rectangle is gone, the real key becomes pressed and the ghost never did
+    model.set(0, 1, false);
+    SimClock::advance(50000);
+    check(pressed[0] && !pressed[1] && pressed[8] && !pressed[9], "real key after ambiguity is gone");
+
+    model.set(0, 0, false);
+    model.set(1, 0, false);
+    SimClock::advance(50000);
+
+    // the selected row is the only output, unselected rows float
+    stats = keypad->getStats();
+    uint32_t changes = model.directionChanges;
+    keypad->scan();
+    printf("frame: %u us, %u direction changes for %d rows\n", (unsigned)keypad->getStats().lastFrameUs,
+            (unsigned)(model.directionChanges - changes), ROWS);
+    check(keypad->getStats().lastFrameUs == ROWS * DEFAULT_KEYPAD_SETTLE_US, "frame cost is the settle time");
+    check(model.directionChanges - changes == 2 * ROWS, "two direction changes per row");
+    delete keypad;
+
+    // with diodes any number of keys can be pressed, a full matrix included
+    model.setDiodes(true);
+    keypad = createKeypad();
+    keypad->setDiodes(true);
+    uint32_t ghostFrames = keypad->getStats().ghostFrames;
+    for (int key = 0; key < ROWS * COLUMNS; key++) {
+        model.set(key / COLUMNS, key % COLUMNS, true);
+        SimClock::advance(1000);
+    }
+    SimClock::advance(50000);
+    int count = 0;
+    for (int key = 0; key < ROWS * COLUMNS; key++) {
+        count += pressed[key];
+    }
+    check(count == ROWS * COLUMNS && keypad->getStats().ghostFrames == ghostFrames, "all 64 keys with diodes");
+
+    for (int key = 0; key < ROWS * COLUMNS; key++) {
+        model.set(key / COLUMNS, key % COLUMNS, false);
+    }
+    SimClock::advance(50000);
+    count = 0;
+    for (int key = 0; key < ROWS * COLUMNS; key++) {
+        count += pressed[key];
+    }
+    check(count == 0, "all 64 keys released");
+    delete keypad;
+
+    // scanning stops while no key is pressed, a key press on a column resumes it
+    InterruptIn * wakeup[COLUMNS];
+    keypad = createKeypad();
+    keypad->setDiodes(true);
+    for (int column = 0; column < COLUMNS; column++) {
+        wakeup[column] = new InterruptIn(COLUMN_PORT * 32 + COLUMN_SHIFT + column);
+        keypad->attachWakeup(wakeup[column]);
+    }
+    SimClock::advance(50000);
+    uint32_t frames = keypad->getStats().frames;
+    SimClock::advance(1000000);
+    check(keypad->getStats().frames == frames, "no frames while idle");
+
+    keyEvents = 0;
+    model.set(5, 3, true);
+    SimClock::advance(50000);
+    stats = keypad->getStats();
+    check(stats.wakeups == 1 && pressed[5 * COLUMNS + 3] && keyEvents == 1, "key press wakes up the scan");
+
+    model.set(5, 3, false);
+    SimClock::advance(50000);
+    frames = keypad->getStats().frames;
+    SimClock::advance(1000000);
+    check(!pressed[5 * COLUMNS + 3] && keypad->getStats().frames == frames, "idle again after release");
+
+    delete keypad;
+    for (int column = 0; column < COLUMNS; column++) {
+        delete wakeup[column];
+    }
+
+    printf("shorts between outputs: %u\n", (unsigned)model.shorts);
+    check(model.shorts == 0, "no shorts between rows");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Checks of LedSequencer, runs on a Linux host:
+//
+//   make -C host test
+//
+// The gamma table is compared with pow(), the edges of error codes are compared with their steps, and
+// finite patterns must stop the ticker when they end.
+
+#include <mbedExt.h>
+#include <LedSequencer.h>
+#include <math.h>
+#include <vector>
+
+#define LED_PIN 200
+
+int failures = 0;
+std::vector<uint64_t> rises;
+std::vector<uint64_t> falls;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * Gets the times of the recorded edges in ms, relative to a start time
+ */
+std::vector<uint32_t> since(const std::vector<uint64_t> & edges, uint64_t startUs) {
+    std::vector<uint32_t> ms;
+    for (uint64_t us : edges) {
+        ms.push_back((us - startUs) / 1000);
+    }
+    return ms;
+}
+
+int main() {
+    // the table computed by the compiler against pow()
+    bool exact = true, monotonic = true;
+    for (int i = 0; i < 256; i++) {
+        exact &= LedSequencer::gamma(i) == (uint8_t)(pow(i / 255.0, LED_GAMMA) * 255 + 0.5);
+        monotonic &= i == 0 || LedSequencer::gamma(i) >= LedSequencer::gamma(i - 1);
+    }
+    check(exact, "gamma table matches pow()");
+    check(monotonic, "gamma table is monotonic");
+
+    Led led(LED_PIN);
+    SimGpio::listen(LED_PIN, [](int level) {(level ? rises : falls).push_back(SimClock::now());});
+    LedSequencer sequencer;
+    int index = sequencer.add(&led);
+
+    // error code 3: three blinks of 200 ms every 500 ms, then a pause until the cycle repeats after 3 s
+    uint64_t start = SimClock::now();
+    sequencer.play(index, &LED_PATTERN_ERROR_CODE, 3);
+    SimClock::advance(3100000);
+    sequencer.stop(index);
+    check(since(rises, start) == std::vector<uint32_t>({0, 500, 1000, 3000}), "error code 3 on");
+    check(since(falls, start) == std::vector<uint32_t>({200, 700, 1200, 3100}), "error code 3 off");
+
+    // an argument of 0 plays the loop once, like 1
+    rises.clear();
+    falls.clear();
+    start = SimClock::now();
+    sequencer.play(index, &LED_PATTERN_ERROR_CODE, 0);
+    SimClock::advance(2100000);
+    sequencer.stop(index);
+    check(since(rises, start) == std::vector<uint32_t>({0, 2000}) && since(falls, start) == std::vector<uint32_t>({200, 2100}),
+            "error code 0 blinks once");
+    SimClock::advance(100000);
+
+    // finite patterns end and stop the ticker, also with loop counts above 255
+    static constexpr led_step_t manySteps[] = {ledSet(255, 10), ledSet(0, 10), ledLoop(0, 300)};
+    static constexpr led_pattern_t many = LED_PATTERN(manySteps, 1);
+    rises.clear();
+    sequencer.play(index, &many);
+    SimClock::advance(7000);
+    check(sequencer.isPlaying(index), "300 blinks playing");
+    // a ticker that keeps running would never run out of events
+    int ticks = 0;
+    while (ticks < 10000 && SimClock::advanceToNextEvent()) {
+        ticks++;
+    }
+    check(ticks < 10000 && !sequencer.isPlaying(index) && rises.size() == 300, "300 blinks, then stopped");
+
+    rises.clear();
+    sequencer.play(index, &LED_PATTERN_FLASH);
+    ticks = 0;
+    while (ticks < 10000 && SimClock::advanceToNextEvent()) {
+        ticks++;
+    }
+    check(ticks == 10 && !sequencer.isPlaying(index) && rises.size() == 1 && SimGpio::get(LED_PIN) == 0, "flash ends, no ticks after it");
+
+    // fades on a PWM channel follow the gamma table
+    SoftPwm pwm;
+    int channel = pwm.add(PortC, 0);
+    int dimmed = sequencer.add(&pwm, channel);
+    sequencer.play(dimmed, &LED_PATTERN_BREATHE);
+    bool rising = true, corrected = true;
+    uint8_t previous = 0;
+    for (int ms = 10; ms < 1500; ms += 10) {
+        SimClock::advance(10000);
+        uint8_t level = sequencer.getLevel(dimmed);
+        rising &= level >= previous;
+        corrected &= pwm.getBrightness(channel) == LedSequencer::gamma(level);
+        previous = level;
+    }
+    check(rising && previous > 240, "breathe fades in for 1.5 s");
+    check(corrected, "PWM brightness is gamma corrected");
+    pwm.stop();
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Benchmark of PortDebouncer with simulated bouncy inputs, runs on a Linux host:
+//
+//   make -C host test
+
+#include <mbedExt.h>
+#include <PortDebouncer.h>
+#include <DebounceManager.h>
+#include <Benchmark.h>
+#include <vector>
+
+#define NUM_PINS 32
+#define DURATION_US 8500000
+#define MAX_BOUNCES 12
+#define TICK_US 2500
+
+typedef struct pin_trace {
+    int level;
+    /* time of the last raw change of every edge */
+    std::vector<uint64_t> edgesUs;
+}pin_trace_t;
+
+typedef struct pin_result {
+    int edges;
+    uint32_t maxLatencyUs;
+}pin_result_t;
+
+uint32_t rngState = 42;
+pin_trace_t traces[NUM_PINS];
+pin_result_t portResults[NUM_PINS];
+pin_result_t managerResults[NUM_PINS];
+std::vector<uint32_t> samples;
+int failures = 0;
+
+// xorshift32, reproducible on every host
+uint32_t rng() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+void schedule(uint64_t us, int pin, int level) {
+    SimClock::schedule(us * 1000, [pin, level]() {SimGpio::set(pin, level);});
+}
+
+/**
+ * Generates the trace of a pin: a stable level for 40 - 400 ms, then an edge with up to 12 bounces of
+ * 20 - 500 us. The bounces of an edge last at most 6 ms, less than the 4 samples needed for a change
+ */
+void generateTrace(int pin) {
+    uint64_t now = 0;
+    pin_trace_t * trace = &traces[pin];
+
+    while (true) {
+        now += 40000 + rng() % 360000;
+        int bounces = rng() % (MAX_BOUNCES + 1);
+        uint64_t duration = 0;
+        for (int i = 0; i < bounces; i++) {
+            duration += 20 + rng() % 480;
+        }
+        if (now + duration + 50000 > DURATION_US) {
+            return;
+        }
+
+        int level = !trace->level;
+        for (int i = 0; i < bounces; i++) {
+            // alternate between the new and the old level
+            schedule(now, pin, i % 2 == 0 ? level : !level);
+            now += 20 + rng() % 480;
+        }
+        schedule(now, pin, level);
+
+        trace->level = level;
+        trace->edgesUs.push_back(now);
+    }
+}
+
+void record(pin_result_t * result, int pin) {
+    // time since the input settled, a debounced edge before that is reported as too late
+    const std::vector<uint64_t> & edges = traces[pin].edgesUs;
+    uint64_t settled = result[pin].edges < (int)edges.size() ? edges[result[pin].edges] : 0;
+    uint32_t latency = SimClock::now() >= settled ? (uint32_t)(SimClock::now() - settled) : UINT32_MAX;
+    result[pin].edges++;
+    result[pin].maxLatencyUs = max(result[pin].maxLatencyUs, latency);
+}
+
+void compare(pin_result_t * results, const char * name) {
+    char what[64];
+    bool edges = true;
+    uint32_t latency = 0;
+    int total = 0;
+
+    for (int pin = 0; pin < NUM_PINS; pin++) {
+        edges &= results[pin].edges == (int)traces[pin].edgesUs.size();
+        latency = max(latency, results[pin].maxLatencyUs);
+        total += results[pin].edges;
+    }
+
+    snprintf(what, sizeof(what), "%s reports every edge once", name);
+    check(edges, what);
+    snprintf(what, sizeof(what), "%s latency <= 10 ms", name);
+    check(latency <= 4 * TICK_US, what);
+    printf("  %d edges, max latency %.1f ms\n", total, latency / 1000.0);
+}
+
+// the same debouncing with an integrator per pin
+uint8_t counters[NUM_PINS];
+uint32_t integratorState;
+
+uint32_t updateIntegrators(uint32_t sample) {
+    uint32_t changed = 0;
+    for (int pin = 0; pin < NUM_PINS; pin++) {
+        uint32_t bit = (sample >> pin) & 1;
+        if (bit == ((integratorState >> pin) & 1)) {
+            counters[pin] = 0;
+        } else if (++counters[pin] == 4) {
+            counters[pin] = 0;
+            integratorState ^= 1u << pin;
+            changed |= 1u << pin;
+        }
+    }
+    return changed;
+}
+
+int main() {
+    for (int pin = 0; pin < NUM_PINS; pin++) {
+        generateTrace(pin);
+    }
+
+    PortDebouncer port(PortA, 0xFFFFFFFF, PullNone, TICK_US);
+    port.onChange([](int pin, bool) {
+        record(portResults, pin);
+    });
+
+    DebounceManager<NUM_PINS> manager(TICK_US, 4);
+    for (int pin = 0; pin < NUM_PINS; pin++) {
+        manager.add(pin);
+    }
+    manager.onChange([](int index, bool) {
+        record(managerResults, index);
+    });
+
+    // the raw port values the debouncers see, for the throughput comparison
+    Ticker sampler;
+    sampler.attach_us([]() {samples.push_back(SimGpio::getPort(PortA));}, TICK_US);
+
+    SimClock::advance(DURATION_US);
+    port.stop();
+    manager.stop();
+    sampler.detach();
+
+    printf("%d pins, %.1f s of bouncy input\n", NUM_PINS, DURATION_US / 1e6);
+    compare(portResults, "PortDebouncer");
+    compare(managerResults, "DebounceManager");
+
+    printf("\n%u port samples\n", (unsigned)samples.size());
+    benchmarkReport("vertical counters, per sample", benchmarkNs([&port] {
+        uint32_t changed = 0;
+        for (uint32_t sample : samples) {
+            changed |= port.update(sample);
+        }
+        benchmarkKeep(&changed);
+    }) / samples.size());
+    benchmarkReport("integrator per pin, per sample", benchmarkNs([] {
+        uint32_t changed = 0;
+        for (uint32_t sample : samples) {
+            changed |= updateIntegrators(sample);
+        }
+        benchmarkKeep(&changed);
+    }) / samples.size());
+    // host sizes: gpio_t is a single int here, but 20 - 28 bytes on most targets
+    printf("sizeof(PortDebouncer) %u, sizeof(DebounceManager<32>) %u, sizeof(gpio_t) %u (host)\n", (unsigned)sizeof(PortDebouncer),
+           (unsigned)sizeof(DebounceManager<NUM_PINS>), (unsigned)sizeof(gpio_t));
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MPU6050_REGISTERS_H_
+#define _MPU6050_REGISTERS_H_
+
+#include <RegisterMap.h>
+
+#define MPU6050_ADDRESS 0x68
+
+/**
+ * Register map of the MPU6050 (subset)
+ */
+namespace MPU6050 {
+
+struct SMPLRT_DIV : RegisterDef<0x19> {
+    typedef RegField<SMPLRT_DIV, 0, 8> DIVIDER;
+};
+
+struct CONFIG : RegisterDef<0x1A> {
+    typedef RegField<CONFIG, 0, 3> DLPF_CFG;
+    typedef RegField<CONFIG, 3, 3> EXT_SYNC_SET;
+    typedef Register<uint8_t, DLPF_CFG, EXT_SYNC_SET> Fields;
+};
+
+struct GYRO_CONFIG : RegisterDef<0x1B> {
+    typedef RegField<GYRO_CONFIG, 3, 2> FS_SEL;
+    typedef RegField<GYRO_CONFIG, 5> ZG_ST;
+    typedef RegField<GYRO_CONFIG, 6> YG_ST;
+    typedef RegField<GYRO_CONFIG, 7> XG_ST;
+    typedef Register<uint8_t, FS_SEL, ZG_ST, YG_ST, XG_ST> Fields;
+};
+
+struct ACCEL_CONFIG : RegisterDef<0x1C> {
+    typedef RegField<ACCEL_CONFIG, 3, 2> AFS_SEL;
+    typedef RegField<ACCEL_CONFIG, 5> ZA_ST;
+    typedef RegField<ACCEL_CONFIG, 6> YA_ST;
+    typedef RegField<ACCEL_CONFIG, 7> XA_ST;
+    typedef Register<uint8_t, AFS_SEL, ZA_ST, YA_ST, XA_ST> Fields;
+};
+
+struct INT_ENABLE : RegisterDef<0x38> {
+    typedef RegField<INT_ENABLE, 0> DATA_RDY_EN;
+    typedef RegField<INT_ENABLE, 3> I2C_MST_INT_EN;
+    typedef RegField<INT_ENABLE, 4> FIFO_OFLOW_EN;
+    typedef Register<uint8_t, DATA_RDY_EN, I2C_MST_INT_EN, FIFO_OFLOW_EN> Fields;
+};
+
+struct INT_STATUS : RegisterDef<0x3A, REG_READ_ONLY> {
+    typedef RegField<INT_STATUS, 0> DATA_RDY_INT;
+    typedef RegField<INT_STATUS, 4> FIFO_OFLOW_INT;
+};
+
+struct SIGNAL_PATH_RESET : RegisterDef<0x68, REG_WRITE_ONLY> {
+    typedef RegField<SIGNAL_PATH_RESET, 0> TEMP_RESET;
+    typedef RegField<SIGNAL_PATH_RESET, 1> ACCEL_RESET;
+    typedef RegField<SIGNAL_PATH_RESET, 2> GYRO_RESET;
+};
+
+struct PWR_MGMT_1 : RegisterDef<0x6B, REG_READ_WRITE, 0x40> {
+    typedef RegField<PWR_MGMT_1, 0, 3> CLKSEL;
+    typedef RegField<PWR_MGMT_1, 3> TEMP_DIS;
+    typedef RegField<PWR_MGMT_1, 5> CYCLE;
+    typedef RegField<PWR_MGMT_1, 6> SLEEP;
+    typedef RegField<PWR_MGMT_1, 7> DEVICE_RESET;
+    typedef Register<uint8_t, CLKSEL, TEMP_DIS, CYCLE, SLEEP, DEVICE_RESET> Fields;
+};
+
+struct WHO_AM_I : RegisterDef<0x75, REG_READ_ONLY, 0x68> {
+    typedef RegField<WHO_AM_I, 1, 6> ADDRESS;
+};
+
+}
+
+#endif
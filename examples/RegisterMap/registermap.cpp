@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <mbedExt.h>
+#include <RegisterMap.h>
+#include "MPU6050Registers.h"
+
+using namespace MPU6050;
+
+// the map is checked at compile time
+static_assert(CONFIG::Fields::mask == 0x3F, "fields of a register must not overlap");
+static_assert((PWR_MGMT_1::CLKSEL::of(1) | PWR_MGMT_1::SLEEP::of(0)).mask == 0x47, "field values of a register are combined");
+static_assert(SIGNAL_PATH_RESET::GYRO_RESET::of(1).fromReset() == 0x04, "write-only registers start from the reset value");
+
+// the initialization is a constant table, fields of the same register are already combined
+constexpr i2c_script_op_t MPU6050_INIT[] = {
+    scriptModify(PWR_MGMT_1::CLKSEL::of(1) | PWR_MGMT_1::SLEEP::of(0)),
+    scriptWrite<SMPLRT_DIV>(7),
+    scriptModify(CONFIG::DLPF_CFG::of(3) | CONFIG::EXT_SYNC_SET::of(0)),
+    scriptModify(GYRO_CONFIG::FS_SEL::of(1)),
+    scriptModify(ACCEL_CONFIG::AFS_SEL::of(2)),
+};
+
+I2C i2c(I2C_SDA, I2C_SCL);
+Serial serial(USBTX, USBRX);
+
+int main() {
+    // direct register access
+    RegisterMap<> mpu(&i2c, MPU6050_ADDRESS);
+    uint8_t id;
+
+    if (mpu.read<WHO_AM_I>(&id) != I2C_OK || id != WHO_AM_I::resetValue) {
+        serial.printf("MPU6050 not found\n");
+        return 1;
+    }
+
+    I2CScript init(MPU6050_INIT);
+    init.run(&i2c, MPU6050_ADDRESS);
+
+    // the same registers through the shadow cache: the read-modify-writes of cached registers do not read
+    RegisterMap<I2CRegisterCache<>> cached(&i2c, MPU6050_ADDRESS, WRITE_BACK);
+    cached.setCacheableRange(SMPLRT_DIV::address, ACCEL_CONFIG::address);
+
+    cached.write(ACCEL_CONFIG::XA_ST::of(0) | ACCEL_CONFIG::YA_ST::of(0) | ACCEL_CONFIG::ZA_ST::of(0));
+    cached.write(GYRO_CONFIG::FS_SEL::of(3));
+    cached.flush();
+
+    uint8_t range;
+    cached.read<ACCEL_CONFIG::AFS_SEL>(&range);
+    serial.printf("Accelerometer range: %d\n", range);
+
+    // mpu.write<WHO_AM_I>(0);                        does not compile, the register is read-only
+    // mpu.write(CONFIG::DLPF_CFG::of(1) | GYRO_CONFIG::FS_SEL::of(1)); does not compile, different registers
+
+    while(1) {
+        sleep();
+    }
+}
@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+// Simulation of SoftPwm, runs on a Linux host:
+//
+//   make -C host test
+//
+// Checks that the interrupt cost per frame doesn't depend on the number of channels, and measures the duty
+// cycle of every channel and the frame period with an interrupt latency of 2 us, which must neither skew
+// the short slots nor make the frames drift.
+
+#include <mbedExt.h>
+#include <SoftPwm.h>
+#include <vector>
+
+#define FRAMES 200
+#define LATENCY_NS 2000
+
+int failures = 0;
+
+void check(bool condition, const char * what) {
+    printf("%-40s %s\n", what, condition ? "ok" : "FAILED");
+    failures += !condition;
+}
+
+/**
+ * Records the edges of a pin and integrates its high time
+ */
+class PinRecorder
+{
+public:
+    PinRecorder(int pin) {
+        id = SimGpio::listen(pin, [this](int level) {edges.push_back({SimClock::nowNanos(), level});});
+    };
+
+    ~PinRecorder() {SimGpio::unlisten(id);};
+
+    /**
+     * Gets the time the pin was high within a window, the pin is low before its first edge
+     */
+    uint64_t getHighNs(uint64_t fromNs, uint64_t toNs) {
+        uint64_t high = 0;
+        uint64_t since = fromNs;
+        int level = 0;
+        for (auto & edge : edges) {
+            if (edge.first > toNs) {
+                break;
+            }
+            if (edge.first > fromNs && level) {
+                high += edge.first - since;
+            }
+            since = edge.first > fromNs ? edge.first : fromNs;
+            level = edge.second;
+        }
+        if (level) {
+            high += toNs - since;
+        }
+        return high;
+    };
+
+    std::vector<std::pair<uint64_t, int>> edges;
+private:
+    int id;
+};
+
+int main() {
+    // the interrupt cost only depends on the number of ports
+    const int channelCounts[] = {4, 16, 32};
+    for (int count : channelCounts) {
+        SoftPwm pwm;
+        for (int i = 0; i < count; i++) {
+            pwm.add(i % 2 ? PortD : PortC, i / 2, i * 8);
+        }
+        SimClock::advance(pwm.getFrameUs());
+        uint32_t writes = SimGpio::getPortWrites();
+        SimClock::advance((uint64_t)pwm.getFrameUs() * FRAMES);
+        float perFrame = (float)(SimGpio::getPortWrites() - writes) / FRAMES;
+        pwm.stop();
+
+        char what[64];
+        snprintf(what, sizeof(what), "%d channels: 8 slots on 2 ports", count);
+        printf("%d channels: %.1f port writes per frame\n", count, perFrame);
+        check(perFrame == 16, what);
+    }
+
+    // duty cycles and frame period with interrupt latency
+    SimClock::setInterruptLatency(LATENCY_NS);
+    const uint8_t values[] = {0, 1, 2, 3, 85, 127, 128, 200, 254, 255};
+    const int numValues = sizeof(values) / sizeof(values[0]);
+    std::vector<PinRecorder *> recorders;
+    SoftPwm pwm;
+    for (int i = 0; i < numValues; i++) {
+        recorders.push_back(new PinRecorder(PortC * 32 + i));
+        pwm.add(PortC, i, values[i]);
+    }
+
+    // the channel with brightness 1 rises at the start of every frame
+    SimClock::advance((uint64_t)pwm.getFrameUs() * (FRAMES + 4));
+    std::vector<std::pair<uint64_t, int>> & frames = recorders[1]->edges;
+    if (frames.size() <= 2 + 2 * FRAMES) {
+        check(false, "frames of the reference channel");
+        return 1;
+    }
+    uint64_t first = frames[2].first;
+    uint64_t last = frames[2 + 2 * FRAMES].first;
+    double periodUs = (last - first) / 1000.0 / FRAMES;
+    printf("frame period %.3f us, expected %u us\n", periodUs, (unsigned)pwm.getFrameUs());
+    check(last - first == (uint64_t)pwm.getFrameUs() * FRAMES * 1000, "no frame drift with latency");
+
+    double maxError = 0;
+    for (int i = 0; i < numValues; i++) {
+        double duty = (double)recorders[i]->getHighNs(first, last) / (last - first);
+        double error = fabs(duty - values[i] / 255.0);
+        maxError = error > maxError ? error : maxError;
+    }
+    printf("largest duty error %.6f (1 LSB is %.6f)\n", maxError, 1 / 255.0);
+    check(maxError < 1e-6, "exact duty cycles with latency");
+
+    // the slots of one frame in order: 1, 2, 4 ... 128 units
+    uint64_t lsbNs = recorders[1]->edges[3].first - recorders[1]->edges[2].first;
+    check(lsbNs == DEFAULT_SOFT_PWM_UNIT_US * 1000, "shortest slot is one unit");
+
+    pwm.stop();
+    for (PinRecorder * recorder : recorders) {
+        delete recorder;
+    }
+    SimClock::setInterruptLatency(0);
+
+    return failures == 0 ? 0 : 1;
+}
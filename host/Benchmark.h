@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_HOST_BENCHMARK_H_
+#define _MBED_EXT_HOST_BENCHMARK_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <chrono>
+
+/*
+ * Helpers for the benchmarks of the host examples. Unlike everything else in the host build they
+ * measure real time, so the results depend on the host and only the ratios are meaningful.
+ */
+
+/**
+ * Keeps the compiler from optimizing away a computation whose result is otherwise unused
+ * @param result pointer to the result
+ */
+inline void benchmarkKeep(const void * result) {
+    asm volatile("" : : "r"(result) : "memory");
+}
+
+/**
+ * Measures the time of a function. The function is run until at least 50 ms have passed
+ * @param func the function to measure
+ * @return the average time of a single run in nanoseconds
+ */
+template<typename F>
+double benchmarkNs(F func) {
+    typedef std::chrono::steady_clock clock;
+
+    // warm up caches and branch predictors
+    func();
+
+    size_t runs = 0;
+    clock::time_point start = clock::now();
+    clock::duration elapsed;
+    do {
+        for (int i = 0; i < 16; i++) {
+            func();
+        }
+        runs += 16;
+        elapsed = clock::now() - start;
+    } while (elapsed < std::chrono::milliseconds(50));
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / runs;
+}
+
+/**
+ * Prints the result of a benchmark
+ * @param what description of the benchmark
+ * @param ns the time of a single run in nanoseconds
+ * @param bytes the number of bytes processed by a single run, 0 to omit the throughput
+ */
+inline void benchmarkReport(const char * what, double ns, size_t bytes = 0) {
+    if (bytes > 0) {
+        printf("%-40s %10.1f ns %8.1f MB/s\n", what, ns, bytes * 1000.0 / ns);
+    } else {
+        printf("%-40s %10.1f ns\n", what, ns);
+    }
+}
+
+#endif
@@ -0,0 +1,382 @@
+#include <Simulator.h>
+
+/* SimClock */
+
+thread_local int SimClock::interruptDepth = 0;
+std::atomic<uint64_t> SimClock::nowNs(0);
+uint64_t SimClock::latencyNs = 0;
+SimClock::event_id_t SimClock::nextId = 1;
+std::multimap<uint64_t, std::pair<SimClock::event_id_t, std::function<void()>>> SimClock::events;
+
+void SimClock::advanceNanos(uint64_t ns) {
+    uint64_t target = nowNs + ns;
+
+    // events may schedule new events, so always take the earliest one
+    while (!events.empty() && events.begin()->first <= target) {
+        auto next = events.begin();
+        std::function<void()> func = next->second.second;
+        if (next->first > nowNs) {
+            nowNs = next->first;
+        }
+        events.erase(next);
+
+        // timers and bus transfers complete in interrupt context
+        enterInterrupt();
+        func();
+        exitInterrupt();
+    }
+
+    if (target > nowNs) {
+        nowNs = target;
+    }
+}
+
+bool SimClock::advanceToNextEvent() {
+    if (events.empty()) {
+        return false;
+    }
+
+    uint64_t next = events.begin()->first;
+    advanceNanos(next > nowNs ? next - nowNs : 0);
+    return true;
+}
+
+SimClock::event_id_t SimClock::schedule(uint64_t timeNs, std::function<void()> func) {
+    event_id_t id = nextId++;
+    events.insert(std::make_pair(timeNs, std::make_pair(id, func)));
+    return id;
+}
+
+void SimClock::cancel(event_id_t id) {
+    for (auto it = events.begin(); it != events.end(); ++it) {
+        if (it->second.first == id) {
+            events.erase(it);
+            return;
+        }
+    }
+}
+
+void SimClock::reset() {
+    nowNs = 0;
+    events.clear();
+}
+
+/* SimGpio */
+
+std::map<int, int> SimGpio::levels;
+std::map<int, bool> SimGpio::outputs;
+uint32_t SimGpio::portWrites = 0;
+std::map<int, std::pair<int, SimGpio::listener_t>> SimGpio::listeners;
+std::map<int, std::pair<int, SimGpio::listener_t>> SimGpio::directionListeners;
+int SimGpio::nextId = 1;
+
+void SimGpio::set(int pin, int level) {
+    level = level ? 1 : 0;
+    int previous = get(pin);
+    levels[pin] = level;
+
+    if (previous == level) {
+        return;
+    }
+
+    // listeners may (un)register listeners, so notify from a copy
+    std::vector<listener_t> toNotify;
+    for (auto & entry : listeners) {
+        if (entry.second.first == pin) {
+            toNotify.push_back(entry.second.second);
+        }
+    }
+
+    for (auto & listener : toNotify) {
+        listener(level);
+    }
+}
+
+int SimGpio::get(int pin) {
+    auto it = levels.find(pin);
+    return it == levels.end() ? 0 : it->second;
+}
+
+void SimGpio::setPort(int port, uint32_t mask, uint32_t value) {
+    portWrites++;
+    for (int i = 0; i < 32; i++) {
+        if (mask & ((uint32_t)1 << i)) {
+            set(port * 32 + i, (value >> i) & 0x01);
+        }
+    }
+}
+
+uint32_t SimGpio::getPort(int port) {
+    uint32_t value = 0;
+    for (int i = 0; i < 32; i++) {
+        value |= (uint32_t)get(port * 32 + i) << i;
+    }
+    return value;
+}
+
+void SimGpio::setOutput(int pin, bool output) {
+    if (isOutput(pin) == output) {
+        return;
+    }
+    outputs[pin] = output;
+
+    std::vector<listener_t> toNotify;
+    for (auto & entry : directionListeners) {
+        if (entry.second.first == pin) {
+            toNotify.push_back(entry.second.second);
+        }
+    }
+
+    for (auto & listener : toNotify) {
+        listener(output);
+    }
+}
+
+bool SimGpio::isOutput(int pin) {
+    auto it = outputs.find(pin);
+    return it != outputs.end() && it->second;
+}
+
+int SimGpio::listenDirection(int pin, listener_t listener) {
+    int id = nextId++;
+    directionListeners[id] = std::make_pair(pin, listener);
+    return id;
+}
+
+int SimGpio::listen(int pin, listener_t listener) {
+    int id = nextId++;
+    listeners[id] = std::make_pair(pin, listener);
+    return id;
+}
+
+void SimGpio::unlisten(int id) {
+    listeners.erase(id);
+    directionListeners.erase(id);
+}
+
+void SimGpio::reset() {
+    levels.clear();
+    outputs.clear();
+    portWrites = 0;
+    listeners.clear();
+    directionListeners.clear();
+}
+
+/* SimI2CDevice */
+
+SimI2CDevice::SimI2CDevice(uint8_t address) : address(address) {
+    for (int i = 0; i < 256; i++) {
+        regs[i] = 0;
+        readOnlyRegs[i] = false;
+        fifoRegs[i] = false;
+    }
+
+    bytesRead = 0;
+    bytesWritten = 0;
+    transfers = 0;
+    autoIncrement = true;
+    autoIncrementFlag = 0;
+    incrementActive = true;
+    pointer = 0;
+    pointerPending = false;
+    nacksPending = 0;
+    present = true;
+    stretchTransferUs = 0;
+    stretchByteUs = 0;
+}
+
+void SimI2CDevice::setAutoIncrement(bool enabled, uint8_t registerFlag) {
+    autoIncrement = enabled;
+    autoIncrementFlag = registerFlag;
+    incrementActive = enabled && registerFlag == 0;
+}
+
+bool SimI2CDevice::addressed(bool read) {
+    transfers++;
+
+    if (!present) {
+        return false;
+    }
+
+    if (nacksPending > 0) {
+        nacksPending--;
+        return false;
+    }
+
+    // the first byte of a write selects the register
+    pointerPending = !read;
+    return true;
+}
+
+uint8_t SimI2CDevice::readByte() {
+    bytesRead++;
+    uint8_t value = onRead(pointer);
+    if (incrementActive && !fifoRegs[pointer]) {
+        pointer++;
+    }
+    return value;
+}
+
+void SimI2CDevice::writeByte(uint8_t value) {
+    bytesWritten++;
+
+    if (pointerPending) {
+        pointerPending = false;
+        pointer = value & ~autoIncrementFlag;
+        incrementActive = autoIncrement && (autoIncrementFlag == 0 || (value & autoIncrementFlag));
+        return;
+    }
+
+    onWrite(pointer, value);
+    if (incrementActive && !fifoRegs[pointer]) {
+        pointer++;
+    }
+}
+
+/* SimI2CBus */
+
+SimI2CBus::SimI2CBus() {
+    hz = 100000;
+    current = nullptr;
+    rawAddressPhase = false;
+    rawRead = false;
+    resetStats();
+}
+
+SimI2CBus * SimI2CBus::global() {
+    static SimI2CBus bus;
+    return &bus;
+}
+
+void SimI2CBus::resetStats() {
+    stats.transfers = 0;
+    stats.bytes = 0;
+    stats.nacks = 0;
+    stats.busyNs = 0;
+}
+
+SimI2CDevice * SimI2CBus::find(uint8_t address7bit) {
+    for (SimI2CDevice * device : devices) {
+        if (device->address == address7bit) {
+            return device;
+        }
+    }
+    return nullptr;
+}
+
+uint64_t SimI2CBus::transferTimeNs(uint8_t address7bit, int numBytes) {
+    // start + 9 bits per byte (8 data + ACK) + stop
+    uint64_t ns = (uint64_t)(2 + 9 * numBytes) * 1000000000ULL / hz;
+
+    SimI2CDevice * device = find(address7bit);
+    if (device && numBytes > 0) {
+        ns += (uint64_t)device->stretchTransferUs * 1000 + (uint64_t)device->stretchByteUs * 1000 * (numBytes - 1);
+    }
+
+    return ns;
+}
+
+void SimI2CBus::busTime(uint8_t address7bit, int numBytes, bool advanceClock) {
+    uint64_t ns = transferTimeNs(address7bit, numBytes);
+    stats.busyNs += ns;
+
+    if (advanceClock) {
+        SimClock::advanceNanos(ns);
+    }
+}
+
+int SimI2CBus::write(int address8bit, const char * data, int length, bool repeated, bool advanceClock) {
+    (void)repeated;
+    uint8_t address = (address8bit >> 1) & 0x7F;
+    SimI2CDevice * device = find(address);
+    stats.transfers++;
+
+    if (!device || !device->addressed(false)) {
+        stats.nacks++;
+        stats.bytes++;
+        busTime(address, 1, advanceClock);
+        return 1;
+    }
+
+    for (int i = 0; i < length; i++) {
+        device->writeByte(data[i]);
+    }
+
+    stats.bytes += length + 1;
+    busTime(address, length + 1, advanceClock);
+    return 0;
+}
+
+int SimI2CBus::read(int address8bit, char * data, int length, bool repeated, bool advanceClock) {
+    (void)repeated;
+    uint8_t address = (address8bit >> 1) & 0x7F;
+    SimI2CDevice * device = find(address);
+    stats.transfers++;
+
+    if (!device || !device->addressed(true)) {
+        stats.nacks++;
+        stats.bytes++;
+        busTime(address, 1, advanceClock);
+        return 1;
+    }
+
+    for (int i = 0; i < length; i++) {
+        data[i] = device->readByte();
+    }
+
+    stats.bytes += length + 1;
+    busTime(address, length + 1, advanceClock);
+    return 0;
+}
+
+void SimI2CBus::start() {
+    rawAddressPhase = true;
+    current = nullptr;
+    stats.busyNs += 1000000000ULL / hz;
+    SimClock::advanceNanos(1000000000ULL / hz);
+}
+
+void SimI2CBus::stop() {
+    current = nullptr;
+    rawAddressPhase = false;
+    stats.busyNs += 1000000000ULL / hz;
+    SimClock::advanceNanos(1000000000ULL / hz);
+}
+
+int SimI2CBus::writeRaw(int data) {
+    stats.bytes++;
+    uint64_t ns = 9 * 1000000000ULL / hz;
+    stats.busyNs += ns;
+    SimClock::advanceNanos(ns);
+
+    if (rawAddressPhase) {
+        rawAddressPhase = false;
+        rawRead = data & 0x01;
+        current = find((data >> 1) & 0x7F);
+        stats.transfers++;
+
+        if (!current || !current->addressed(rawRead)) {
+            current = nullptr;
+            stats.nacks++;
+            return 0;
+        }
+        return 1;
+    }
+
+    if (!current) {
+        return 0;
+    }
+
+    current->writeByte(data);
+    return 1;
+}
+
+int SimI2CBus::readRaw(int ack) {
+    (void)ack;
+    stats.bytes++;
+    uint64_t ns = 9 * 1000000000ULL / hz;
+    stats.busyNs += ns;
+    SimClock::advanceNanos(ns);
+
+    return current ? current->readByte() : 0xFF;
+}
@@ -0,0 +1,432 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_HOST_SIMULATOR_H_
+#define _MBED_EXT_HOST_SIMULATOR_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <atomic>
+#include <map>
+#include <vector>
+
+/*
+ * Simulation backend of the host stand-in for mbed.h. Time is virtual: it only advances through
+ * wait_us(), sleep(), blocking bus transfers and explicit calls to SimClock::advance(), which makes
+ * every run reproducible.
+ */
+
+/**
+ * The virtual clock. Timers, timeouts and tickers of the host build are driven by this clock
+ */
+class SimClock
+{
+public:
+    typedef uint64_t event_id_t;
+
+    /**
+     * Gets the current virtual time
+     * @return time since start of the simulation in microseconds
+     */
+    static uint64_t now() {return nowNs / 1000;};
+
+    /**
+     * Gets the current virtual time
+     * @return time since start of the simulation in nanoseconds
+     */
+    static uint64_t nowNanos() {return nowNs;};
+
+    /**
+     * Advances the virtual time and executes all events that are due in the meantime, in order
+     * @param us the time to advance in microseconds
+     */
+    static void advance(uint64_t us) {advanceNanos(us * 1000);};
+
+    /**
+     * Advances the virtual time and executes all events that are due in the meantime, in order
+     * @param ns the time to advance in nanoseconds
+     */
+    static void advanceNanos(uint64_t ns);
+
+    /**
+     * Advances the virtual time to the next scheduled event and executes it
+     * @return false if no event is scheduled
+     */
+    static bool advanceToNextEvent();
+
+    /**
+     * Schedules a function at an absolute virtual time
+     * @param timeNs the time in nanoseconds
+     * @param func the function to execute
+     * @return id to cancel the event
+     */
+    static event_id_t schedule(uint64_t timeNs, std::function<void()> func);
+
+    /**
+     * Cancels a scheduled event
+     * @param id the id returned by schedule()
+     */
+    static void cancel(event_id_t id);
+
+    /**
+     * Resets the time to zero and drops all scheduled events
+     */
+    static void reset();
+
+    /**
+     * Sets the time from the deadline of a Timeout or Ticker to the start of its handler, like the interrupt
+     * latency of a target. The time advances by the latency before the handler is called
+     * @param ns the latency in nanoseconds, 0 by default
+     */
+    static void setInterruptLatency(uint64_t ns) {latencyNs = ns;};
+
+    /**
+     * Gets the interrupt latency of timer handlers
+     * @return the latency in nanoseconds
+     */
+    static uint64_t getInterruptLatency() {return latencyNs;};
+
+    /**
+     * Gets whether the caller runs in simulated interrupt context, i.e. in an event of the clock or in an InterruptIn handler
+     * @return true in interrupt context
+     */
+    static bool inInterrupt() {return interruptDepth > 0;};
+
+    /**
+     * Marks the start of an interrupt handler that is not called by the clock
+     */
+    static void enterInterrupt() {interruptDepth++;};
+
+    /**
+     * Marks the end of an interrupt handler that is not called by the clock
+     */
+    static void exitInterrupt() {interruptDepth--;};
+private:
+    static thread_local int interruptDepth;
+    static std::atomic<uint64_t> nowNs;
+    static uint64_t latencyNs;
+    static event_id_t nextId;
+    static std::multimap<uint64_t, std::pair<event_id_t, std::function<void()>>> events;
+};
+
+/**
+ * Levels of the simulated pins. Pins of port p are numbered p * 32 to p * 32 + 31
+ */
+class SimGpio
+{
+public:
+    typedef std::function<void(int level)> listener_t;
+
+    /**
+     * Sets the level of an input pin and notifies InterruptIn instances on rising / falling edges
+     * @param pin the pin
+     * @param level 0 or 1
+     */
+    static void set(int pin, int level);
+
+    /**
+     * Gets the level of a pin
+     * @param pin the pin
+     * @return 0 or 1
+     */
+    static int get(int pin);
+
+    /**
+     * Sets the levels of all pins of a port at once
+     * @param port the port
+     * @param mask the pins to change
+     * @param value the new levels
+     */
+    static void setPort(int port, uint32_t mask, uint32_t value);
+
+    /**
+     * Gets the levels of all pins of a port
+     * @param port the port
+     * @return the levels, bit i is pin port * 32 + i
+     */
+    static uint32_t getPort(int port);
+
+    /**
+     * Gets the number of port writes, every call of setPort() counts, including those that don't change a level
+     * @return the number of port writes since the start of the simulation
+     */
+    static uint32_t getPortWrites() {return portWrites;};
+
+    /**
+     * Registers a function that is called whenever the level of a pin changes
+     * @param pin the pin
+     * @param listener the function
+     * @return id to remove the listener
+     */
+    static int listen(int pin, listener_t listener);
+
+    /**
+     * Sets the direction of a pin and notifies the direction listeners if it changes. All pins start as inputs.
+     * The level of an output is the level last set, an input is expected to be driven by the host program
+     * @param pin the pin
+     * @param output true for an output, false for an input
+     */
+    static void setOutput(int pin, bool output);
+
+    /**
+     * Gets the direction of a pin
+     * @param pin the pin
+     * @return true if the pin is an output
+     */
+    static bool isOutput(int pin);
+
+    /**
+     * Registers a function that is called whenever the direction of a pin changes, e.g. to model
+     * what an external circuit sees when an output is released
+     * @param pin the pin
+     * @param listener the function, called with 1 for an output and 0 for an input
+     * @return id to remove the listener with unlisten()
+     */
+    static int listenDirection(int pin, listener_t listener);
+
+    /**
+     * Removes a listener
+     * @param id the id returned by listen() or listenDirection()
+     */
+    static void unlisten(int id);
+
+    /**
+     * Sets all pins to 0 and inputs, and removes all listeners
+     */
+    static void reset();
+private:
+    static std::map<int, int> levels;
+    static std::map<int, bool> outputs;
+    static uint32_t portWrites;
+    static std::map<int, std::pair<int, listener_t>> listeners;
+    static std::map<int, std::pair<int, listener_t>> directionListeners;
+    static int nextId;
+};
+
+class SimI2CBus;
+
+/**
+ * A simulated register based I2C slave. Writes set the register pointer with the first byte and write
+ * the following bytes to consecutive registers, reads return the registers starting at the pointer.
+ * Override onRead() / onWrite() to model volatile registers such as FIFOs or status flags.
+ */
+class SimI2CDevice
+{
+    friend class SimI2CBus;
+public:
+    /**
+     * Constructor. All registers are 0, auto-increment is enabled
+     * @param address the 7-bit address of the device
+     */
+    SimI2CDevice(uint8_t address);
+
+    virtual ~SimI2CDevice() {};
+
+    /**
+     * Gets the 7-bit address of the device
+     * @return the address
+     */
+    uint8_t getAddress() {return address;};
+
+    /**
+     * Sets a register without going through the bus
+     * @param reg the register
+     * @param value the value
+     */
+    void setRegister(uint8_t reg, uint8_t value) {regs[reg] = value;};
+
+    /**
+     * Gets a register without going through the bus
+     * @param reg the register
+     * @return the value
+     */
+    uint8_t getRegister(uint8_t reg) {return regs[reg];};
+
+    /**
+     * Configures auto-increment of the register pointer
+     * @param enabled true if the pointer is incremented after every data byte
+     * @param registerFlag if not 0, the pointer is only incremented if this flag is set in the register address, like many ST sensors do
+     */
+    void setAutoIncrement(bool enabled, uint8_t registerFlag = 0);
+
+    /**
+     * Marks a register as read-only, writes to it are ignored
+     * @param reg the register
+     * @param readOnly true to ignore writes
+     */
+    void setReadOnly(uint8_t reg, bool readOnly = true) {readOnlyRegs[reg] = readOnly;};
+
+    /**
+     * Marks a register as a FIFO port: burst accesses stay at the register instead of incrementing the address
+     * @param reg the register
+     * @param fifo true to disable auto-increment at this register
+     */
+    void setFifoRegister(uint8_t reg, bool fifo = true) {fifoRegs[reg] = fifo;};
+
+    /**
+     * Lets the device respond with NACK to the address byte of the next transfers
+     * @param count number of transfers to reject
+     */
+    void injectNack(int count = 1) {nacksPending += count;};
+
+    /**
+     * Sets whether the device responds at all
+     * @param present false to simulate an unplugged device
+     */
+    void setPresent(bool present) {this->present = present;};
+
+    /**
+     * Simulates clock stretching: the device holds SCL low for the given time
+     * @param usPerTransfer delay after the address byte of every transfer
+     * @param usPerByte delay after every data byte
+     */
+    void setClockStretch(uint32_t usPerTransfer, uint32_t usPerByte) {stretchTransferUs = usPerTransfer; stretchByteUs = usPerByte;};
+
+    /**
+     * Number of data bytes read from the device
+     */
+    uint32_t bytesRead;
+
+    /**
+     * Number of data bytes written to the device, including register addresses
+     */
+    uint32_t bytesWritten;
+
+    /**
+     * Number of transfers addressed to the device
+     */
+    uint32_t transfers;
+protected:
+    /**
+     * Called for every data byte read from the device
+     * @param reg the register the pointer points to
+     * @return the value to return
+     */
+    virtual uint8_t onRead(uint8_t reg) {return regs[reg];};
+
+    /**
+     * Called for every data byte written to the device (except the register address)
+     * @param reg the register the pointer points to
+     * @param value the written value
+     */
+    virtual void onWrite(uint8_t reg, uint8_t value) {if (!readOnlyRegs[reg]) regs[reg] = value;};
+
+    uint8_t regs[256];
+private:
+    uint8_t address;
+    bool readOnlyRegs[256];
+    bool fifoRegs[256];
+    bool autoIncrement;
+    uint8_t autoIncrementFlag;
+    bool incrementActive;
+    uint8_t pointer;
+    bool pointerPending;
+    int nacksPending;
+    bool present;
+    uint32_t stretchTransferUs;
+    uint32_t stretchByteUs;
+
+    bool addressed(bool read);
+    uint8_t readByte();
+    void writeByte(uint8_t value);
+};
+
+/**
+ * Bus usage counters of a simulated bus
+ */
+typedef struct sim_i2c_stats {
+    /* Number of address phases (start or repeated start), including rejected ones */
+    uint32_t transfers;
+    /* Number of bytes on the bus, including address bytes */
+    uint32_t bytes;
+    /* Number of transfers that were not acknowledged */
+    uint32_t nacks;
+    /* Time the bus was busy in nanoseconds */
+    uint64_t busyNs;
+}sim_i2c_stats_t;
+
+/**
+ * A simulated I2C bus. Every I2C object of the host build is connected to SimI2CBus::global() unless
+ * it is attached to another bus. Blocking transfers advance the virtual clock by the modelled bus time:
+ * 9 clock periods per byte plus one for start and stop, and the clock stretching of the device.
+ */
+class SimI2CBus
+{
+public:
+    /**
+     * Constructor
+     */
+    SimI2CBus();
+
+    /**
+     * Connects a device to the bus
+     * @param device the device
+     */
+    void attach(SimI2CDevice * device) {devices.push_back(device);};
+
+    /**
+     * Sets the bus frequency
+     * @param hz SCL frequency in hertz
+     */
+    void frequency(int hz) {this->hz = hz;};
+
+    /**
+     * Gets the bus usage counters
+     * @return the counters
+     */
+    const sim_i2c_stats_t & getStats() {return stats;};
+
+    /**
+     * Resets the bus usage counters
+     */
+    void resetStats();
+
+    /**
+     * Gets the bus every I2C object is connected to by default
+     * @return the global bus
+     */
+    static SimI2CBus * global();
+
+    /* used by the I2C stand-in */
+    int write(int address8bit, const char * data, int length, bool repeated, bool advanceClock = true);
+    int read(int address8bit, char * data, int length, bool repeated, bool advanceClock = true);
+    void start();
+    void stop();
+    int writeRaw(int data);
+    int readRaw(int ack);
+    uint64_t transferTimeNs(uint8_t address7bit, int numBytes);
+private:
+    std::vector<SimI2CDevice *> devices;
+    int hz;
+    sim_i2c_stats_t stats;
+    SimI2CDevice * current;
+    bool rawAddressPhase;
+    bool rawRead;
+
+    SimI2CDevice * find(uint8_t address7bit);
+    void busTime(uint8_t address7bit, int numBytes, bool advanceClock);
+};
+
+#endif
@@ -0,0 +1,538 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+ * Stand-in for mbed.h to build and test the library on a Linux host. Only the parts of the mbed API
+ * that are used by the library are provided. GPIOs, timers and I2C are backed by the simulation in
+ * Simulator.h, see the README for details.
+ */
+
+#ifndef _MBED_EXT_HOST_MBED_H_
+#define _MBED_EXT_HOST_MBED_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <sys/types.h>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <type_traits>
+#include <Simulator.h>
+
+#define DEVICE_I2C_ASYNCH 1
+
+/* Callbacks */
+
+template<typename F>
+class Callback;
+
+/**
+ * Simplified version of mbed::Callback based on std::function
+ */
+template<typename R, typename... A>
+class Callback<R(A...)> {
+public:
+    Callback() {}
+    Callback(std::nullptr_t) {}
+    Callback(R (*func)(A...)) {if (func) f = func;}
+
+    template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Callback>::value && !std::is_pointer<typename std::decay<F>::type>::value>::type>
+    Callback(F func) : f(func) {}
+
+    template<typename T, typename U>
+    Callback(U * obj, R (T::*method)(A...)) : f([obj, method](A... args) {return (obj->*method)(args...);}) {}
+
+    template<typename T, typename U>
+    Callback(const U * obj, R (T::*method)(A...) const) : f([obj, method](A... args) {return (obj->*method)(args...);}) {}
+
+    R call(A... args) const {return f(args...);}
+    R operator()(A... args) const {return f(args...);}
+    explicit operator bool() const {return (bool)f;}
+private:
+    std::function<R(A...)> f;
+};
+
+template<typename R, typename... A>
+Callback<R(A...)> callback(R (*func)(A...)) {
+    return Callback<R(A...)>(func);
+}
+
+template<typename T, typename U, typename R, typename... A>
+Callback<R(A...)> callback(U * obj, R (T::*method)(A...)) {
+    return Callback<R(A...)>(obj, method);
+}
+
+template<typename T, typename U, typename R, typename... A>
+Callback<R(A...)> callback(const U * obj, R (T::*method)(A...) const) {
+    return Callback<R(A...)>(obj, method);
+}
+
+typedef Callback<void(int)> event_callback_t;
+
+/* Platform */
+
+typedef int PinName;
+typedef int PortName;
+
+enum {
+    NC = -1,
+    LED1 = 0,
+    LED2,
+    LED3,
+    USER_BUTTON,
+    I2C_SDA,
+    I2C_SCL,
+    USBTX,
+    USBRX
+};
+
+enum {
+    PortA = 0,
+    PortB,
+    PortC,
+    PortD
+};
+
+typedef enum {
+    PullNone,
+    PullUp,
+    PullDown,
+    OpenDrain
+}PinMode;
+
+inline void core_util_critical_section_enter() {}
+inline void core_util_critical_section_exit() {}
+inline bool core_util_is_isr_active() {return SimClock::inInterrupt();}
+
+inline uint32_t us_ticker_read() {return (uint32_t)SimClock::now();}
+inline void wait_us(int us) {SimClock::advance(us);}
+inline void wait_ms(int ms) {SimClock::advance((uint64_t)ms * 1000);}
+inline void wait(float s) {SimClock::advance((uint64_t)(s * 1000000));}
+
+/**
+ * Advances the virtual time to the next scheduled event
+ */
+inline void sleep() {SimClock::advanceToNextEvent();}
+
+namespace Kernel {
+    inline uint64_t get_ms_count() {return SimClock::now() / 1000;}
+}
+
+/* RTOS, backed by host threads. Only the synchronization primitives use real time */
+
+#define MBED_CONF_RTOS_PRESENT 1
+
+namespace rtos {
+
+class Mutex {
+public:
+    void lock() {mutex.lock();}
+    bool trylock() {return mutex.try_lock();}
+    void unlock() {mutex.unlock();}
+private:
+    std::recursive_mutex mutex;
+};
+
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0, uint16_t maxCount = 0xFFFF) : count(count), maxCount(maxCount) {}
+    void acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        available.wait(lock, [this] {return count > 0;});
+        count--;
+    }
+    bool try_acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == 0) {
+            return false;
+        }
+        count--;
+        return true;
+    }
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count < maxCount) {
+            count++;
+        }
+        available.notify_one();
+    }
+private:
+    std::mutex mutex;
+    std::condition_variable available;
+    int32_t count;
+    int32_t maxCount;
+};
+
+class Thread {
+public:
+    void start(Callback<void()> task) {thread = std::thread(task);}
+    void join() {if (thread.joinable()) thread.join();}
+    ~Thread() {join();}
+private:
+    std::thread thread;
+};
+
+}
+
+/* Digital IO */
+
+typedef struct {
+    PinName pin;
+}gpio_t;
+
+inline void gpio_init_in_ex(gpio_t * obj, PinName pin, PinMode mode) {
+    obj->pin = pin;
+    if (mode == PullUp) {
+        SimGpio::set(pin, 1);
+    }
+}
+inline int gpio_read(gpio_t * obj) {return SimGpio::get(obj->pin);}
+inline void gpio_write(gpio_t * obj, int value) {SimGpio::set(obj->pin, value);}
+inline int gpio_is_connected(const gpio_t * obj) {return obj->pin != NC;}
+
+typedef enum {
+    PIN_INPUT,
+    PIN_OUTPUT
+}PinDirection;
+
+inline void gpio_dir(gpio_t * obj, PinDirection direction) {SimGpio::setOutput(obj->pin, direction == PIN_OUTPUT);}
+inline void gpio_init_inout(gpio_t * obj, PinName pin, PinDirection direction, PinMode mode, int value) {
+    obj->pin = pin;
+    if (direction == PIN_OUTPUT) {
+        SimGpio::set(pin, value);
+    } else if (mode == PullUp) {
+        SimGpio::set(pin, 1);
+    }
+    gpio_dir(obj, direction);
+}
+
+typedef struct {
+    PortName port;
+    uint32_t mask;
+}port_t;
+
+inline void port_init(port_t * obj, PortName port, int mask, PinDirection dir) {(void)dir; obj->port = port; obj->mask = mask;}
+inline void port_write(port_t * obj, int value) {SimGpio::setPort(obj->port, obj->mask, value);}
+inline int port_read(port_t * obj) {return SimGpio::getPort(obj->port) & obj->mask;}
+inline PinName port_pin(PortName port, int pin_n) {return port * 32 + pin_n;}
+
+class DigitalIn {
+public:
+    DigitalIn(PinName pin, PinMode mode = PullNone) : pin(pin) {this->mode(mode);}
+    int read() {return SimGpio::get(pin);}
+    void mode(PinMode mode) {if (mode == PullUp) SimGpio::set(pin, 1);}
+    int is_connected() {return pin != NC;}
+    operator int() {return read();}
+protected:
+    PinName pin;
+};
+
+class DigitalOut {
+public:
+    DigitalOut(PinName pin, int value = 0) : pin(pin) {write(value); SimGpio::setOutput(pin, true);}
+    void write(int value) {SimGpio::set(pin, value);}
+    int read() {return SimGpio::get(pin);}
+    int is_connected() {return pin != NC;}
+    DigitalOut & operator=(int value) {write(value); return *this;}
+    operator int() {return read();}
+protected:
+    PinName pin;
+};
+
+class InterruptIn {
+public:
+    InterruptIn(PinName pin, PinMode mode = PullNone) : pin(pin), enabled(true) {
+        if (mode == PullUp) {
+            SimGpio::set(pin, 1);
+        }
+        listener = SimGpio::listen(pin, [this](int level) {
+            if (!enabled) {
+                return;
+            }
+            SimClock::enterInterrupt();
+            if (level && riseHandler) {
+                riseHandler();
+            } else if (!level && fallHandler) {
+                fallHandler();
+            }
+            SimClock::exitInterrupt();
+        });
+    }
+    ~InterruptIn() {SimGpio::unlisten(listener);}
+    int read() {return SimGpio::get(pin);}
+    void rise(Callback<void()> func) {riseHandler = func;}
+    void fall(Callback<void()> func) {fallHandler = func;}
+    void mode(PinMode mode) {if (mode == PullUp) SimGpio::set(pin, 1);}
+    void enable_irq() {enabled = true;}
+    void disable_irq() {enabled = false;}
+    operator int() {return read();}
+private:
+    PinName pin;
+    bool enabled;
+    int listener;
+    Callback<void()> riseHandler;
+    Callback<void()> fallHandler;
+};
+
+class PortIn {
+public:
+    PortIn(PortName port, int mask = 0xFFFFFFFF) : port(port), mask(mask) {}
+    int read() {return SimGpio::getPort(port) & mask;}
+    void mode(PinMode mode) {if (mode == PullUp) SimGpio::setPort(port, mask, 0xFFFFFFFF);}
+    operator int() {return read();}
+private:
+    PortName port;
+    uint32_t mask;
+};
+
+class PortOut {
+public:
+    PortOut(PortName port, int mask = 0xFFFFFFFF) : port(port), mask(mask) {}
+    void write(int value) {SimGpio::setPort(port, mask, value);}
+    int read() {return SimGpio::getPort(port) & mask;}
+    PortOut & operator=(int value) {write(value); return *this;}
+    operator int() {return read();}
+private:
+    PortName port;
+    uint32_t mask;
+};
+
+class PortInOut {
+public:
+    PortInOut(PortName port, int mask = 0xFFFFFFFF) : port(port), mask(mask) {}
+    void write(int value) {SimGpio::setPort(port, mask, value);}
+    int read() {return SimGpio::getPort(port) & mask;}
+    void output() {setDirection(true);}
+    void input() {setDirection(false);}
+    void mode(PinMode mode) {if (mode == PullUp) SimGpio::setPort(port, mask, 0xFFFFFFFF);}
+    PortInOut & operator=(int value) {write(value); return *this;}
+    operator int() {return read();}
+private:
+    PortName port;
+    uint32_t mask;
+
+    void setDirection(bool output) {
+        for (int i = 0; i < 32; i++) {
+            if (mask & ((uint32_t)1 << i)) {
+                SimGpio::setOutput(port * 32 + i, output);
+            }
+        }
+    }
+};
+
+/* Time */
+
+class Timer {
+public:
+    Timer() : running(false), startUs(0), accumulatedUs(0) {}
+    void start() {if (!running) {startUs = SimClock::now(); running = true;}}
+    void stop() {if (running) {accumulatedUs += SimClock::now() - startUs; running = false;}}
+    void reset() {accumulatedUs = 0; startUs = SimClock::now();}
+    int read_us() {return (int)elapsedUs();}
+    int read_ms() {return (int)(elapsedUs() / 1000);}
+    float read() {return elapsedUs() / 1000000.0f;}
+    std::chrono::microseconds elapsed_time() {return std::chrono::microseconds(elapsedUs());}
+private:
+    bool running;
+    uint64_t startUs;
+    uint64_t accumulatedUs;
+
+    uint64_t elapsedUs() {return accumulatedUs + (running ? SimClock::now() - startUs : 0);}
+};
+
+typedef Timer LowPowerTimer;
+
+class Timeout {
+public:
+    Timeout() : scheduled(false), periodic(false), intervalUs(0), id(0) {}
+    virtual ~Timeout() {detach();}
+    void attach(Callback<void()> func, float seconds) {attach_us(func, (uint64_t)(seconds * 1000000));}
+    template<typename Rep, typename Period>
+    void attach(Callback<void()> func, std::chrono::duration<Rep, Period> t) {attach_us(func, std::chrono::duration_cast<std::chrono::microseconds>(t).count());}
+    void attach_us(Callback<void()> func, uint64_t us) {
+        detach();
+        handler = func;
+        intervalUs = us;
+        arm(SimClock::nowNanos() + us * 1000);
+    }
+    void detach() {
+        if (scheduled) {
+            SimClock::cancel(id);
+            scheduled = false;
+        }
+    }
+protected:
+    Callback<void()> handler;
+    bool scheduled;
+    bool periodic;
+    uint64_t intervalUs;
+    SimClock::event_id_t id;
+
+    void arm(uint64_t timeNs) {
+        scheduled = true;
+        id = SimClock::schedule(timeNs, [this, timeNs]() {
+            scheduled = false;
+            if (periodic) {
+                // rearm before calling the handler, so it can detach
+                arm(timeNs + intervalUs * 1000);
+            }
+            if (SimClock::getInterruptLatency()) {
+                SimClock::advanceNanos(SimClock::getInterruptLatency());
+            }
+            if (handler) {
+                handler();
+            }
+        });
+    }
+};
+
+typedef Timeout LowPowerTimeout;
+
+class Ticker : public Timeout {
+public:
+    Ticker() {periodic = true;}
+};
+
+typedef Ticker LowPowerTicker;
+
+/* I2C */
+
+/**
+ * Serial port that writes to stdout
+ */
+class Serial {
+public:
+    Serial(PinName tx, PinName rx, int baud = 9600) {(void)tx; (void)rx; (void)baud;}
+    void baud(int baudrate) {(void)baudrate;}
+    int printf(const char * format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int length = vprintf(format, args);
+        va_end(args);
+        return length;
+    }
+    int putc(int c) {return putchar(c);}
+    int puts(const char * str) {return fputs(str, stdout);}
+    ssize_t write(const void * buffer, size_t length) {return fwrite(buffer, 1, length, stdout);}
+};
+
+#define I2C_EVENT_ERROR               (1 << 1)
+#define I2C_EVENT_ERROR_NO_SLAVE      (1 << 2)
+#define I2C_EVENT_TRANSFER_COMPLETE   (1 << 3)
+#define I2C_EVENT_TRANSFER_EARLY_NACK (1 << 4)
+#define I2C_EVENT_ALL                 (I2C_EVENT_ERROR | I2C_EVENT_TRANSFER_COMPLETE | I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK)
+
+/**
+ * I2C master connected to a simulated bus
+ */
+class I2C {
+public:
+    I2C(PinName sda, PinName scl) : bus(SimI2CBus::global()), busy(false) {(void)sda; (void)scl;}
+
+    /**
+     * Connects the master to another simulated bus (host build only)
+     * @param simBus the bus
+     */
+    void attachBus(SimI2CBus * simBus) {bus = simBus;}
+
+    void frequency(int hz) {bus->frequency(hz);}
+    int read(int address, char * data, int length, bool repeated = false) {lock(); int result = bus->read(address, data, length, repeated); unlock(); return result;}
+    int write(int address, const char * data, int length, bool repeated = false) {lock(); int result = bus->write(address, data, length, repeated); unlock(); return result;}
+    int read(int ack) {return bus->readRaw(ack);}
+    int write(int data) {return bus->writeRaw(data);}
+    void start() {bus->start();}
+    void stop() {bus->stop();}
+
+    /**
+     * Like on mbed-os, a single mutex shared by all I2C objects makes every transfer atomic. With an RTOS,
+     * locking it in interrupt context is a fatal error
+     */
+    void lock() {
+        if (core_util_is_isr_active()) {
+            fprintf(stderr, "Mutex lock failed: I2C::lock() called in interrupt context\n");
+            abort();
+        }
+        mutex().lock();
+    }
+    void unlock() {mutex().unlock();}
+
+    /**
+     * Asynchronous transfer. The data is exchanged and the callback is called when the modelled bus time has passed
+     */
+    int transfer(int address, const char * tx, int txLength, char * rx, int rxLength, const event_callback_t & callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false) {
+        (void)repeated;
+        lock();
+        if (busy) {
+            unlock();
+            return -1;
+        }
+
+        busy = true;
+        uint8_t address7bit = (address >> 1) & 0x7F;
+        uint64_t ns = (txLength > 0 ? bus->transferTimeNs(address7bit, txLength + 1) : 0) + (rxLength > 0 ? bus->transferTimeNs(address7bit, rxLength + 1) : 0);
+
+        transferId = SimClock::schedule(SimClock::nowNanos() + ns, [=]() {
+            int result = 0;
+            if (txLength > 0) {
+                result = bus->write(address, tx, txLength, rxLength > 0, false);
+            }
+            if (result == 0 && rxLength > 0) {
+                result = bus->read(address, rx, rxLength, false, false);
+            }
+
+            busy = false;
+            int flags = result == 0 ? I2C_EVENT_TRANSFER_COMPLETE : I2C_EVENT_ERROR_NO_SLAVE;
+            if ((flags & event) && callback) {
+                callback(flags & event);
+            }
+        });
+
+        unlock();
+        return 0;
+    }
+
+    void abort_transfer() {
+        if (busy) {
+            SimClock::cancel(transferId);
+            busy = false;
+        }
+    }
+private:
+    SimI2CBus * bus;
+    bool busy;
+    SimClock::event_id_t transferId;
+
+    static std::recursive_mutex & mutex() {
+        static std::recursive_mutex instance;
+        return instance;
+    }
+};
+
+#endif
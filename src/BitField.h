@@ -0,0 +1,298 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_BITFIELD_H_
+#define _MBED_EXT_BITFIELD_H_
+
+#include <stdint.h>
+
+/* Typed bit manipulation */
+
+/*
+ * Type safe counterparts of the macros in Bytes.h. Every argument is evaluated exactly once and
+ * the functions return the new value instead of modifying their argument, so they can be used
+ * in expressions and in constant expressions.
+ */
+
+/**
+ * Gets the value of a bit at a specific position
+ * @param v the value that is read
+ * @param n the bit position to read, where 0 identifies the LSB
+ * @return the bit value at position n
+ */
+template<typename T>
+constexpr bool bitRead(T v, uint8_t n) {
+    return (v >> n) & 0x01;
+}
+
+/**
+ * Sets the bit at a specific position to 1
+ * @param v the original value
+ * @param n the bit position to set, where 0 identifies the LSB
+ * @return v with bit n set
+ */
+template<typename T>
+constexpr T bitSet(T v, uint8_t n) {
+    return static_cast<T>(v | (static_cast<T>(1) << n));
+}
+
+/**
+ * Sets the bit at a specific position to 0
+ * @param v the original value
+ * @param n the bit position to clear, where 0 identifies the LSB
+ * @return v with bit n cleared
+ */
+template<typename T>
+constexpr T bitClear(T v, uint8_t n) {
+    return static_cast<T>(v & ~(static_cast<T>(1) << n));
+}
+
+/**
+ * Sets the bit at a specific position to the given value
+ * @param v the original value
+ * @param n the bit position to write, where 0 identifies the LSB
+ * @param bit the new value of the bit
+ * @return v with bit n set to bit
+ */
+template<typename T>
+constexpr T bitWrite(T v, uint8_t n, bool bit) {
+    return bit ? bitSet(v, n) : bitClear(v, n);
+}
+
+/**
+ * Toggles the bit at a specific position
+ * @param v the original value
+ * @param n the bit position to toggle, where 0 identifies the LSB
+ * @return v with bit n inverted
+ */
+template<typename T>
+constexpr T bitToggle(T v, uint8_t n) {
+    return static_cast<T>(v ^ (static_cast<T>(1) << n));
+}
+
+/**
+ * Combines two bytes to a uint16_t value
+ * @param high the higher byte
+ * @param low the lower byte
+ * @return the combined value
+ */
+constexpr uint16_t combineUint16(uint8_t high, uint8_t low) {
+    return static_cast<uint16_t>((static_cast<uint16_t>(high) << 8) | low);
+}
+
+/**
+ * Gets the higher order byte of a 16-bit value
+ * @param v the 16-bit value
+ * @return the high byte
+ */
+constexpr uint8_t highByte(uint16_t v) {
+    return static_cast<uint8_t>(v >> 8);
+}
+
+/**
+ * Gets the lower order byte of a 16-bit value
+ * @param v the 16-bit value
+ * @return the low byte
+ */
+constexpr uint8_t lowByte(uint16_t v) {
+    return static_cast<uint8_t>(v & 0xFF);
+}
+
+
+/* Register field descriptors */
+
+
+/**
+ * A set of field values that is written to a register in a single read-modify-write step.
+ * Instances are usually created with BitField::of() and combined using the | operator.
+ */
+template<typename T>
+struct FieldValue {
+    /**
+     * The bits that are modified
+     */
+    T mask;
+    /**
+     * The new values of the modified bits, already shifted into position
+     */
+    T bits;
+
+    /**
+     * Constructor
+     * @param mask the bits that are modified
+     * @param bits the new values of the modified bits
+     */
+    constexpr FieldValue(T mask, T bits) : mask(mask), bits(static_cast<T>(bits & mask)) {}
+
+    /**
+     * Applies the field values to a register value
+     * @param reg the current register value
+     * @return the new register value
+     */
+    constexpr T apply(T reg) const {
+        return static_cast<T>((reg & ~mask) | bits);
+    }
+
+    /**
+     * Combines two field values. If both modify the same bits, the right hand side wins
+     * @param other the field values to add
+     * @return the combined field values
+     */
+    constexpr FieldValue operator|(FieldValue other) const {
+        return FieldValue(static_cast<T>(mask | other.mask), static_cast<T>((bits & ~other.mask) | other.bits));
+    }
+};
+
+/**
+ * Describes a field of Width bits inside a register of type T starting at bit Offset.
+ * All masks and shifts are computed at compile time.
+ *
+ * @code
+ * typedef BitField<3, 2> AccelRange; // bits 4..3 of an 8-bit register
+ * reg = AccelRange::set(reg, 2);
+ * @endcode
+ */
+template<uint8_t Offset, uint8_t Width = 1, typename T = uint8_t>
+struct BitField {
+    static_assert(Width > 0, "a field has to be at least one bit wide");
+    static_assert(Offset + Width <= sizeof(T) * 8, "the field does not fit into the register type");
+
+    typedef T value_type;
+
+    /**
+     * Position of the LSB of the field
+     */
+    static constexpr uint8_t offset = Offset;
+
+    /**
+     * Number of bits of the field
+     */
+    static constexpr uint8_t width = Width;
+
+    /**
+     * Largest value that can be stored in the field
+     */
+    static constexpr T maxValue = static_cast<T>(static_cast<T>(~static_cast<T>(0)) >> (sizeof(T) * 8 - Width));
+
+    /**
+     * Mask of the field inside the register
+     */
+    static constexpr T mask = static_cast<T>(maxValue << Offset);
+
+    /**
+     * Extracts the field from a register value
+     * @param reg the register value
+     * @return the value of the field
+     */
+    static constexpr T get(T reg) {
+        return static_cast<T>((reg >> Offset) & maxValue);
+    }
+
+    /**
+     * Sets the field inside a register value
+     * @param reg the original register value
+     * @param value the new field value. Bits that do not fit into the field are discarded
+     * @return the new register value
+     */
+    static constexpr T set(T reg, T value) {
+        return of(value).apply(reg);
+    }
+
+    /**
+     * Creates a field value that can be combined with other field values of the same register
+     * @param value the new field value. Bits that do not fit into the field are discarded
+     * @return the field value
+     */
+    static constexpr FieldValue<T> of(T value) {
+        return FieldValue<T>(mask, static_cast<T>(value << Offset));
+    }
+};
+
+/**
+ * Groups the fields of a register. The fields must not overlap, which is checked at compile time.
+ *
+ * @code
+ * typedef BitField<0> Enable;
+ * typedef BitField<1, 3> Mode;
+ * typedef Register<uint8_t, Enable, Mode> Config;
+ *
+ * reg = Config::modify(reg, Enable::of(1) | Mode::of(5));
+ * @endcode
+ */
+template<typename T, typename... Fields>
+struct Register {
+    static_assert(sizeof...(Fields) > 0, "a register needs at least one field");
+
+    typedef T value_type;
+
+    /**
+     * Mask of all bits that belong to one of the fields
+     */
+    static constexpr T mask = static_cast<T>((static_cast<T>(0) | ... | Fields::mask));
+
+    static_assert(((uint64_t)0 + ... + (uint64_t)Fields::mask) == (uint64_t)mask, "register fields must not overlap");
+    static_assert((... && (sizeof(typename Fields::value_type) == sizeof(T))), "field and register types do not match");
+
+    /**
+     * Gets whether a field belongs to this register
+     * @return true if F is one of the fields of the register
+     */
+    template<typename F>
+    static constexpr bool contains() {
+        return (... || (F::mask == Fields::mask && F::offset == Fields::offset));
+    }
+
+    /**
+     * Extracts a field from a register value
+     * @param reg the register value
+     * @return the value of field F
+     */
+    template<typename F>
+    static constexpr T get(T reg) {
+        static_assert(contains<F>(), "the field does not belong to this register");
+        return F::get(reg);
+    }
+
+    /**
+     * Applies multiple field values in a single read-modify-write step
+     * @param reg the current register value
+     * @param values the new field values, combined with the | operator
+     * @return the new register value
+     */
+    static constexpr T modify(T reg, FieldValue<T> values) {
+        return values.apply(reg);
+    }
+
+    /**
+     * Gets whether writing the field values replaces the whole register, i.e. the current value
+     * does not have to be read before writing
+     * @param values the field values to write
+     * @return true if every bit of the register is covered
+     */
+    static constexpr bool replacesAll(FieldValue<T> values) {
+        return values.mask == static_cast<T>(~static_cast<T>(0));
+    }
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include <BitStream.h>
+#include <ByteOrder.h>
+
+BitWriter::BitWriter(uint8_t * buffer, size_t size) : buffer(buffer), size(size) {
+    bytePos = 0;
+    bits = 0;
+    numBuffered = 0;
+    overflow = false;
+}
+
+bool BitWriter::write(uint32_t value, uint8_t numBits) {
+    if (numBits == 0 || numBits > 32) {
+        return false;
+    }
+
+    if (bitsWritten() + numBits > size * 8) {
+        // not enough space left
+        overflow = true;
+        return false;
+    }
+
+    uint32_t mask = numBits == 32 ? 0xFFFFFFFF : ((uint32_t)1 << numBits) - 1;
+    bits |= (uint64_t)(value & mask) << numBuffered;
+    numBuffered += numBits;
+
+    if (numBuffered >= 32 && bytePos + 4 <= size) {
+        // store a whole word at once
+        uint32_t word = (uint32_t)bits;
+        if (NATIVE_BYTE_ORDER != LSB_FIRST) {
+            word = __builtin_bswap32(word);
+        }
+        memcpy(buffer + bytePos, &word, sizeof(word));
+
+        bytePos += 4;
+        bits >>= 32;
+        numBuffered -= 32;
+    }
+
+    return true;
+}
+
+bool BitWriter::writeVarint(uint32_t value) {
+    // a 32-bit value needs at most 5 groups
+    uint8_t numGroups = 1;
+    while (numGroups < 5 && (value >> (7 * numGroups)) != 0) {
+        numGroups++;
+    }
+
+    if (bitsWritten() + numGroups * 8 > size * 8) {
+        overflow = true;
+        return false;
+    }
+
+    for (uint8_t i = 0; i < numGroups; i++) {
+        uint32_t group = (value >> (7 * i)) & 0x7F;
+        bool more = i + 1 < numGroups;
+        write(group | (more << 7), 8);
+    }
+
+    return true;
+}
+
+size_t BitWriter::flush() {
+    // remaining bits are written byte by byte
+    while (numBuffered > 0) {
+        buffer[bytePos++] = (uint8_t)bits;
+        bits >>= 8;
+        numBuffered = numBuffered > 8 ? numBuffered - 8 : 0;
+    }
+
+    bits = 0;
+    return bytePos;
+}
+
+BitReader::BitReader(const uint8_t * buffer, size_t size) : buffer(buffer), size(size) {
+    bytePos = 0;
+    bits = 0;
+    numBuffered = 0;
+    overflow = false;
+}
+
+void BitReader::refill() {
+    if (numBuffered <= 32 && bytePos + 4 <= size) {
+        // load a whole word at once
+        bits |= (uint64_t)loadUint32(buffer + bytePos, LSB_FIRST) << numBuffered;
+        bytePos += 4;
+        numBuffered += 32;
+        return;
+    }
+
+    while (numBuffered <= 56 && bytePos < size) {
+        bits |= (uint64_t)buffer[bytePos++] << numBuffered;
+        numBuffered += 8;
+    }
+}
+
+uint32_t BitReader::read(uint8_t numBits) {
+    if (numBits == 0 || numBits > 32) {
+        return 0;
+    }
+
+    if (numBuffered < numBits) {
+        refill();
+
+        if (numBuffered < numBits) {
+            // end of buffer reached
+            overflow = true;
+            return 0;
+        }
+    }
+
+    uint32_t mask = numBits == 32 ? 0xFFFFFFFF : ((uint32_t)1 << numBits) - 1;
+    uint32_t value = (uint32_t)bits & mask;
+    bits >>= numBits;
+    numBuffered -= numBits;
+
+    return value;
+}
+
+uint32_t BitReader::readVarint() {
+    uint32_t value = 0;
+
+    for (uint8_t i = 0; i < 5; i++) {
+        uint32_t group = read(8);
+        if (overflow) {
+            return 0;
+        }
+
+        value |= (group & 0x7F) << (7 * i);
+        if (!(group & 0x80)) {
+            break;
+        }
+    }
+
+    return value;
+}
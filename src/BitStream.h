@@ -0,0 +1,193 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_BIT_STREAM_H_
+#define _MBED_EXT_BIT_STREAM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Fields are packed LSB first: the first bit written is bit 0 of the first byte. Both classes
+ * buffer up to 64 bits in an accumulator and move data from and to memory 32 bits at a time.
+ */
+
+/**
+ * Writes fields of arbitrary bit width into a caller supplied buffer
+ */
+class BitWriter
+{
+public:
+    /**
+     * Constructor
+     * @param buffer the buffer the bits are written to
+     * @param size the size of the buffer in bytes
+     */
+    BitWriter(uint8_t * buffer, size_t size);
+
+    /**
+     * Writes the lower bits of a value
+     * @param value the value to write
+     * @param numBits the number of bits to write (1 - 32)
+     * @return true if the value was written, false if there is not enough space left in the buffer
+     */
+    bool write(uint32_t value, uint8_t numBits);
+
+    /**
+     * Writes a single bit
+     * @param value the bit to write
+     * @return true if the bit was written, false if there is not enough space left in the buffer
+     */
+    bool writeBool(bool value) {return write(value, 1);};
+
+    /**
+     * Writes a signed value using zigzag encoding, so values close to zero need few bits
+     * @param value the value to write. It has to fit into numBits after zigzag encoding, i.e. -2^(numBits-1) <= value < 2^(numBits-1)
+     * @param numBits the number of bits to write (1 - 32)
+     * @return true if the value was written, false if there is not enough space left in the buffer
+     */
+    bool writeSigned(int32_t value, uint8_t numBits) {return write(zigzagEncode(value), numBits);};
+
+    /**
+     * Writes an unsigned value as varint: groups of 7 bits, each followed by a bit that indicates whether more groups follow
+     * @param value the value to write
+     * @return true if the value was written, false if there is not enough space left in the buffer
+     */
+    bool writeVarint(uint32_t value);
+
+    /**
+     * Writes a signed value as zigzag encoded varint
+     * @param value the value to write
+     * @return true if the value was written, false if there is not enough space left in the buffer
+     */
+    bool writeSignedVarint(int32_t value) {return writeVarint(zigzagEncode(value));};
+
+    /**
+     * Writes all buffered bits to the buffer. The last byte is padded with zeros. Call this method after the last write
+     * @return the number of bytes used in the buffer
+     */
+    size_t flush();
+
+    /**
+     * Gets the number of bits written so far
+     * @return the number of bits written
+     */
+    size_t bitsWritten() {return bytePos * 8 + numBuffered;};
+
+    /**
+     * Gets whether a write failed because the buffer was full
+     * @return true if data was dropped, false otherwise
+     */
+    bool hasOverflowed() {return overflow;};
+
+    /**
+     * Maps signed to unsigned values: 0, -1, 1, -2, 2, ... become 0, 1, 2, 3, 4, ...
+     * @param value the signed value
+     * @return the zigzag encoded value
+     */
+    static uint32_t zigzagEncode(int32_t value) {return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);};
+private:
+    uint8_t * buffer;
+    size_t size;
+    size_t bytePos;
+    uint64_t bits;
+    uint8_t numBuffered;
+    bool overflow;
+};
+
+/**
+ * Reads fields of arbitrary bit width from a buffer written by BitWriter
+ */
+class BitReader
+{
+public:
+    /**
+     * Constructor
+     * @param buffer the buffer to read from
+     * @param size the size of the buffer in bytes
+     */
+    BitReader(const uint8_t * buffer, size_t size);
+
+    /**
+     * Reads an unsigned value
+     * @param numBits the number of bits to read (1 - 32)
+     * @return the value, or 0 if there are not enough bits left in the buffer
+     */
+    uint32_t read(uint8_t numBits);
+
+    /**
+     * Reads a single bit
+     * @return the bit, or false if the end of the buffer has been reached
+     */
+    bool readBool() {return read(1);};
+
+    /**
+     * Reads a zigzag encoded signed value
+     * @param numBits the number of bits to read (1 - 32)
+     * @return the value, or 0 if there are not enough bits left in the buffer
+     */
+    int32_t readSigned(uint8_t numBits) {return zigzagDecode(read(numBits));};
+
+    /**
+     * Reads a varint encoded value
+     * @return the value, or 0 if there are not enough bits left in the buffer
+     */
+    uint32_t readVarint();
+
+    /**
+     * Reads a zigzag encoded signed varint
+     * @return the value, or 0 if there are not enough bits left in the buffer
+     */
+    int32_t readSignedVarint() {return zigzagDecode(readVarint());};
+
+    /**
+     * Gets the number of bits that have not been read yet
+     * @return the number of remaining bits
+     */
+    size_t bitsRemaining() {return (size - bytePos) * 8 + numBuffered;};
+
+    /**
+     * Gets whether a read failed because the end of the buffer was reached
+     * @return true if a read went past the end of the buffer, false otherwise
+     */
+    bool hasOverflowed() {return overflow;};
+
+    /**
+     * Reverts the zigzag encoding
+     * @param value the zigzag encoded value
+     * @return the signed value
+     */
+    static int32_t zigzagDecode(uint32_t value) {return (int32_t)((value >> 1) ^ (0 - (value & 1)));};
+private:
+    const uint8_t * buffer;
+    size_t size;
+    size_t bytePos;
+    uint64_t bits;
+    uint8_t numBuffered;
+    bool overflow;
+
+    void refill();
+};
+
+#endif
@@ -0,0 +1,302 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_BITSET_H_
+#define _MBED_EXT_BITSET_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+template<size_t N>
+/**
+ * A fixed size set of N bits. All operations work on whole 32-bit words; counting and searching
+ * use the CLZ / CTZ / popcount builtins, which map to single instructions where the core has them.
+ *
+ * @code
+ * Bitset<128> present;
+ * present.set(0x68);
+ * for (size_t address : present) {
+ *     // called for every set bit in ascending order
+ * }
+ * @endcode
+ */
+class Bitset {
+    static_assert(N > 0, "a bitset needs at least one bit");
+
+    static constexpr size_t NUM_WORDS = (N + 31) / 32;
+    static constexpr uint32_t LAST_WORD_MASK = (N % 32) == 0 ? 0xFFFFFFFF : (((uint32_t)1 << (N % 32)) - 1);
+public:
+    /**
+     * Iterates over the positions of all set bits in ascending order
+     */
+    class iterator {
+    public:
+        constexpr iterator(const Bitset * set, size_t pos) : set(set), pos(pos) {}
+        constexpr size_t operator*() const {return pos;}
+        constexpr iterator & operator++() {pos = set->findNext(pos); return *this;}
+        constexpr bool operator!=(const iterator & other) const {return pos != other.pos;}
+        constexpr bool operator==(const iterator & other) const {return pos == other.pos;}
+    private:
+        const Bitset * set;
+        size_t pos;
+    };
+
+    /**
+     * Constructor. All bits are cleared
+     */
+    constexpr Bitset() : words() {}
+
+    /**
+     * Gets the number of bits in the set
+     * @return N
+     */
+    constexpr size_t size() const {return N;}
+
+    /**
+     * Gets the value of a bit
+     * @param pos the position of the bit
+     * @return true if the bit is set
+     */
+    constexpr bool test(size_t pos) const {
+        return (words[pos / 32] >> (pos % 32)) & 0x01;
+    }
+
+    /**
+     * Shortcut for test()
+     * @param pos the position of the bit
+     * @return true if the bit is set
+     */
+    constexpr bool operator[](size_t pos) const {return test(pos);}
+
+    /**
+     * Sets a bit to 1
+     * @param pos the position of the bit
+     */
+    constexpr void set(size_t pos) {
+        words[pos / 32] |= (uint32_t)1 << (pos % 32);
+    }
+
+    /**
+     * Sets a bit to the given value
+     * @param pos the position of the bit
+     * @param value the new value
+     */
+    constexpr void set(size_t pos, bool value) {
+        if (value) {
+            set(pos);
+        } else {
+            reset(pos);
+        }
+    }
+
+    /**
+     * Sets a bit to 0
+     * @param pos the position of the bit
+     */
+    constexpr void reset(size_t pos) {
+        words[pos / 32] &= ~((uint32_t)1 << (pos % 32));
+    }
+
+    /**
+     * Inverts a bit
+     * @param pos the position of the bit
+     */
+    constexpr void flip(size_t pos) {
+        words[pos / 32] ^= (uint32_t)1 << (pos % 32);
+    }
+
+    /**
+     * Sets all bits to 1
+     */
+    constexpr void setAll() {
+        for (size_t i = 0; i < NUM_WORDS; i++) {
+            words[i] = 0xFFFFFFFF;
+        }
+        words[NUM_WORDS - 1] = LAST_WORD_MASK;
+    }
+
+    /**
+     * Sets all bits to 0
+     */
+    constexpr void resetAll() {
+        for (size_t i = 0; i < NUM_WORDS; i++) {
+            words[i] = 0;
+        }
+    }
+
+    /**
+     * Gets the number of set bits
+     * @return the number of bits that are 1
+     */
+    constexpr size_t count() const {
+        size_t n = 0;
+        for (size_t i = 0; i < NUM_WORDS; i++) {
+            n += __builtin_popcount(words[i]);
+        }
+        return n;
+    }
+
+    /**
+     * Gets whether at least one bit is set
+     * @return true if any bit is 1
+     */
+    constexpr bool any() const {
+        uint32_t combined = 0;
+        for (size_t i = 0; i < NUM_WORDS; i++) {
+            combined |= words[i];
+        }
+        return combined != 0;
+    }
+
+    /**
+     * Gets whether no bit is set
+     * @return true if all bits are 0
+     */
+    constexpr bool none() const {return !any();}
+
+    /**
+     * Gets whether all bits are set
+     * @return true if all bits are 1
+     */
+    constexpr bool all() const {return count() == N;}
+
+    /**
+     * Gets the position of the lowest set bit
+     * @return the position of the first set bit, or N if no bit is set
+     */
+    constexpr size_t findFirst() const {
+        return findFrom(0);
+    }
+
+    /**
+     * Gets the position of the next set bit after a given position
+     * @param pos the position to start after
+     * @return the position of the next set bit, or N if there is none
+     */
+    constexpr size_t findNext(size_t pos) const {
+        return pos + 1 >= N ? N : findFrom(pos + 1);
+    }
+
+    /**
+     * Gets the position of the highest set bit
+     * @return the position of the last set bit, or N if no bit is set
+     */
+    constexpr size_t findLast() const {
+        for (size_t i = NUM_WORDS; i-- > 0;) {
+            if (words[i] != 0) {
+                return i * 32 + 31 - __builtin_clz(words[i]);
+            }
+        }
+        return N;
+    }
+
+    /**
+     * Gets an iterator pointing to the first set bit
+     * @return the iterator
+     */
+    constexpr iterator begin() const {return iterator(this, findFirst());}
+
+    /**
+     * Gets the iterator that marks the end of the iteration
+     * @return the iterator
+     */
+    constexpr iterator end() const {return iterator(this, N);}
+
+    /**
+     * Gets a whole 32-bit word of the set
+     * @param index the index of the word, word 0 contains bits 0 to 31
+     * @return the word
+     */
+    constexpr uint32_t word(size_t index) const {return words[index];}
+
+    /**
+     * Gets the number of 32-bit words used to store the bits
+     * @return the number of words
+     */
+    constexpr size_t numWords() const {return NUM_WORDS;}
+
+    constexpr Bitset & operator&=(const Bitset & other) {
+        for (size_t i = 0; i < NUM_WORDS; i++) {
+            words[i] &= other.words[i];
+        }
+        return *this;
+    }
+
+    constexpr Bitset & operator|=(const Bitset & other) {
+        for (size_t i = 0; i < NUM_WORDS; i++) {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    constexpr Bitset & operator^=(const Bitset & other) {
+        for (size_t i = 0; i < NUM_WORDS; i++) {
+            words[i] ^= other.words[i];
+        }
+        return *this;
+    }
+
+    constexpr Bitset operator~() const {
+        Bitset result;
+        for (size_t i = 0; i < NUM_WORDS; i++) {
+            result.words[i] = ~words[i];
+        }
+        result.words[NUM_WORDS - 1] &= LAST_WORD_MASK;
+        return result;
+    }
+
+    constexpr Bitset operator&(const Bitset & other) const {Bitset result(*this); result &= other; return result;}
+    constexpr Bitset operator|(const Bitset & other) const {Bitset result(*this); result |= other; return result;}
+    constexpr Bitset operator^(const Bitset & other) const {Bitset result(*this); result ^= other; return result;}
+
+    constexpr bool operator==(const Bitset & other) const {
+        uint32_t diff = 0;
+        for (size_t i = 0; i < NUM_WORDS; i++) {
+            diff |= words[i] ^ other.words[i];
+        }
+        return diff == 0;
+    }
+
+    constexpr bool operator!=(const Bitset & other) const {return !(*this == other);}
+private:
+    uint32_t words[NUM_WORDS];
+
+    constexpr size_t findFrom(size_t pos) const {
+        size_t i = pos / 32;
+        // ignore the bits below pos in the first word
+        uint32_t w = words[i] & (0xFFFFFFFF << (pos % 32));
+
+        while (true) {
+            if (w != 0) {
+                return i * 32 + __builtin_ctz(w);
+            }
+            if (++i >= NUM_WORDS) {
+                return N;
+            }
+            w = words[i];
+        }
+    }
+};
+
+#endif
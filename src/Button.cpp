@@ -1,6 +1,8 @@
 #include <Button.h>
 
-Button::Button(PinName pin, button_edge_order_t edgeOrder, PinMode mode) : buttonInput(pin, mode) {
+Button::Button(PinName pin, button_edge_order_t edgeOrder, PinMode mode)
+    : buttonInput(pin, mode), buttonPressed(false), previousClick(false), longClickMs(DEFAULT_PRESS_THRESHHOLD), doubleClickMs(DEFAULT_DOUBLE_CLICK_DELAY),
+      eventQueue(nullptr), queueIndex(0) {
     if (edgeOrder == RISE_TO_FALL) {
         // click starts with rising edge, ends with falling edge
         buttonInput.rise(callback(this, &Button::onButtonDown));
@@ -22,25 +24,26 @@ void Button::onButtonDown() {
 
 
 void Button::onButtonRelease() {
-    if (pressTimer.read_ms() >= DEFAULT_PRESS_THRESHHOLD){
+    if (pressTimer.read_ms() >= longClickMs){
         // long press
-        onLongClickHandler();
+        emit(BUTTON_LONG_CLICK);
     }else{
         // click
 
         if (previousClick) {
             // previos click withing double click time span -> its a double click
-            onDoubleClickHandler();
+            emit(BUTTON_DOUBLE_CLICK);
 
             // stop timeout
             doubleClickTimeout.detach();
             previousClick = false;
+        }else if (!onDoubleClickHandler || doubleClickMs == 0) {
+            // nobody waits for double clicks, no need to delay the click
+            emit(BUTTON_CLICK);
         }else{
-            //onClickHandler();
-
             // start double click timer
             previousClick = true;
-            doubleClickTimeout.attach_us(callback(this, &Button::checkDoubleClick), DEFAULT_DOUBLE_CLICK_DELAY * 1000);
+            doubleClickTimeout.attach_us(callback(this, &Button::checkDoubleClick), doubleClickMs * 1000);
         }
         
     }
@@ -53,7 +56,38 @@ void Button::onButtonRelease() {
 
 void Button::checkDoubleClick() {
     // no second click in timeout, it was a single click
-    onClickHandler(); 
+    emit(BUTTON_CLICK);
 
     previousClick = false;
 }
+
+void Button::emit(uint8_t type) {
+    if (eventQueue) {
+        // only record the event, the handler is called by the queue
+        eventQueue->post(queueIndex, type);
+    }else{
+        handleEvent(type);
+    }
+}
+
+bool Button::handleEvent(uint8_t type) {
+    switch (type) {
+        case BUTTON_CLICK:
+            if (onClickHandler) {
+                onClickHandler();
+            }
+            return true;
+        case BUTTON_DOUBLE_CLICK:
+            if (onDoubleClickHandler) {
+                onDoubleClickHandler();
+            }
+            return true;
+        case BUTTON_LONG_CLICK:
+            if (onLongClickHandler) {
+                onLongClickHandler();
+            }
+            return true;
+        default:
+            return false;
+    }
+}
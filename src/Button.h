@@ -27,6 +27,7 @@ SOFTWARE.
 
 #include <mbed.h>
 #include <DebouncedIn.h>
+#include <ButtonEventQueue.h>
 
 #define DEFAULT_PRESS_THRESHHOLD 500
 #define DEFAULT_DOUBLE_CLICK_DELAY 250
@@ -87,21 +88,51 @@ public:
      */
     void onDoubleClick(Callback<void()> doubleClickHandler) {onDoubleClickHandler = doubleClickHandler;};
 
+    /**
+     * Sets the timing of the click detection. Without a double click handler, clicks are reported
+     * immediately on release instead of after the double click delay. Longer times are limited to 65535 ms
+     * @param longClickMs the time in ms the button has to be pressed for a long click (500ms by default)
+     * @param doubleClickMs the time in ms to wait for the second click of a double click (250ms by default)
+     */
+    void setTiming(uint32_t longClickMs, uint32_t doubleClickMs) {
+        this->longClickMs = longClickMs > 0xFFFF ? 0xFFFF : longClickMs;
+        this->doubleClickMs = doubleClickMs > 0xFFFF ? 0xFFFF : doubleClickMs;
+    };
+
     /**
      * Returns whether the button is currently pressed.
      * @return true when the button is pressed, false otherwise
      */
     bool isPressed() {return buttonPressed;};
+
+    /**
+     * Posts the events to a queue instead of calling the handlers in the ISR. Usually called by ButtonEventQueue::attach
+     * @param queue the queue, nullptr to call the handlers in the ISR again
+     * @param index the index of the button in the queue
+     */
+    void setEventQueue(ButtonEventQueue * queue, uint8_t index) {eventQueue = queue; queueIndex = index;};
+
+    /**
+     * Calls the handler of an event
+     * @param type the type of the event (BUTTON_CLICK, BUTTON_DOUBLE_CLICK or BUTTON_LONG_CLICK)
+     * @return true if the type is an event of a button, false if it is not handled by a button
+     */
+    bool handleEvent(uint8_t type);
 private:
     DebouncedIn buttonInput;
     LowPowerTimer pressTimer;
     LowPowerTimeout doubleClickTimeout;
     bool buttonPressed;
     bool previousClick;
+    uint16_t longClickMs;
+    uint16_t doubleClickMs;
     Callback<void()> onClickHandler;
     Callback<void()> onDoubleClickHandler;
     Callback<void()> onLongClickHandler;
+    ButtonEventQueue * eventQueue;
+    uint8_t queueIndex;
 
+    void emit(uint8_t type);
     void checkDoubleClick();
     void onButtonDown();
     void onButtonRelease();
@@ -0,0 +1,120 @@
+#include <ButtonEventQueue.h>
+#include <Button.h>
+
+ButtonEventQueue::ButtonEventQueue(button_event_t * storage, size_t capacity) : events(storage, capacity), coalesceMask(0), numButtons(0) {
+    memset(pending, 0, sizeof(pending));
+    resetStats();
+}
+
+int ButtonEventQueue::attach(Button * button, bool coalesce) {
+    if (numButtons >= BUTTON_EVENT_QUEUE_MAX_SOURCES) {
+        return -1;
+    }
+
+    uint8_t index = numButtons++;
+    buttons[index] = button;
+    setCoalescing(index, coalesce);
+    button->setEventQueue(this, index);
+    return index;
+}
+
+void ButtonEventQueue::setCoalescing(uint8_t button, bool coalesce) {
+    if (button >= BUTTON_EVENT_QUEUE_MAX_SOURCES) {
+        return;
+    }
+
+    core_util_critical_section_enter();
+    if (coalesce) {
+        coalesceMask |= 1UL << button;
+    }else{
+        coalesceMask &= ~(1UL << button);
+    }
+    core_util_critical_section_exit();
+}
+
+bool ButtonEventQueue::post(uint8_t button, uint8_t type) {
+    if (type >= NUM_BUTTON_EVENT_TYPES) {
+        return false;
+    }
+
+    bool coalesce = button < BUTTON_EVENT_QUEUE_MAX_SOURCES && (coalesceMask & (1UL << button));
+
+    if (coalesce && pending[button][type]) {
+        // an event of this type is already waiting, only count it
+        if (pending[button][type] < 0xFF) {
+            pending[button][type]++;
+        }
+        stats.coalesced++;
+        return true;
+    }
+
+    button_event_t event;
+    event.timestamp = us_ticker_read();
+    event.button = button;
+    event.type = type;
+    event.count = 1;
+
+    if (!events.push(event)) {
+        stats.dropped++;
+        return false;
+    }
+
+    if (coalesce) {
+        pending[button][type] = 1;
+    }
+    return true;
+}
+
+bool ButtonEventQueue::read(button_event_t * event) {
+    if (!events.pop(event)) {
+        return false;
+    }
+
+    if (event->button < BUTTON_EVENT_QUEUE_MAX_SOURCES && pending[event->button][event->type]) {
+        // take the events that were coalesced until now, later ones are queued again
+        core_util_critical_section_enter();
+        event->count = pending[event->button][event->type];
+        pending[event->button][event->type] = 0;
+        core_util_critical_section_exit();
+    }
+    return true;
+}
+
+size_t ButtonEventQueue::dispatch(size_t max) {
+    size_t n = 0;
+    button_event_t event;
+
+    while (n < max && read(&event)) {
+        uint32_t latency = us_ticker_read() - event.timestamp;
+
+        core_util_critical_section_enter();
+        stats.dispatched++;
+        stats.totalLatencyUs += latency;
+        if (latency > stats.maxLatencyUs) {
+            stats.maxLatencyUs = latency;
+        }
+        core_util_critical_section_exit();
+
+        // coalesced events call the handler once
+        bool handled = event.button < numButtons && buttons[event.button]->handleEvent(event.type);
+        if (!handled && eventHandler) {
+            eventHandler(event);
+        }
+        n++;
+    }
+
+    return n;
+}
+
+button_dispatch_stats_t ButtonEventQueue::getStats() {
+    core_util_critical_section_enter();
+    button_dispatch_stats_t copy = stats;
+    core_util_critical_section_exit();
+    return copy;
+}
+
+void ButtonEventQueue::resetStats() {
+    core_util_critical_section_enter();
+    memset(&stats, 0, sizeof(stats));
+    core_util_critical_section_exit();
+}
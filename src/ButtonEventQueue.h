@@ -0,0 +1,225 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_BUTTON_EVENT_QUEUE_H_
+#define _MBED_EXT_BUTTON_EVENT_QUEUE_H_
+
+#include <mbed.h>
+#include <RingBuffer.h>
+
+#ifndef BUTTON_EVENT_QUEUE_MAX_SOURCES
+#define BUTTON_EVENT_QUEUE_MAX_SOURCES 16
+#endif
+
+#if BUTTON_EVENT_QUEUE_MAX_SOURCES > 32
+#error "BUTTON_EVENT_QUEUE_MAX_SOURCES must not be larger than 32"
+#endif
+
+class Button;
+
+/**
+ * Types of button events
+ */
+typedef enum button_event_type {
+    BUTTON_NONE = 0,
+    /* The button was pressed (debounced) */
+    BUTTON_DOWN,
+    /* The button was released (debounced) */
+    BUTTON_UP,
+    /* The button was clicked once, generated after the double click delay */
+    BUTTON_CLICK,
+    /* The button was clicked twice within the double click delay */
+    BUTTON_DOUBLE_CLICK,
+    /* The button was released after it was pressed for the press threshold */
+    BUTTON_LONG_CLICK,
+    /* The button was clicked three or more times, count is the number of clicks (ButtonManager) */
+    BUTTON_MULTI_CLICK,
+    /* The button is held for the press threshold, count is 1 + the number of clicks before (ButtonManager) */
+    BUTTON_HOLD,
+    /* Auto repeat while the button is held (ButtonManager) */
+    BUTTON_REPEAT,
+    /* All buttons of a chord are pressed, button is the index of the chord (ButtonManager) */
+    BUTTON_CHORD,
+    NUM_BUTTON_EVENT_TYPES
+}button_event_type_t;
+
+/**
+ * An event of a button
+ */
+typedef struct button_event {
+    /* Time of the (first) event in us (us_ticker_read()) */
+    uint32_t timestamp;
+    /* Index of the button */
+    uint8_t button;
+    /* Type of the event, see button_event_type_t */
+    uint8_t type;
+    /* Number of events that were coalesced into this one, or the number of clicks of BUTTON_MULTI_CLICK / BUTTON_HOLD */
+    uint8_t count;
+}button_event_t;
+
+/**
+ * Dispatch statistics of a ButtonEventQueue
+ */
+typedef struct button_dispatch_stats {
+    /* Dispatched events */
+    uint32_t dispatched;
+    /* Events that were merged into a pending event of the same button and type */
+    uint32_t coalesced;
+    /* Events that were dropped because the queue was full */
+    uint32_t dropped;
+    /* Longest time in us between an event and its dispatch */
+    uint32_t maxLatencyUs;
+    /* Sum of the dispatch latencies in us, divide by dispatched for the average */
+    uint64_t totalLatencyUs;
+}button_dispatch_stats_t;
+
+/**
+ * Moves the handling of button events out of interrupt context. Buttons post their events from the ISR,
+ * which only records the type and a timestamp, and dispatch() calls the handlers from the main loop or a
+ * thread. The time between an event and its dispatch is measured.
+ *
+ * With coalescing enabled for a button, an event is not queued again while the same type of the same
+ * button is still waiting, instead its count is incremented and the handler is only called once. A slow
+ * consumer then does the work once instead of finding a full queue.
+ *
+ * @code
+ * StaticButtonEventQueue<16> buttonEvents;
+ * Button button(USER_BUTTON, FALL_TO_RISE);
+ * button.onClick(&onClick);
+ * buttonEvents.attach(&button);
+ *
+ * while (1) {
+ *     // onClick is called here, not in the ISR
+ *     buttonEvents.dispatch();
+ *
+ *     // only sleep if no event was posted since dispatch() returned, the pending interrupt still wakes up
+ *     core_util_critical_section_enter();
+ *     if (buttonEvents.size() == 0) {
+ *         sleep();
+ *     }
+ *     core_util_critical_section_exit();
+ * }
+ * @endcode
+ */
+class ButtonEventQueue
+{
+public:
+    /**
+     * Constructor
+     * @param storage the storage of the events
+     * @param capacity the number of events of the storage, must be a power of two
+     */
+    ButtonEventQueue(button_event_t * storage, size_t capacity);
+
+    /**
+     * Posts the events of a button to this queue. The handlers registered at the button are then called by dispatch()
+     * @param button the button
+     * @param coalesce true to coalesce events of the same type while one is waiting
+     * @return the index of the button in this queue, or -1 if the maximum number of buttons is reached
+     */
+    int attach(Button * button, bool coalesce = false);
+
+    /**
+     * Enables or disables coalescing for a button
+     * @param button the index of the button
+     * @param coalesce true to coalesce events of the same type while one is waiting
+     */
+    void setCoalescing(uint8_t button, bool coalesce);
+
+    /**
+     * Registers a handler for events of buttons that are not attached, e.g. posted manually or by a KeypadMatrix,
+     * and for event types that an attached Button doesn't handle
+     * @param handler the function that is called by dispatch() with the event
+     */
+    void onEvent(Callback<void(const button_event_t &)> handler) {eventHandler = handler;};
+
+    /**
+     * Posts an event. Called from the ISRs of the attached buttons, all producers need the same interrupt priority
+     * @param button the index of the button
+     * @param type the type of the event, see button_event_type_t
+     * @return true if the event was queued or coalesced, false if it was dropped or the type is invalid
+     */
+    bool post(uint8_t button, uint8_t type);
+
+    /**
+     * Removes the oldest event without calling a handler
+     * @param event pointer to the location the event is copied to
+     * @return true if an event was read, false if the queue is empty
+     */
+    bool read(button_event_t * event);
+
+    /**
+     * Calls the handlers of the waiting events. Note: call this method in the main loop or a thread
+     * @param max the maximum number of events to dispatch
+     * @return the number of dispatched events
+     */
+    size_t dispatch(size_t max = SIZE_MAX);
+
+    /**
+     * Gets the number of attached buttons. Their indices are 0 to getNumButtons() - 1
+     * @return the number of attached buttons
+     */
+    uint8_t getNumButtons() {return numButtons;};
+
+    /**
+     * Gets the number of waiting events
+     * @return the number of events in the queue
+     */
+    size_t size() {return events.size();};
+
+    /**
+     * Gets the dispatch statistics
+     * @return a copy of the statistics
+     */
+    button_dispatch_stats_t getStats();
+
+    /**
+     * Resets the dispatch statistics
+     */
+    void resetStats();
+private:
+    RingBuffer<button_event_t> events;
+    Button * buttons[BUTTON_EVENT_QUEUE_MAX_SOURCES];
+    /* number of coalesced events per button and type while one is queued, 0 if none is queued */
+    uint8_t pending[BUTTON_EVENT_QUEUE_MAX_SOURCES][NUM_BUTTON_EVENT_TYPES];
+    uint32_t coalesceMask;
+    uint8_t numButtons;
+    Callback<void(const button_event_t &)> eventHandler;
+    button_dispatch_stats_t stats;
+};
+
+template<size_t N>
+/**
+ * ButtonEventQueue with a static storage of N events, N must be a power of two
+ */
+class StaticButtonEventQueue : public ButtonEventQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "the capacity must be a power of two");
+public:
+    StaticButtonEventQueue() : ButtonEventQueue(storage, N) {};
+private:
+    button_event_t storage[N];
+};
+
+#endif
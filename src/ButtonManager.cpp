@@ -0,0 +1,134 @@
+#include <ButtonManager.h>
+
+/* States of the gesture state machine */
+enum {
+    STATE_IDLE = 0,
+    STATE_PRESSED,
+    STATE_RELEASED,
+    STATE_HELD,
+    STATE_REPEATING,
+    STATE_CONSUMED,
+    NUM_STATES
+};
+
+/* Actions on the click counter */
+enum {
+    ACTION_NONE = 0,
+    /* first press of a gesture */
+    ACTION_FIRST_CLICK,
+    /* another press within the multi click time */
+    ACTION_NEXT_CLICK,
+    /* release of a click, reported immediately when no more clicks are expected */
+    ACTION_RELEASE_CLICK,
+    /* no further click, report the clicks */
+    ACTION_REPORT_CLICKS,
+    /* long press, reported with the number of clicks */
+    ACTION_HOLD
+};
+
+typedef struct button_transition {
+    uint8_t next;
+    uint8_t event;
+    uint8_t action;
+}button_transition_t;
+
+static const button_transition_t transitions[NUM_STATES][ButtonFsm::NUM_INPUTS] = {
+    // idle
+    {{STATE_IDLE, BUTTON_NONE, ACTION_NONE}, {STATE_PRESSED, BUTTON_NONE, ACTION_FIRST_CLICK},
+     {STATE_IDLE, BUTTON_NONE, ACTION_NONE}, {STATE_IDLE, BUTTON_NONE, ACTION_NONE}},
+    // pressed: released in time -> wait for the next click, held -> long press
+    {{STATE_PRESSED, BUTTON_NONE, ACTION_NONE}, {STATE_PRESSED, BUTTON_NONE, ACTION_NONE},
+     {STATE_RELEASED, BUTTON_NONE, ACTION_RELEASE_CLICK}, {STATE_HELD, BUTTON_HOLD, ACTION_HOLD}},
+    // released: pressed again -> next click, no press in time -> report the clicks
+    {{STATE_RELEASED, BUTTON_NONE, ACTION_NONE}, {STATE_PRESSED, BUTTON_NONE, ACTION_NEXT_CLICK},
+     {STATE_RELEASED, BUTTON_NONE, ACTION_NONE}, {STATE_IDLE, BUTTON_NONE, ACTION_REPORT_CLICKS}},
+    // held: repeat delay -> first repeat
+    {{STATE_HELD, BUTTON_NONE, ACTION_NONE}, {STATE_HELD, BUTTON_NONE, ACTION_NONE},
+     {STATE_IDLE, BUTTON_LONG_CLICK, ACTION_NONE}, {STATE_REPEATING, BUTTON_REPEAT, ACTION_NONE}},
+    // repeating: repeat interval -> next repeat
+    {{STATE_REPEATING, BUTTON_NONE, ACTION_NONE}, {STATE_REPEATING, BUTTON_NONE, ACTION_NONE},
+     {STATE_IDLE, BUTTON_LONG_CLICK, ACTION_NONE}, {STATE_REPEATING, BUTTON_REPEAT, ACTION_NONE}},
+    // consumed by a chord: wait for the release
+    {{STATE_CONSUMED, BUTTON_NONE, ACTION_NONE}, {STATE_CONSUMED, BUTTON_NONE, ACTION_NONE},
+     {STATE_IDLE, BUTTON_NONE, ACTION_NONE}, {STATE_CONSUMED, BUTTON_NONE, ACTION_NONE}}
+};
+
+#define EVENT_BIT(type) (1UL << (type))
+
+static uint16_t getTimeout(uint8_t state, const button_gesture_config_t * config, uint32_t eventMask) {
+    switch (state) {
+        case STATE_PRESSED:
+            // don't count the time of a press if nobody waits for long presses
+            return (eventMask & (EVENT_BIT(BUTTON_HOLD) | EVENT_BIT(BUTTON_LONG_CLICK) | EVENT_BIT(BUTTON_REPEAT))) ? config->longPressMs : 0;
+        case STATE_RELEASED:
+            return config->multiClickMs;
+        case STATE_HELD:
+            return config->repeatIntervalMs ? config->repeatDelayMs : 0;
+        case STATE_REPEATING:
+            return config->repeatIntervalMs;
+        default:
+            return 0;
+    }
+}
+
+static uint8_t getClickEvent(uint8_t clicks) {
+    return clicks == 1 ? BUTTON_CLICK : clicks == 2 ? BUTTON_DOUBLE_CLICK : BUTTON_MULTI_CLICK;
+}
+
+uint8_t ButtonFsm::update(button_state_t * button, uint8_t input, const button_gesture_config_t * config, uint32_t eventMask, uint16_t stepMs, uint8_t * count) {
+    if (input == INPUT_NONE) {
+        uint16_t timeout = getTimeout(button->fsm, config, eventMask);
+
+        if (timeout == 0) {
+            // nothing to wait for
+            return BUTTON_NONE;
+        }
+
+        uint32_t elapsed = button->elapsedMs + stepMs;
+        button->elapsedMs = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+        if (button->elapsedMs < timeout) {
+            return BUTTON_NONE;
+        }
+        input = INPUT_TIMEOUT;
+    }
+
+    const button_transition_t * transition = &transitions[button->fsm][input];
+    uint8_t next = transition->next;
+    uint8_t event = transition->event;
+
+    switch (transition->action) {
+        case ACTION_FIRST_CLICK:
+            button->clicks = 1;
+            break;
+        case ACTION_NEXT_CLICK:
+            if (button->clicks < 0xFF) {
+                button->clicks++;
+            }
+            break;
+        case ACTION_RELEASE_CLICK:
+            if (button->clicks >= config->maxClicks || config->multiClickMs == 0 || !(eventMask & (EVENT_BIT(BUTTON_DOUBLE_CLICK) | EVENT_BIT(BUTTON_MULTI_CLICK)))) {
+                // no more clicks expected or nobody waits for them, don't wait
+                next = STATE_IDLE;
+                event = getClickEvent(button->clicks);
+                *count = button->clicks;
+            }
+            break;
+        case ACTION_REPORT_CLICKS:
+            event = getClickEvent(button->clicks);
+            *count = button->clicks;
+            break;
+        case ACTION_HOLD:
+            *count = button->clicks;
+            break;
+    }
+
+    button->fsm = next;
+    button->elapsedMs = 0;
+    return event;
+}
+
+void ButtonFsm::consume(button_state_t * button) {
+    button->fsm = STATE_CONSUMED;
+    button->elapsedMs = 0;
+    button->clicks = 0;
+}
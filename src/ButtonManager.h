@@ -0,0 +1,383 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_BUTTON_MANAGER_H_
+#define _MBED_EXT_BUTTON_MANAGER_H_
+
+#include <mbed.h>
+#include <Button.h>
+#include <RingBuffer.h>
+
+#define DEFAULT_BUTTON_TICK_US 5000
+#define DEFAULT_BUTTON_DEBOUNCE_SAMPLES 3
+
+#ifndef BUTTON_MAX_CHORDS
+#define BUTTON_MAX_CHORDS 4
+#endif
+
+/**
+ * State of a button
+ */
+typedef struct button_state {
+    /* State of the gesture state machine */
+    uint8_t fsm;
+    /* Debounced level in bit 7, active low flag in bit 6, debounce integrator in the low bits */
+    uint8_t debounce;
+    /* Time in ms spent in the current state, saturating */
+    uint16_t elapsedMs;
+    /* Number of clicks of the current multi click */
+    uint8_t clicks;
+}button_state_t;
+
+/**
+ * Gesture configuration of a button. A timeout of 0 disables the gesture, and a disabled gesture
+ * costs nothing: the state machine doesn't wait for it and no time is counted. The same applies to
+ * gestures whose events are not enabled in the event mask, e.g. clicks are reported immediately on
+ * release when neither BUTTON_DOUBLE_CLICK nor BUTTON_MULTI_CLICK are enabled.
+ */
+typedef struct button_gesture_config {
+    /* Time in ms a button has to be held for a long press (BUTTON_HOLD, BUTTON_LONG_CLICK), 0 disables long presses */
+    uint16_t longPressMs;
+    /* Time in ms to wait for the next click of a multi click */
+    uint16_t multiClickMs;
+    /* Maximum number of clicks of a multi click, with 1 every click is reported immediately on release */
+    uint8_t maxClicks;
+    /* Time in ms from BUTTON_HOLD to the first BUTTON_REPEAT, 0 disables auto repeat */
+    uint16_t repeatDelayMs;
+    /* Time in ms between BUTTON_REPEAT events */
+    uint16_t repeatIntervalMs;
+}button_gesture_config_t;
+
+/**
+ * The gesture state machine shared by all buttons of a ButtonManager. The transitions are stored in a
+ * table indexed by state and input, each entry contains the next state, the event to generate and an
+ * action for the click counter.
+ */
+class ButtonFsm
+{
+public:
+    /**
+     * Inputs of the state machine
+     */
+    enum {
+        INPUT_NONE = 0,
+        INPUT_PRESS,
+        INPUT_RELEASE,
+        INPUT_TIMEOUT,
+        NUM_INPUTS
+    };
+
+    /**
+     * Advances the state machine of a button by one tick
+     * @param button the state of the button
+     * @param input the debounced edge of this tick, INPUT_NONE if there was none
+     * @param config the gesture configuration of the button
+     * @param eventMask the subscribed events, gestures without subscribed events are skipped
+     * @param stepMs the time since the last tick in ms
+     * @param count set to the number of clicks for click events
+     * @return the generated event, BUTTON_NONE if there is none
+     */
+    static uint8_t update(button_state_t * button, uint8_t input, const button_gesture_config_t * config, uint32_t eventMask, uint16_t stepMs, uint8_t * count);
+
+    /**
+     * Makes a button ignore the rest of its current press, e.g. because it was part of a chord
+     * @param button the state of the button
+     */
+    static void consume(button_state_t * button);
+};
+
+template<size_t MaxButtons = 16, size_t QueueSize = 32>
+/**
+ * Runs the gesture recognition of many buttons from a single Ticker. Every tick all buttons are sampled and
+ * debounced with an integrator, then their state machines (ButtonFsm) are advanced. Generated events are
+ * put into a single queue that is read in the main loop, so no handler runs in an ISR. A button needs a
+ * gpio_t, a pointer to its gesture configuration and 6 bytes of state, there are no timers or interrupts per button.
+ *
+ * Recognized gestures are clicks, double clicks, N clicks (BUTTON_MULTI_CLICK with the number of clicks in
+ * count), long presses with auto repeat and chords of several buttons that are pressed together.
+ *
+ * @code
+ * static const button_gesture_config_t arrowKeys = {500, 0, 1, 400, 100};
+ * ButtonManager<> buttons;
+ * int ok = buttons.add(BUTTON_OK, FALL_TO_RISE, PullUp);
+ * int up = buttons.add(BUTTON_ARROW_UP, FALL_TO_RISE, PullUp, &arrowKeys);
+ * buttons.setEventMask((1UL << BUTTON_CLICK) | (1UL << BUTTON_LONG_CLICK) | (1UL << BUTTON_REPEAT));
+ *
+ * button_event_t event;
+ * while (buttons.read(&event)) {
+ *     if (event.button == ok && event.type == BUTTON_CLICK) ...
+ * }
+ * @endcode
+ */
+class ButtonManager
+{
+    static_assert(MaxButtons > 0 && MaxButtons <= 255, "up to 255 buttons are supported");
+public:
+    /**
+     * Constructor. The default configuration uses the press threshold and double click delay of Button
+     * @param tickUs the sample interval in us
+     * @param samples the number of consecutive samples needed to change the debounced state (1 - 63)
+     */
+    ButtonManager(uint32_t tickUs = DEFAULT_BUTTON_TICK_US, uint8_t samples = DEFAULT_BUTTON_DEBOUNCE_SAMPLES)
+        : tickUs(tickUs), samples(samples < 1 ? 1 : samples > COUNT_MASK ? COUNT_MASK : samples),
+          stepRemainderUs(0), eventMask(DEFAULT_EVENT_MASK),
+          pressedMask(0), dropped(0), numButtons(0), numChords(0), running(false) {
+        setTiming(DEFAULT_PRESS_THRESHHOLD, DEFAULT_DOUBLE_CLICK_DELAY);
+    };
+
+    /**
+     * Adds a button. Sampling is started with the first button
+     * @param pin the pin to which the button is connected to
+     * @param edgeOrder the order of rising/falling edge that identifies a click
+     * @param mode the pull up/down mode for the button
+     * @param config the gesture configuration of the button, must stay valid. nullptr for the default configuration
+     * @return the index of the button, or -1 if no more buttons can be added
+     */
+    int add(PinName pin, button_edge_order_t edgeOrder = RISE_TO_FALL, PinMode mode = PullNone, const button_gesture_config_t * config = nullptr) {
+        if (numButtons >= MaxButtons) {
+            return -1;
+        }
+
+        gpio_init_in_ex(&gpios[numButtons], pin, mode);
+        uint8_t activeLow = edgeOrder == FALL_TO_RISE ? ACTIVE_LOW_BIT : 0;
+
+        // start released without an edge
+        states[numButtons].fsm = 0;
+        states[numButtons].elapsedMs = 0;
+        states[numButtons].clicks = 0;
+        states[numButtons].debounce = activeLow;
+        configs[numButtons] = config ? config : &defaultConfig;
+        numButtons++;
+
+        if (!running) {
+            start();
+        }
+
+        return numButtons - 1;
+    };
+
+    /**
+     * Sets the gesture configuration of a button
+     * @param index the index of the button
+     * @param config the configuration, must stay valid. nullptr for the default configuration
+     */
+    void setConfig(int index, const button_gesture_config_t * config) {configs[index] = config ? config : &defaultConfig;};
+
+    /**
+     * Sets the timeouts of the default configuration, longer times are limited to 65535 ms
+     * @param longClickMs the time in ms a button has to be pressed for a long click
+     * @param doubleClickMs the time in ms to wait for the second click of a double click
+     */
+    void setTiming(uint32_t longClickMs, uint32_t doubleClickMs) {
+        defaultConfig.longPressMs = longClickMs > 0xFFFF ? 0xFFFF : longClickMs;
+        defaultConfig.multiClickMs = doubleClickMs > 0xFFFF ? 0xFFFF : doubleClickMs;
+        defaultConfig.maxClicks = 2;
+        defaultConfig.repeatDelayMs = 0;
+        defaultConfig.repeatIntervalMs = 0;
+    };
+
+    /**
+     * Adds a chord. A BUTTON_CHORD event is generated when all buttons of the chord are pressed at the same
+     * time, the rest of the press is then ignored by the buttons. Only the first 32 buttons can be part of a chord
+     * @param buttons mask of the buttons, bit i is the button with index i
+     * @return the index of the chord, which is the button field of its events, or -1 if no more chords can be added
+     */
+    int addChord(uint32_t buttons) {
+        if (numChords >= BUTTON_MAX_CHORDS) {
+            return -1;
+        }
+
+        chords[numChords] = buttons;
+        return numChords++;
+    };
+
+    /**
+     * Selects the events that are put into the queue. By default these are BUTTON_CLICK, BUTTON_DOUBLE_CLICK
+     * and BUTTON_LONG_CLICK, the other events have to be enabled
+     * @param mask bit (1 << type) enables the events of button_event_type_t type
+     */
+    void setEventMask(uint32_t mask) {eventMask = mask;};
+
+    /**
+     * Reads the oldest event
+     * @param event pointer to the location the event is copied to
+     * @return true if an event was read, false if the queue is empty
+     */
+    bool read(button_event_t * event) {return events.pop(event);};
+
+    /**
+     * Returns whether a button is currently pressed (debounced)
+     * @param index the index of the button
+     * @return true when the button is pressed, false otherwise
+     */
+    bool isPressed(int index) {return states[index].debounce & STATE_BIT;};
+
+    /**
+     * Gets the number of events that were dropped because the queue was full
+     * @return the number of dropped events
+     */
+    uint32_t getDropped() {return dropped;};
+
+    /**
+     * Gets the number of buttons
+     * @return the number of added buttons
+     */
+    int size() {return numButtons;};
+
+    /**
+     * Starts sampling
+     */
+    void start() {
+        running = true;
+        ticker.attach_us(callback(this, &ButtonManager::tick), tickUs);
+    };
+
+    /**
+     * Stops sampling, the states of the buttons are kept
+     */
+    void stop() {
+        ticker.detach();
+        running = false;
+    };
+
+    /**
+     * Samples all buttons and advances their state machines. Called by the ticker, can also be called
+     * manually when the ticker is stopped
+     */
+    void tick() {
+        uint32_t now = us_ticker_read();
+        uint32_t previousMask = pressedMask;
+
+        // the state machines count whole ms, the rest is carried over to the next tick
+        uint32_t stepUs = tickUs + stepRemainderUs;
+        uint16_t stepMs = stepUs / 1000;
+        stepRemainderUs = stepUs % 1000;
+
+        for (uint8_t i = 0; i < numButtons; i++) {
+            button_state_t * button = &states[i];
+            uint8_t input = debounce(button, gpio_read(&gpios[i]));
+
+            if (input == ButtonFsm::INPUT_PRESS) {
+                post(now, i, BUTTON_DOWN, 1);
+                if (i < 32) {
+                    pressedMask |= 1UL << i;
+                }
+            }else if (input == ButtonFsm::INPUT_RELEASE) {
+                post(now, i, BUTTON_UP, 1);
+                if (i < 32) {
+                    pressedMask &= ~(1UL << i);
+                }
+            }
+
+            uint8_t count = 1;
+            uint8_t event = ButtonFsm::update(button, input, configs[i], eventMask, stepMs, &count);
+            if (event != BUTTON_NONE) {
+                post(now, i, event, count);
+            }
+        }
+
+        if (pressedMask != previousMask) {
+            checkChords(now, previousMask);
+        }
+    };
+private:
+    static constexpr uint8_t STATE_BIT = 0x80;
+    static constexpr uint8_t ACTIVE_LOW_BIT = 0x40;
+    static constexpr uint8_t COUNT_MASK = 0x3F;
+    static constexpr uint32_t DEFAULT_EVENT_MASK = (1UL << BUTTON_CLICK) | (1UL << BUTTON_DOUBLE_CLICK) | (1UL << BUTTON_LONG_CLICK);
+
+    Ticker ticker;
+    gpio_t gpios[MaxButtons];
+    button_state_t states[MaxButtons];
+    const button_gesture_config_t * configs[MaxButtons];
+    button_gesture_config_t defaultConfig;
+    uint32_t chords[BUTTON_MAX_CHORDS];
+    StaticRingBuffer<button_event_t, QueueSize> events;
+    uint32_t tickUs;
+    uint8_t samples;
+    uint16_t stepRemainderUs;
+    uint32_t eventMask;
+    uint32_t pressedMask;
+    volatile uint32_t dropped;
+    uint8_t numButtons;
+    uint8_t numChords;
+    bool running;
+
+    uint8_t debounce(button_state_t * button, int level) {
+        uint8_t d = button->debounce;
+        uint8_t count = d & COUNT_MASK;
+        bool pressed = (level != 0) != ((d & ACTIVE_LOW_BIT) != 0);
+
+        if (pressed) {
+            if (count < samples && ++count == samples && !(d & STATE_BIT)) {
+                button->debounce = (d & ACTIVE_LOW_BIT) | STATE_BIT | count;
+                return ButtonFsm::INPUT_PRESS;
+            }
+        } else {
+            if (count > 0 && --count == 0 && (d & STATE_BIT)) {
+                button->debounce = d & ACTIVE_LOW_BIT;
+                return ButtonFsm::INPUT_RELEASE;
+            }
+        }
+
+        button->debounce = (d & (STATE_BIT | ACTIVE_LOW_BIT)) | count;
+        return ButtonFsm::INPUT_NONE;
+    };
+
+    void checkChords(uint32_t now, uint32_t previousMask) {
+        for (uint8_t c = 0; c < numChords; c++) {
+            uint32_t chord = chords[c];
+
+            // the last button of the chord was pressed in this tick
+            if ((pressedMask & chord) == chord && (previousMask & chord) != chord) {
+                post(now, c, BUTTON_CHORD, 1);
+
+                // the members don't generate their own gestures for this press
+                for (uint32_t members = chord; members; members &= members - 1) {
+                    uint8_t i = __builtin_ctz(members);
+                    if (i < numButtons) {
+                        ButtonFsm::consume(&states[i]);
+                    }
+                }
+            }
+        }
+    };
+
+    void post(uint32_t now, uint8_t index, uint8_t type, uint8_t count) {
+        if (!(eventMask & (1UL << type))) {
+            return;
+        }
+
+        button_event_t event;
+        event.timestamp = now;
+        event.button = index;
+        event.type = type;
+        event.count = count;
+        if (!events.push(event)) {
+            dropped = dropped + 1;
+        }
+    };
+};
+
+#endif
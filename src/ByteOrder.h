@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_BYTE_ORDER_H_
+#define _MBED_EXT_BYTE_ORDER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <Vector.h>
+
+/**
+ * Order of the bytes of multi-byte values in a buffer
+ */
+typedef enum byte_order {
+    /* Most significant byte first (big endian) */
+    MSB_FIRST,
+    /* Least significant byte first (little endian) */
+    LSB_FIRST
+}byte_order_t;
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define NATIVE_BYTE_ORDER MSB_FIRST
+#else
+#define NATIVE_BYTE_ORDER LSB_FIRST
+#endif
+
+/*
+ * All loads go through memcpy, which avoids unaligned accesses and aliasing issues. The compiler
+ * turns them into single load instructions, and the swaps into REV / REV16 on ARM.
+ */
+
+/**
+ * Swaps the bytes of both 16-bit halves of a 32-bit value (REV16)
+ * @param v the value
+ * @return v with the bytes of each half swapped
+ */
+inline uint32_t swapHalfwords(uint32_t v) {
+    return ((v & 0xFF00FF00) >> 8) | ((v & 0x00FF00FF) << 8);
+}
+
+/**
+ * Reads a 16-bit value from a buffer
+ * @param src pointer to the first byte of the value
+ * @param order the byte order of the value in the buffer
+ * @return the value
+ */
+inline uint16_t loadUint16(const uint8_t * src, byte_order_t order) {
+    uint16_t v;
+    memcpy(&v, src, sizeof(v));
+    return order == NATIVE_BYTE_ORDER ? v : __builtin_bswap16(v);
+}
+
+/**
+ * Reads a 32-bit value from a buffer
+ * @param src pointer to the first byte of the value
+ * @param order the byte order of the value in the buffer
+ * @return the value
+ */
+inline uint32_t loadUint32(const uint8_t * src, byte_order_t order) {
+    uint32_t v;
+    memcpy(&v, src, sizeof(v));
+    return order == NATIVE_BYTE_ORDER ? v : __builtin_bswap32(v);
+}
+
+/**
+ * Decodes multiple 16-bit samples from a buffer.
+ * The source and destination may be the same memory when stride is 2, which allows decoding in place.
+ * @param src the raw bytes, e.g. read by I2CUtil::readBytes
+ * @param dst the array the samples are stored in
+ * @param count the number of samples
+ * @param order the byte order of the samples in the buffer
+ * @param stride distance in bytes between the start of two consecutive samples
+ */
+inline void unpackInt16(const uint8_t * src, int16_t * dst, size_t count, byte_order_t order, size_t stride = sizeof(int16_t)) {
+    if (stride != sizeof(int16_t)) {
+        for (size_t i = 0; i < count; i++) {
+            dst[i] = (int16_t)loadUint16(src + i * stride, order);
+        }
+        return;
+    }
+
+    size_t i = 0;
+
+    if (order != NATIVE_BYTE_ORDER) {
+        // two samples per 32-bit word
+        for (; i + 2 <= count; i += 2) {
+            uint32_t w;
+            memcpy(&w, src + i * 2, sizeof(w));
+            w = swapHalfwords(w);
+            memcpy(dst + i, &w, sizeof(w));
+        }
+    } else if ((const void *)src != (const void *)dst) {
+        memcpy(dst, src, count * sizeof(int16_t));
+        return;
+    }
+
+    for (; i < count; i++) {
+        dst[i] = (int16_t)loadUint16(src + i * 2, order);
+    }
+}
+
+/**
+ * Decodes multiple 32-bit samples from a buffer.
+ * The source and destination may be the same memory when stride is 4, which allows decoding in place.
+ * @param src the raw bytes
+ * @param dst the array the samples are stored in
+ * @param count the number of samples
+ * @param order the byte order of the samples in the buffer
+ * @param stride distance in bytes between the start of two consecutive samples
+ */
+inline void unpackInt32(const uint8_t * src, int32_t * dst, size_t count, byte_order_t order, size_t stride = sizeof(int32_t)) {
+    if (order == NATIVE_BYTE_ORDER && stride == sizeof(int32_t)) {
+        if ((const void *)src != (const void *)dst) {
+            memcpy(dst, src, count * sizeof(int32_t));
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = (int32_t)loadUint32(src + i * stride, order);
+    }
+}
+
+/**
+ * Decodes multiple 3-axis samples (x, y, z as 16-bit values) from a buffer
+ * @param src the raw bytes, e.g. a burst read of the accelerometer output registers
+ * @param dst the array the samples are stored in
+ * @param count the number of samples
+ * @param order the byte order of the axis values in the buffer
+ * @param stride distance in bytes between the start of two consecutive samples
+ */
+inline void unpackVector3(const uint8_t * src, Vector3<int16_t> * dst, size_t count, byte_order_t order, size_t stride = 3 * sizeof(int16_t)) {
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t * sample = src + i * stride;
+        int16_t x = (int16_t)loadUint16(sample, order);
+        int16_t y = (int16_t)loadUint16(sample + 2, order);
+        int16_t z = (int16_t)loadUint16(sample + 4, order);
+
+        dst[i].x = x;
+        dst[i].y = y;
+        dst[i].z = z;
+    }
+}
+
+#endif
@@ -78,6 +78,10 @@ SOFTWARE.
 
 /* Bit manipulation */
 
+/*
+ * Note: the following macros evaluate their arguments multiple times and modify the value they
+ * are given. See BitField.h for type safe functions without side effects.
+ */
 
 /**
  * Gets the value of a bit at a specific position
@@ -107,7 +111,7 @@ SOFTWARE.
  * @param n the bit position to write, where 0 identifies the LSB
  * @param bit the value of the bit, either 1 or 0
  */
-#define bit_write(v, n, bit) (bit ? bit_set(v, n) : bit_clear(v, n))
+#define bit_write(v, n, bit) ((bit) ? bit_set(v, n) : bit_clear(v, n))
 
 /**
  * Toggles the value of a bit at a specific position
@@ -126,7 +130,7 @@ SOFTWARE.
  * @param low the lower byte
  * @return the uint16_t that is combined from the two input values 
  */
-#define combine_uint16(high, low) (((uint16_t)high << 8) | low)
+#define combine_uint16(high, low) ((uint16_t)(((uint16_t)(high) << 8) | (low)))
 
 /**
  * Combines four 8-bit values (uint8_t) to a uint32_t value
@@ -136,34 +140,34 @@ SOFTWARE.
  * @param b4 byte 4
  * @return the uint32_t that is combined from the four input values 
  */
-#define combine_uint32(b1, b2, b3, b4) ((uint32_t)(b1 | (b2 << 8) | (b3 << 16) | (b4 << 24)))
+#define combine_uint32(b1, b2, b3, b4) ((uint32_t)(b1) | ((uint32_t)(b2) << 8) | ((uint32_t)(b3) << 16) | ((uint32_t)(b4) << 24))
 
 /**
  * Reads the higher order byte from a 16-bit value
  * @param v the 16-bit value
  * @return the high byte
  */
-#define high_byte(v) (v & 0xFF00)
+#define high_byte(v) (((v) >> 8) & 0x00FF)
 
 /**
  * Reads the lower order byte from a 16-bit value
  * @param v the 16-bit value
  * @return the low byte
  */
-#define low_byte(v) (v & 0x00FF)
+#define low_byte(v) ((v) & 0x00FF)
 
 /**
  * Casts uint16_t to int16_t
  * @param uint the uint16_t to cast
  * @return the casted int16_t value
  */
-#define uint16_to_int16(uint) (reinterpret_cast<int16_t&>(uint))
+#define uint16_to_int16(uint) ((int16_t)(uint16_t)(uint))
 
 /**
  * Casts uint32_t to int32_t
  * @param uint the uint32_t to cast
  * @return the casted int32_t value
  */
-#define uint32_to_int32(uint) (reinterpret_cast<int32_t&>(uint))
+#define uint32_to_int32(uint) ((int32_t)(uint32_t)(uint))
 
 #endif
\ No newline at end of file
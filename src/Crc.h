@@ -0,0 +1,234 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_CRC_H_
+#define _MBED_EXT_CRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <ByteOrder.h>
+
+/**
+ * Lookup tables for a CRC. Table 0 is the classic byte-wise table, tables 1 to Slices - 1 are
+ * used for slicing-by-N, where N bytes are processed per step.
+ */
+template<typename T, size_t Slices>
+struct CrcTables {
+    T table[Slices][256];
+};
+
+/**
+ * Reverses the order of the bits of a value
+ * @param v the value
+ * @return the bit reversed value
+ */
+template<typename T>
+constexpr T reflectBits(T v) {
+    T reflected = 0;
+    for (uint8_t bit = 0; bit < sizeof(T) * 8; bit++) {
+        if (v & ((T)1 << bit)) {
+            reflected |= (T)1 << (sizeof(T) * 8 - 1 - bit);
+        }
+    }
+    return reflected;
+}
+
+/**
+ * Generates the lookup tables for a CRC at compile time
+ * @return the lookup tables
+ */
+template<typename T, T Poly, bool Reflect, size_t Slices>
+constexpr CrcTables<T, Slices> makeCrcTables() {
+    const uint8_t width = sizeof(T) * 8;
+    CrcTables<T, Slices> tables = {};
+
+    // reflected algorithms shift to the right and use the bit reversed polynomial
+    const T poly = Reflect ? reflectBits<T>(Poly) : Poly;
+
+    for (uint16_t i = 0; i < 256; i++) {
+        T crc = 0;
+        if constexpr (Reflect) {
+            crc = (T)i;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? (T)((crc >> 1) ^ poly) : (T)(crc >> 1);
+            }
+        } else {
+            crc = (T)((T)i << (width - 8));
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                crc = (crc & ((T)1 << (width - 1))) ? (T)((crc << 1) ^ poly) : (T)(crc << 1);
+            }
+        }
+        tables.table[0][i] = crc;
+    }
+
+    for (size_t slice = 1; slice < Slices; slice++) {
+        for (uint16_t i = 0; i < 256; i++) {
+            T prev = tables.table[slice - 1][i];
+            tables.table[slice][i] = (T)((prev >> 8) ^ tables.table[0][prev & 0xFF]);
+        }
+    }
+
+    return tables;
+}
+
+/**
+ * Table driven CRC calculation. All parameters follow the usual Rocksoft model notation.
+ * The tables are generated at compile time and stored in flash.
+ *
+ * @code
+ * uint8_t crc = Crc8Smbus::compute(data, length);
+ * @endcode
+ *
+ * @tparam T type of the CRC register, which also defines the width (8, 16 or 32 bit)
+ * @tparam Poly the generator polynomial
+ * @tparam Init the initial value of the CRC register
+ * @tparam Reflect true if input and output are reflected (LSB first)
+ * @tparam XorOut value that is XORed to the final CRC
+ * @tparam Slices number of bytes processed per step. Values of 4 and 8 are supported for reflected 32-bit CRCs only, each slice costs 256 * sizeof(T) bytes of flash
+ */
+template<typename T, T Poly, T Init, bool Reflect, T XorOut, size_t Slices = 1>
+class Crc
+{
+    static_assert(Slices == 1 || (Reflect && sizeof(T) == 4 && (Slices == 4 || Slices == 8)), "slicing is only supported for reflected 32-bit CRCs");
+public:
+    typedef T value_type;
+
+    /**
+     * Initial value to pass to update() when computing a CRC in multiple parts
+     */
+    static constexpr T initial = Init;
+
+    /**
+     * Calculates the CRC of a buffer
+     * @param data the data
+     * @param length number of bytes
+     * @return the CRC
+     */
+    static T compute(const uint8_t * data, size_t length) {
+        return finalize(update(Init, data, length));
+    }
+
+    /**
+     * Feeds more data into a CRC calculation. Start with the initial value and call finalize() once all data is processed
+     * @param crc the current CRC register value
+     * @param data the data
+     * @param length number of bytes
+     * @return the new CRC register value
+     */
+    static T update(T crc, const uint8_t * data, size_t length) {
+        const T (&t)[Slices][256] = tables.table;
+
+        if constexpr (Slices == 8) {
+            for (; length >= 8; length -= 8, data += 8) {
+                uint32_t one = loadUint32(data, LSB_FIRST) ^ crc;
+                uint32_t two = loadUint32(data + 4, LSB_FIRST);
+                crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24]
+                    ^ t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+            }
+        } else if constexpr (Slices == 4) {
+            for (; length >= 4; length -= 4, data += 4) {
+                uint32_t one = loadUint32(data, LSB_FIRST) ^ crc;
+                crc = t[3][one & 0xFF] ^ t[2][(one >> 8) & 0xFF] ^ t[1][(one >> 16) & 0xFF] ^ t[0][one >> 24];
+            }
+        }
+
+        // remaining bytes one at a time
+        while (length--) {
+            if constexpr (Reflect) {
+                crc = (T)((crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF]);
+            } else if constexpr (sizeof(T) == 1) {
+                crc = t[0][crc ^ *data++];
+            } else {
+                crc = (T)((crc << 8) ^ t[0][((crc >> (sizeof(T) * 8 - 8)) ^ *data++) & 0xFF]);
+            }
+        }
+
+        return crc;
+    }
+
+    /**
+     * Finishes a CRC calculation that was done using update()
+     * @param crc the CRC register value
+     * @return the CRC
+     */
+    static T finalize(T crc) {
+        return (T)(crc ^ XorOut);
+    }
+
+    /**
+     * Calculates the CRC bit by bit without lookup tables. Slow, but only needs a few bytes of flash
+     * @param data the data
+     * @param length number of bytes
+     * @return the CRC
+     */
+    static T computeBitwise(const uint8_t * data, size_t length) {
+        constexpr uint8_t width = sizeof(T) * 8;
+        T crc = Init;
+
+        while (length--) {
+            if constexpr (Reflect) {
+                crc ^= *data++;
+                for (uint8_t bit = 0; bit < 8; bit++) {
+                    crc = (crc & 1) ? (T)((crc >> 1) ^ reflectBits<T>(Poly)) : (T)(crc >> 1);
+                }
+            } else {
+                crc ^= (T)((T)*data++ << (width - 8));
+                for (uint8_t bit = 0; bit < 8; bit++) {
+                    crc = (crc & ((T)1 << (width - 1))) ? (T)((crc << 1) ^ Poly) : (T)(crc << 1);
+                }
+            }
+        }
+
+        return finalize(crc);
+    }
+private:
+    static constexpr CrcTables<T, Slices> tables = makeCrcTables<T, Poly, Reflect, Slices>();
+};
+
+/**
+ * CRC-8 used for the SMBus packet error code (PEC)
+ */
+typedef Crc<uint8_t, 0x07, 0x00, false, 0x00> Crc8Smbus;
+
+/**
+ * CRC-8 used by Sensirion sensors (SHT3x, SGP30, SCD30, ...), calculated over every 16-bit word
+ */
+typedef Crc<uint8_t, 0x31, 0xFF, false, 0x00> Crc8Sensirion;
+
+/**
+ * CRC-16-CCITT (also known as CRC-16/CCITT-FALSE)
+ */
+typedef Crc<uint16_t, 0x1021, 0xFFFF, false, 0x0000> Crc16Ccitt;
+
+/**
+ * CRC-32 as used by Ethernet, zlib, PNG, etc. using slicing-by-4 (4 KB of tables)
+ */
+typedef Crc<uint32_t, 0x04C11DB7, 0xFFFFFFFF, true, 0xFFFFFFFF, 4> Crc32;
+
+/**
+ * CRC-32 using slicing-by-8 (8 KB of tables), roughly twice as fast as Crc32 for large buffers
+ */
+typedef Crc<uint32_t, 0x04C11DB7, 0xFFFFFFFF, true, 0xFFFFFFFF, 8> Crc32Fast;
+
+#endif
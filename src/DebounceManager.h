@@ -0,0 +1,166 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_DEBOUNCE_MANAGER_H_
+#define _MBED_EXT_DEBOUNCE_MANAGER_H_
+
+#include <mbed.h>
+
+#define DEFAULT_DEBOUNCE_TICK_US 2000
+#define DEFAULT_DEBOUNCE_SAMPLES 5
+
+template<size_t MaxPins = 32>
+/**
+ * Debounces many inputs with a single Ticker. Every tick samples all pins and feeds an integrator per pin:
+ * the counter moves one step towards the sampled level and the debounced state only changes when it reaches
+ * 0 or the number of samples. Bouncing does not cause interrupts or timer reprogramming and the cost per tick is
+ * constant. A pin needs a gpio_t and one byte of state: gpio_t holds the register addresses the HAL reads the pin
+ * with and takes 20 - 28 bytes on most targets (e.g. STM32), so MaxPins should not be larger than needed. Pins of
+ * the same port are debounced with less memory by PortDebouncer.
+ *
+ * @code
+ * DebounceManager<> inputs;
+ * int start = inputs.add(BUTTON_START, PullUp);
+ * int stop = inputs.add(BUTTON_STOP, PullUp);
+ *
+ * inputs.onChange([](int index, bool state) {
+ *     // executed in an ISR
+ * });
+ * @endcode
+ */
+class DebounceManager
+{
+    static_assert(MaxPins > 0 && MaxPins <= 255, "up to 255 pins are supported");
+public:
+    /**
+     * Constructor. The debounce time is tickUs * samples
+     * @param tickUs the sample interval in us
+     * @param samples the number of consecutive samples needed to change the state (1 - 127)
+     */
+    DebounceManager(uint32_t tickUs = DEFAULT_DEBOUNCE_TICK_US, uint8_t samples = DEFAULT_DEBOUNCE_SAMPLES)
+        : tickUs(tickUs), samples(samples < 1 ? 1 : samples > COUNT_MASK ? COUNT_MASK : samples), numPins(0), running(false) {};
+
+    /**
+     * Adds a pin. Sampling is started with the first pin
+     * @param pin the input pin
+     * @param mode the pull up/down mode of the pin
+     * @return the index of the pin, or -1 if no more pins can be added
+     */
+    int add(PinName pin, PinMode mode = PullNone) {
+        if (numPins >= MaxPins) {
+            return -1;
+        }
+
+        gpio_init_in_ex(&gpios[numPins], pin, mode);
+
+        // start in the current state without an edge
+        states[numPins] = gpio_read(&gpios[numPins]) ? (STATE_BIT | samples) : 0;
+        numPins++;
+
+        if (!running) {
+            start();
+        }
+
+        return numPins - 1;
+    };
+
+    /**
+     * Registers for debounced edges of all pins
+     * @param handler the function that is called with the index and the new state of the pin. Note that this is executed in an ISR
+     */
+    void onChange(Callback<void(int index, bool state)> handler) {changeHandler = handler;};
+
+    /**
+     * Reads the debounced state of a pin
+     * @param index the index of the pin
+     * @return the debounced value of the pin
+     */
+    int read(int index) {return (states[index] & STATE_BIT) ? 1 : 0;};
+
+    /**
+     * Gets the number of pins
+     * @return the number of added pins
+     */
+    int size() {return numPins;};
+
+    /**
+     * Starts sampling
+     */
+    void start() {
+        running = true;
+        ticker.attach_us(callback(this, &DebounceManager::sample), tickUs);
+    };
+
+    /**
+     * Stops sampling, the debounced states are kept
+     */
+    void stop() {
+        ticker.detach();
+        running = false;
+    };
+
+    /**
+     * Samples all pins once. Called by the ticker, can also be called manually when the ticker is stopped
+     */
+    void sample() {
+        for (uint8_t i = 0; i < numPins; i++) {
+            uint8_t state = states[i];
+            uint8_t count = state & COUNT_MASK;
+
+            if (gpio_read(&gpios[i])) {
+                if (count < samples && ++count == samples && !(state & STATE_BIT)) {
+                    states[i] = STATE_BIT | count;
+                    if (changeHandler) {
+                        changeHandler(i, true);
+                    }
+                    continue;
+                }
+            } else {
+                if (count > 0 && --count == 0 && (state & STATE_BIT)) {
+                    states[i] = 0;
+                    if (changeHandler) {
+                        changeHandler(i, false);
+                    }
+                    continue;
+                }
+            }
+
+            states[i] = (state & STATE_BIT) | count;
+        }
+    };
+private:
+    static constexpr uint8_t STATE_BIT = 0x80;
+    static constexpr uint8_t COUNT_MASK = 0x7F;
+
+    Ticker ticker;
+    gpio_t gpios[MaxPins];
+    uint8_t states[MaxPins];
+    Callback<void(int, bool)> changeHandler;
+    uint32_t tickUs;
+    uint8_t samples;
+    uint8_t numPins;
+    bool running;
+};
+
+#endif
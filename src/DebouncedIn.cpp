@@ -1,6 +1,12 @@
 #include <DebouncedIn.h>
 
-DebouncedIn::DebouncedIn(PinName pin, PinMode mode) : input(pin, mode) {}
+DebouncedIn::DebouncedIn(PinName pin, PinMode mode, uint32_t debounceUs)
+    : input(pin, mode), debounceUs(debounceUs), minUs(DEFAULT_ADAPTIVE_MIN_US), maxUs(DEFAULT_ADAPTIVE_MAX_US),
+      gapEstimate(0), burstStart(0), burstMaxGap(0), lastEdge(0), settledAt(0), adaptive(false), settling(false), tracking(false) {
+    state = input.read();
+    settledAt = us_ticker_read() - debounceUs;
+    resetStats();
+}
 
 int DebouncedIn::read() {
     return input.read();
@@ -8,49 +14,127 @@ int DebouncedIn::read() {
 
 void DebouncedIn::rise(Callback<void()> handler) {
     riseHandler = handler;
-    
-    if (handler) {
-        input.rise(callback(this, &DebouncedIn::onInputRise));
+    updateInterrupts();
+}
+
+void DebouncedIn::fall(Callback<void()> handler) {
+    fallHandler = handler;
+    updateInterrupts();
+}
+
+void DebouncedIn::updateInterrupts() {
+    if (riseHandler || fallHandler) {
+        if (!tracking) {
+            // edges were not tracked while no handler was registered, start from the current level
+            core_util_critical_section_enter();
+            state = input.read();
+            settledAt = us_ticker_read() - debounceUs;
+            tracking = true;
+            core_util_critical_section_exit();
+        }
+
+        // both edges are needed to tell when the input settled
+        input.rise(callback(this, &DebouncedIn::onInputEdge));
+        input.fall(callback(this, &DebouncedIn::onInputEdge));
     }else{
-        // reset input rise handler and timeout
+        // reset input handlers and timeout
         input.rise(nullptr);
-        debounceRiseTimeout.detach();
+        input.fall(nullptr);
+        debounceTimeout.detach();
+        settling = false;
+        tracking = false;
     }
-    
 }
 
-void DebouncedIn::onInputRise() {
-    // start debounce timeout
-    debounceRiseTimeout.attach(callback(this, &DebouncedIn::onRiseTimeout), DEBOUNCE_TIME);
+void DebouncedIn::setDebounceTime(uint32_t us) {
+    core_util_critical_section_enter();
+    debounceUs = us;
+    gapEstimate = us / 2;
+    core_util_critical_section_exit();
 }
 
-void DebouncedIn::onRiseTimeout() {
-    if (input.read() && riseHandler) {
-        // call if input still high and handler != null 
-        riseHandler();
-    }
+void DebouncedIn::setAdaptive(bool enabled, uint32_t minUs, uint32_t maxUs) {
+    core_util_critical_section_enter();
+    adaptive = enabled;
+    this->minUs = minUs;
+    this->maxUs = maxUs;
+    gapEstimate = debounceUs / 2;
+    core_util_critical_section_exit();
 }
 
-void DebouncedIn::fall(Callback<void()> handler) {
-    fallHandler = handler;
+debounce_stats_t DebouncedIn::getStats() {
+    core_util_critical_section_enter();
+    debounce_stats_t copy = stats;
+    core_util_critical_section_exit();
+    return copy;
+}
+
+void DebouncedIn::resetStats() {
+    core_util_critical_section_enter();
+    memset(&stats, 0, sizeof(stats));
+    core_util_critical_section_exit();
+}
+
+void DebouncedIn::adapt(uint32_t gapUs) {
+    // follow longer gaps immediately, forget them slowly
+    uint32_t decayed = gapEstimate - gapEstimate / 16;
+    gapEstimate = gapUs > decayed ? gapUs : decayed;
+    uint32_t target = gapEstimate * 2;
+    debounceUs = target < minUs ? minUs : target > maxUs ? maxUs : target;
+}
+
+void DebouncedIn::onInputEdge() {
+    uint32_t now = us_ticker_read();
+    uint32_t gap = now - lastEdge;
+    stats.edges++;
 
-    if (handler) {
-        input.fall(callback(this, &DebouncedIn::onInputFall));
+    if (settling) {
+        stats.bounces++;
+        if (gap > burstMaxGap) {
+            burstMaxGap = gap;
+        }
     }else{
-        // reset input fall handler and timeout
-        input.rise(nullptr);
-        debounceFallTimeout.detach();
+        if (now - settledAt < debounceUs) {
+            // the previous burst was still bouncing when the timeout expired
+            stats.undershoots++;
+            if (adaptive) {
+                adapt(gap);
+            }
+        }
+        settling = true;
+        burstStart = now;
+        burstMaxGap = 0;
     }
-}
+    lastEdge = now;
 
-void DebouncedIn::onInputFall() {
-    // start debounce timeout
-    debounceFallTimeout.attach(callback(this, &DebouncedIn::onFallTimeout), DEBOUNCE_TIME);
+    // (re)start debounce timeout
+    debounceTimeout.attach_us(callback(this, &DebouncedIn::onTimeout), debounceUs);
 }
 
-void DebouncedIn::onFallTimeout() {
-    if (!input.read() && fallHandler) {
-        // call if input still low and handler != null
+void DebouncedIn::onTimeout() {
+    uint32_t bounceUs = lastEdge - burstStart;
+    settling = false;
+    settledAt = us_ticker_read();
+
+    if (bounceUs > stats.maxBounceUs) {
+        stats.maxBounceUs = bounceUs;
+    }
+    if (adaptive) {
+        adapt(burstMaxGap);
+    }
+
+    bool level = input.read();
+    if (level == state) {
+        stats.glitches++;
+        return;
+    }
+    state = level;
+
+    if (level && riseHandler) {
+        // call if input settled high and handler != null
+        riseHandler();
+    }else if (!level && fallHandler) {
+        // call if input settled low and handler != null
         fallHandler();
     }
-}
\ No newline at end of file
+}
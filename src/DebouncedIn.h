@@ -28,9 +28,34 @@ SOFTWARE.
 #include <mbed.h>
 
 #define DEBOUNCE_TIME 0.01f // 10ms
+#define DEFAULT_DEBOUNCE_TIME_US ((uint32_t)(DEBOUNCE_TIME * 1000000))
+#define DEFAULT_ADAPTIVE_MIN_US 1000
+#define DEFAULT_ADAPTIVE_MAX_US 50000
 
 /**
- * Provides a debounced input
+ * Bounce statistics of a debounced input
+ */
+typedef struct debounce_stats {
+    /* Raw edges seen on the input */
+    uint32_t edges;
+    /* Edges that followed another edge within the debounce time */
+    uint32_t bounces;
+    /* Bursts of edges that ended in the previous state and didn't cause an event */
+    uint32_t glitches;
+    /* Bursts that started within the debounce time after the previous one settled, i.e. the debounce time was too short */
+    uint32_t undershoots;
+    /* Longest observed bounce in us, from the first to the last edge of a burst */
+    uint32_t maxBounceUs;
+}debounce_stats_t;
+
+/**
+ * Provides a debounced input. Every edge restarts a timeout, when it expires the input has been stable
+ * for the debounce time and a rise / fall event is generated if the level differs from the last debounced state.
+ *
+ * Since every edge restarts the timeout, the debounce time only has to be longer than the largest gap between
+ * the edges of a bounce. In adaptive mode it is set to twice the largest recent gap (forgotten slowly) within
+ * the given limits, and a burst that starts right after the previous one settled counts its gap as well. The
+ * initial debounce time has to be shorter than the time between real changes of the input, e.g. about 1 ms for encoders.
  */
 class DebouncedIn
 {
@@ -39,8 +64,9 @@ public:
      * Constructor
      * @param pin the input pin to debounce
      * @param mode pull up / pull down mode for input pin
+     * @param debounceUs the time in us the input has to be stable
      */
-    DebouncedIn(PinName pin, PinMode mode = PullNone);
+    DebouncedIn(PinName pin, PinMode mode = PullNone, uint32_t debounceUs = DEFAULT_DEBOUNCE_TIME_US);
 
     /**
      * Registers for the debounced rise event.
@@ -59,19 +85,70 @@ public:
      * @return the value of the input pin
      */
     int read();
+
+    /**
+     * Sets the debounce time. In adaptive mode this is only the starting point
+     * @param us the time in us the input has to be stable
+     */
+    void setDebounceTime(uint32_t us);
+
+    /**
+     * Gets the current debounce time
+     * @return the debounce time in us
+     */
+    uint32_t getDebounceTime() {return debounceUs;};
+
+    /**
+     * Gets the time at which the last debounced change started. Useful in the rise / fall handlers,
+     * which are only called after the debounce time
+     * @return the us_ticker_read() time of the first edge of the last burst
+     */
+    uint32_t getEdgeTime() {return burstStart;};
+
+    /**
+     * Enables or disables the adaptive debounce time
+     * @param enabled true to tune the debounce time from the measured bounces
+     * @param minUs the lower limit of the debounce time in us
+     * @param maxUs the upper limit of the debounce time in us
+     */
+    void setAdaptive(bool enabled, uint32_t minUs = DEFAULT_ADAPTIVE_MIN_US, uint32_t maxUs = DEFAULT_ADAPTIVE_MAX_US);
+
+    /**
+     * Gets the bounce statistics
+     * @return a copy of the statistics
+     */
+    debounce_stats_t getStats();
+
+    /**
+     * Resets the bounce statistics
+     */
+    void resetStats();
 private:
     InterruptIn input;
-    LowPowerTimeout debounceRiseTimeout;
-    LowPowerTimeout debounceFallTimeout;
+    LowPowerTimeout debounceTimeout;
     Callback<void()> riseHandler;
     Callback<void()> fallHandler;
+    debounce_stats_t stats;
+    uint32_t debounceUs;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t gapEstimate;
+    uint32_t burstStart;
+    uint32_t burstMaxGap;
+    uint32_t lastEdge;
+    uint32_t settledAt;
+    bool adaptive;
+    bool settling;
+    bool tracking;
+    bool state;
+
+    void updateInterrupts();
+    void adapt(uint32_t gapUs);
 
     /* ISR handlers */
-    void onInputRise();
-    void onRiseTimeout();
-    void onInputFall();
-    void onFallTimeout();
+    void onInputEdge();
+    void onTimeout();
 };
 
 
-#endif
\ No newline at end of file
+#endif
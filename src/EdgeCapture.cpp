@@ -0,0 +1,143 @@
+#include <EdgeCapture.h>
+
+EdgeCapture::EdgeCapture(edge_event_t * storage, size_t capacity) : events(storage, capacity), numChannels(0), debouncedChannels(false),
+        overflows(0), clearedOverflows(0) {}
+
+EdgeCapture::Channel * EdgeCapture::addChannel(DebouncedIn * debounced) {
+    if (numChannels >= EDGE_CAPTURE_MAX_CHANNELS) {
+        return nullptr;
+    }
+    if (numChannels > 0 && debouncedChannels != (debounced != nullptr)) {
+        // the ISRs of both kinds may preempt each other, which breaks the single producer
+        return nullptr;
+    }
+    debouncedChannels = debounced != nullptr;
+
+    Channel * channel = &channels[numChannels];
+    channel->owner = this;
+    channel->debounced = debounced;
+    channel->index = numChannels++;
+    return channel;
+}
+
+int EdgeCapture::attach(InterruptIn * input, edge_capture_mode_t mode) {
+    Channel * channel = addChannel(nullptr);
+    if (channel == nullptr) {
+        return -1;
+    }
+
+    if (mode & CAPTURE_RISE) {
+        input->rise(callback(channel, &Channel::onRise));
+    }
+    if (mode & CAPTURE_FALL) {
+        input->fall(callback(channel, &Channel::onFall));
+    }
+    return channel->index;
+}
+
+int EdgeCapture::attach(DebouncedIn * input, edge_capture_mode_t mode) {
+    Channel * channel = addChannel(input);
+    if (channel == nullptr) {
+        return -1;
+    }
+
+    if (mode & CAPTURE_RISE) {
+        input->rise(callback(channel, &Channel::onDebouncedRise));
+    }
+    if (mode & CAPTURE_FALL) {
+        input->fall(callback(channel, &Channel::onDebouncedFall));
+    }
+    return channel->index;
+}
+
+void EdgeCapture::capture(uint8_t channel, edge_type_t edge, uint32_t timestamp) {
+    edge_event_t event;
+    event.timestamp = timestamp;
+    event.channel = channel;
+    event.edge = edge;
+
+    if (!events.push(event)) {
+        // only written by the producer, no read-modify-write race with the consumer
+        overflows = overflows + 1;
+    }
+}
+
+size_t EdgeCapture::read(edge_event_t * buffer, size_t max) {
+    return events.pop(buffer, max);
+}
+
+size_t EdgeCapture::available() {
+    return events.size();
+}
+
+void EdgeCapture::clear() {
+    events.clear();
+    // overflows is only written by the producer, keep its current count instead of resetting it
+    clearedOverflows = overflows;
+}
+
+void EdgeCapture::Channel::onRise() {
+    owner->capture(index, EDGE_RISING, us_ticker_read());
+}
+
+void EdgeCapture::Channel::onFall() {
+    owner->capture(index, EDGE_FALLING, us_ticker_read());
+}
+
+void EdgeCapture::Channel::onDebouncedRise() {
+    owner->capture(index, EDGE_RISING, debounced->getEdgeTime());
+}
+
+void EdgeCapture::Channel::onDebouncedFall() {
+    owner->capture(index, EDGE_FALLING, debounced->getEdgeTime());
+}
+
+EdgeTimer::EdgeTimer(uint8_t channel) : lastRise(0), channel(channel), hasRise(false) {
+    reset();
+}
+
+void EdgeTimer::add(const edge_event_t & event) {
+    if (event.channel != channel) {
+        return;
+    }
+
+    if (event.edge == EDGE_RISING) {
+        if (hasRise) {
+            periodSum += (uint32_t)(event.timestamp - lastRise);
+            cycles++;
+        }
+        lastRise = event.timestamp;
+        hasRise = true;
+    }else if (hasRise) {
+        highSum += (uint32_t)(event.timestamp - lastRise);
+        highPhases++;
+    }
+}
+
+void EdgeTimer::add(const edge_event_t * events, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        add(events[i]);
+    }
+}
+
+float EdgeTimer::getPeriod() {
+    return cycles ? (float)periodSum / cycles : 0;
+}
+
+float EdgeTimer::getFrequency() {
+    return periodSum ? cycles * 1000000.0f / periodSum : 0;
+}
+
+float EdgeTimer::getDutyCycle() {
+    if (!cycles || !highPhases) {
+        return 0;
+    }
+    return ((float)highSum / highPhases) / ((float)periodSum / cycles);
+}
+
+void EdgeTimer::reset() {
+    periodSum = 0;
+    highSum = 0;
+    cycles = 0;
+    highPhases = 0;
+}
@@ -0,0 +1,247 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_EDGE_CAPTURE_H_
+#define _MBED_EXT_EDGE_CAPTURE_H_
+
+#include <mbed.h>
+#include <RingBuffer.h>
+#include <DebouncedIn.h>
+
+#ifndef EDGE_CAPTURE_MAX_CHANNELS
+#define EDGE_CAPTURE_MAX_CHANNELS 8
+#endif
+
+/**
+ * Direction of a captured edge
+ */
+typedef enum edge_type {
+    EDGE_FALLING = 0,
+    EDGE_RISING = 1
+}edge_type_t;
+
+/**
+ * Edges of an input that are captured
+ */
+typedef enum edge_capture_mode {
+    CAPTURE_RISE = 1,
+    CAPTURE_FALL = 2,
+    CAPTURE_BOTH = 3
+}edge_capture_mode_t;
+
+/**
+ * A captured edge
+ */
+typedef struct edge_event {
+    /* Time of the edge in us (us_ticker_read()) */
+    uint32_t timestamp;
+    /* Channel of the input, as returned by EdgeCapture::attach */
+    uint8_t channel;
+    /* EDGE_RISING or EDGE_FALLING */
+    uint8_t edge;
+}edge_event_t;
+
+/**
+ * Records timestamped edges of inputs from their ISRs into a lock-free ring buffer, so the timing is kept
+ * until the events are read in the main loop. An edge costs a timer read and a copy of 8 bytes. Edges that
+ * arrive while the buffer is full are dropped and counted as overflows.
+ *
+ * All attached inputs are producers of the same single producer ring buffer, so their interrupts must not
+ * preempt each other. The edges of an InterruptIn are captured in the GPIO interrupt and the debounced edges
+ * of a DebouncedIn in the timer interrupt, which may have different priorities. Therefore an EdgeCapture only
+ * accepts one kind of input, use a second EdgeCapture for the other kind.
+ *
+ * @code
+ * StaticEdgeCapture<256> capture;
+ * InterruptIn flowMeter(p5);
+ * capture.attach(&flowMeter, CAPTURE_RISE);
+ *
+ * edge_event_t events[32];
+ * size_t n = capture.read(events, 32);
+ * @endcode
+ */
+class EdgeCapture
+{
+public:
+    /**
+     * Constructor
+     * @param storage the storage of the events
+     * @param capacity the number of events of the storage, must be a power of two
+     */
+    EdgeCapture(edge_event_t * storage, size_t capacity);
+
+    /**
+     * Captures the edges of an input. The rise / fall handlers of the input are replaced
+     * @param input the input
+     * @param mode the edges to capture
+     * @return the channel of the input, or -1 if all channels are used or a DebouncedIn is attached
+     */
+    int attach(InterruptIn * input, edge_capture_mode_t mode = CAPTURE_BOTH);
+
+    /**
+     * Captures the debounced edges of an input. The timestamp is the start of the change, not the end of
+     * the debounce time. The rise / fall handlers of the input are replaced
+     * @param input the input
+     * @param mode the edges to capture
+     * @return the channel of the input, or -1 if all channels are used or an InterruptIn is attached
+     */
+    int attach(DebouncedIn * input, edge_capture_mode_t mode = CAPTURE_BOTH);
+
+    /**
+     * Records an edge. Called by the attached inputs, can also be called from other ISRs with the same priority
+     * @param channel the channel
+     * @param edge the edge type
+     * @param timestamp the time of the edge in us
+     */
+    void capture(uint8_t channel, edge_type_t edge, uint32_t timestamp);
+
+    /**
+     * Reads the oldest events
+     * @param events pointer to the location the events are copied to
+     * @param max the maximum number of events to read
+     * @return the number of read events
+     */
+    size_t read(edge_event_t * events, size_t max);
+
+    /**
+     * Gets the number of events that can be read
+     * @return the number of buffered events
+     */
+    size_t available();
+
+    /**
+     * Gets the number of edges that were dropped because the buffer was full since the last clear
+     * @return the number of dropped edges
+     */
+    uint32_t getOverflows() {return overflows - clearedOverflows;};
+
+    /**
+     * Drops all buffered events and resets the overflow counter. Must only be called by the consumer
+     */
+    void clear();
+private:
+    /**
+     * Binds the ISRs of an input to its channel
+     */
+    struct Channel {
+        EdgeCapture * owner;
+        DebouncedIn * debounced;
+        uint8_t index;
+
+        void onRise();
+        void onFall();
+        void onDebouncedRise();
+        void onDebouncedFall();
+    };
+
+    RingBuffer<edge_event_t> events;
+    Channel channels[EDGE_CAPTURE_MAX_CHANNELS];
+    uint8_t numChannels;
+    bool debouncedChannels;
+    // written by the producer only, the consumer keeps the count at the last clear
+    volatile uint32_t overflows;
+    uint32_t clearedOverflows;
+
+    Channel * addChannel(DebouncedIn * debounced);
+};
+
+template<size_t N>
+/**
+ * EdgeCapture with a static storage of N events, N must be a power of two
+ */
+class StaticEdgeCapture : public EdgeCapture
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "the capacity must be a power of two");
+public:
+    StaticEdgeCapture() : EdgeCapture(storage, N) {};
+private:
+    edge_event_t storage[N];
+};
+
+/**
+ * Derives period, frequency and duty cycle of a periodic signal from its captured edges. The values are
+ * averaged over all complete cycles since the last reset, which keeps the precision at high frequencies
+ * where a single period is only a few timer ticks long.
+ */
+class EdgeTimer
+{
+public:
+    /**
+     * Constructor
+     * @param channel the channel whose events are evaluated
+     */
+    EdgeTimer(uint8_t channel = 0);
+
+    /**
+     * Adds an event, events of other channels are ignored
+     * @param event the event
+     */
+    void add(const edge_event_t & event);
+
+    /**
+     * Adds a batch of events, events of other channels are ignored
+     * @param events the events
+     * @param count the number of events
+     */
+    void add(const edge_event_t * events, size_t count);
+
+    /**
+     * Gets the number of complete cycles (rising to rising edge) since the last reset
+     * @return the number of cycles
+     */
+    uint32_t getCycles() {return cycles;};
+
+    /**
+     * Gets the average period
+     * @return the period in us, 0 if no cycle was completed
+     */
+    float getPeriod();
+
+    /**
+     * Gets the average frequency
+     * @return the frequency in Hz, 0 if no cycle was completed
+     */
+    float getFrequency();
+
+    /**
+     * Gets the average duty cycle. Needs rising and falling edges
+     * @return the high time divided by the period (0 - 1), 0 if no high phase was completed
+     */
+    float getDutyCycle();
+
+    /**
+     * Starts a new measurement window. The last edges are kept, so no cycle is lost between windows
+     */
+    void reset();
+private:
+    uint64_t periodSum;
+    uint64_t highSum;
+    uint32_t cycles;
+    uint32_t highPhases;
+    uint32_t lastRise;
+    uint8_t channel;
+    bool hasRise;
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include <FifoStreamReader.h>
+
+#if DEVICE_I2C_ASYNCH
+
+FifoStreamReader::FifoStreamReader(I2CAsync * bus, PinName watermarkPin, const fifo_stream_config_t & config, uint8_t * buffer, size_t framesPerBlock,
+                                   bool activeHigh, IsrUtil * dispatcher)
+    : bus(bus), watermark(watermarkPin), config(config), buffer(buffer), blockSize(framesPerBlock * config.frameSize), activeHigh(activeHigh),
+      dispatcher(dispatcher), reading(false), pendingTrigger(false), running(false), activeBlock(0), blockReady(false), fill(0), remaining(0), burstLength(0), framesRead(0) {
+    resetStats();
+
+    // both transactions are handled in interrupt context
+    countTransaction.setDeferred(false);
+    dataTransaction.setDeferred(false);
+
+    if (activeHigh) {
+        watermark.rise(callback(this, &FifoStreamReader::trigger));
+    } else {
+        watermark.fall(callback(this, &FifoStreamReader::trigger));
+    }
+    watermark.disable_irq();
+}
+
+void FifoStreamReader::start() {
+    running = true;
+    watermark.enable_irq();
+
+    // the watermark may already be reached, drain the FIFO so the next edge is generated
+    trigger();
+}
+
+void FifoStreamReader::stop() {
+    running = false;
+    watermark.disable_irq();
+}
+
+void FifoStreamReader::trigger() {
+    core_util_critical_section_enter();
+    if (reading) {
+        // drain again as soon as the current read is done
+        pendingTrigger = true;
+        core_util_critical_section_exit();
+        return;
+    }
+    reading = true;
+    pendingTrigger = false;
+    core_util_critical_section_exit();
+
+    framesRead = 0;
+    if (bus->read(&countTransaction, config.slaveAddress, config.countRegister, countBuffer, 2, callback(this, &FifoStreamReader::onCountRead)) != I2C_OK) {
+        stats.errors++;
+        reading = false;
+    }
+}
+
+void FifoStreamReader::onCountRead(I2CTransaction * transaction) {
+    if (transaction->result() != I2C_OK) {
+        stats.errors++;
+        finishRead();
+        return;
+    }
+
+    // only whole frames are read, the rest is read with the next watermark
+    size_t count = loadUint16(countBuffer, config.countOrder) & config.countMask;
+    remaining = count - count % config.frameSize;
+
+    readNextBurst();
+}
+
+void FifoStreamReader::readNextBurst() {
+    if (remaining == 0) {
+        finishRead();
+        return;
+    }
+
+    // bursts never cross the end of a block
+    size_t length = remaining;
+    if (length > blockSize - fill) {
+        length = blockSize - fill;
+    }
+    if (config.maxBurst > 0 && length > config.maxBurst) {
+        size_t maxLength = config.maxBurst - config.maxBurst % config.frameSize;
+        length = maxLength > 0 ? maxLength : config.frameSize;
+    }
+
+    burstLength = length;
+    stats.bursts++;
+
+    if (bus->read(&dataTransaction, config.slaveAddress, config.dataRegister, buffer + activeBlock * blockSize + fill, length,
+                  callback(this, &FifoStreamReader::onDataRead)) != I2C_OK) {
+        stats.errors++;
+        finishRead();
+    }
+}
+
+void FifoStreamReader::onDataRead(I2CTransaction * transaction) {
+    if (transaction->result() != I2C_OK) {
+        // the data stays in the FIFO and is read with the next watermark
+        stats.errors++;
+        finishRead();
+        return;
+    }
+
+    fill += burstLength;
+    remaining -= burstLength;
+    framesRead += burstLength / config.frameSize;
+
+    if (fill == blockSize) {
+        completeBlock();
+    }
+
+    readNextBurst();
+}
+
+void FifoStreamReader::completeBlock() {
+    fill = 0;
+
+    if (blockReady) {
+        // the application still processes the other block, the current one is overwritten
+        stats.overruns++;
+        stats.framesDropped += blockSize / config.frameSize;
+        return;
+    }
+
+    blockReady = true;
+    activeBlock ^= 1;
+    stats.blocks++;
+
+    if (dispatcher) {
+        // parentheses prevent the expansion of the runLater macro, which would use the global instance
+        (dispatcher->runLater)(callback(this, &FifoStreamReader::deliverBlock));
+    } else {
+        deliverBlock();
+    }
+}
+
+void FifoStreamReader::deliverBlock() {
+    // the ready block is always the one that is not filled
+    if (onBlockHandler) {
+        onBlockHandler(buffer + (activeBlock ^ 1) * blockSize, blockSize / config.frameSize);
+    }
+
+    blockReady = false;
+}
+
+void FifoStreamReader::finishRead() {
+    reading = false;
+
+    // an edge triggered interrupt is missed if the watermark was reached again while reading
+    bool asserted = watermark.read() == (activeHigh ? 1 : 0);
+    if (running && (pendingTrigger || (asserted && framesRead > 0))) {
+        trigger();
+    }
+}
+
+#endif
@@ -0,0 +1,183 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_FIFO_STREAM_READER_H_
+#define _MBED_EXT_FIFO_STREAM_READER_H_
+
+#include <mbed.h>
+#include <I2CAsync.h>
+#include <ByteOrder.h>
+
+#if DEVICE_I2C_ASYNCH
+
+/**
+ * Describes the FIFO of a sensor
+ */
+typedef struct fifo_stream_config {
+    /* 7-bit address of the slave */
+    uint8_t slaveAddress;
+    /* Register of the 16-bit FIFO fill level in bytes */
+    uint8_t countRegister;
+    /* Byte order of the fill level */
+    byte_order_t countOrder;
+    /* Mask of the valid bits of the fill level, e.g. 0x1FFF */
+    uint16_t countMask;
+    /* Register the FIFO is read from */
+    uint8_t dataRegister;
+    /* Size of a single sample (frame) in bytes */
+    uint8_t frameSize;
+    /* Maximum number of bytes read in a single burst, 0 for no limit */
+    uint16_t maxBurst;
+}fifo_stream_config_t;
+
+/**
+ * Statistics of a FifoStreamReader
+ */
+typedef struct fifo_stream_stats {
+    /* Number of blocks handed to the application */
+    uint32_t blocks;
+    /* Number of blocks that were overwritten, because the application still processed the previous one */
+    uint32_t overruns;
+    /* Number of frames lost due to overruns */
+    uint32_t framesDropped;
+    /* Number of burst reads of the FIFO data */
+    uint32_t bursts;
+    /* Number of failed transfers */
+    uint32_t errors;
+}fifo_stream_stats_t;
+
+/**
+ * Streams the FIFO of a sensor into a double (ping-pong) buffer. When the watermark interrupt of the sensor fires,
+ * the fill level is read and the FIFO is drained in as few bursts as possible using I2CAsync. Whenever one half of
+ * the buffer is full, it is handed to the application via IsrUtil while the other half is filled.
+ * On bare metal builds the FIFO is drained completely in interrupt context. With an RTOS, I2CAsync starts every
+ * transfer from the main loop (see I2CAsync), so a block is always handed over before the next read starts and a
+ * slow block handler delays the reads instead: the FIFO of the sensor has to hold the samples of the handler's runtime.
+ *
+ * @code
+ * const fifo_stream_config_t MPU6050_FIFO = {MPU6050_ADDRESS, MPU6050_RA_FIFO_COUNTH, MSB_FIRST, 0x1FFF, MPU6050_RA_FIFO_R_W, 12, 0};
+ * uint8_t buffer[2 * 50 * 12];
+ *
+ * FifoStreamReader fifo(&bus, MPU6050_INT, MPU6050_FIFO, buffer, 50);
+ * fifo.onBlock([](const uint8_t * frames, size_t numFrames) {
+ *     // executed in the main loop by IsrUtil
+ * });
+ * fifo.start();
+ * @endcode
+ */
+class FifoStreamReader
+{
+public:
+    /**
+     * Constructor
+     * @param bus the asynchronous I2C bus the sensor is connected to
+     * @param watermarkPin the pin connected to the watermark / data ready interrupt of the sensor
+     * @param config the description of the FIFO
+     * @param buffer buffer for both blocks, must hold 2 * framesPerBlock * config.frameSize bytes
+     * @param framesPerBlock the number of frames handed to the application at once
+     * @param activeHigh true if the interrupt is signalled by a rising edge, false for a falling edge
+     * @param dispatcher the IsrUtil instance the blocks are delivered with
+     */
+    FifoStreamReader(I2CAsync * bus, PinName watermarkPin, const fifo_stream_config_t & config, uint8_t * buffer, size_t framesPerBlock,
+                     bool activeHigh = true, IsrUtil * dispatcher = IsrUtil::global());
+
+    /**
+     * Sets the function that processes full blocks. It is called in the main loop, the block is released when it returns
+     * @param blockHandler the function receiving the frames of a block
+     */
+    void onBlock(Callback<void(const uint8_t * frames, size_t numFrames)> blockHandler) {onBlockHandler = blockHandler;};
+
+    /**
+     * Enables the watermark interrupt and drains the FIFO once
+     */
+    void start();
+
+    /**
+     * Disables the watermark interrupt. A running read is finished
+     */
+    void stop();
+
+    /**
+     * Drains the FIFO, as if the watermark interrupt fired. Can be used to poll sensors without an interrupt pin
+     */
+    void trigger();
+
+    /**
+     * Gets whether the FIFO is currently being read
+     * @return true if a read is in progress
+     */
+    bool isReading() {return reading;};
+
+    /**
+     * Gets the number of frames in the block that is currently filled
+     * @return the number of frames
+     */
+    size_t getFillLevel() {return fill / config.frameSize;};
+
+    /**
+     * Gets the statistics
+     * @return the statistics
+     */
+    const fifo_stream_stats_t & getStats() {return stats;};
+
+    /**
+     * Resets the statistics
+     */
+    void resetStats() {memset(&stats, 0, sizeof(stats));};
+private:
+    I2CAsync * bus;
+    InterruptIn watermark;
+    fifo_stream_config_t config;
+    uint8_t * buffer;
+    size_t blockSize;
+    bool activeHigh;
+    IsrUtil * dispatcher;
+    Callback<void(const uint8_t *, size_t)> onBlockHandler;
+
+    I2CTransaction countTransaction;
+    I2CTransaction dataTransaction;
+    uint8_t countBuffer[2];
+
+    volatile bool reading;
+    volatile bool pendingTrigger;
+    volatile bool running;
+    uint8_t activeBlock;
+    volatile bool blockReady;
+    size_t fill;
+    size_t remaining;
+    size_t burstLength;
+    size_t framesRead;
+    fifo_stream_stats_t stats;
+
+    void onCountRead(I2CTransaction * transaction);
+    void onDataRead(I2CTransaction * transaction);
+    void readNextBurst();
+    void finishRead();
+    void completeBlock();
+    void deliverBlock();
+};
+
+#endif
+
+#endif
@@ -0,0 +1,199 @@
+#include <I2CAsync.h>
+
+#if DEVICE_I2C_ASYNCH
+
+void I2CTransaction::notify() {
+    if (callback) {
+        callback(this);
+    }
+}
+
+I2CAsync::I2CAsync(I2C * i2c, IsrUtil * dispatcher) : i2c(i2c), dispatcher(dispatcher) {
+    head = nullptr;
+    tail = nullptr;
+    active = nullptr;
+    startDeferred = false;
+    numPending = 0;
+    numCompleted = 0;
+    numFailed = 0;
+}
+
+i2c_return_code I2CAsync::read(I2CTransaction * transaction, uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, size_t numBytes, Callback<void(I2CTransaction *)> callback) {
+    if (transaction->isPending()) {
+        return I2C_ERROR;
+    }
+
+    transaction->slaveAddress = slaveAddress;
+    transaction->registerAddress = registerAddress;
+    transaction->txBuffer[0] = registerAddress;
+    transaction->txData = transaction->txBuffer;
+    transaction->txLength = 1;
+    transaction->rxData = data;
+    transaction->rxLength = numBytes;
+
+    return enqueue(transaction, callback);
+}
+
+i2c_return_code I2CAsync::write(I2CTransaction * transaction, uint8_t slaveAddress, uint8_t registerAddress, const uint8_t * data, size_t numBytes, Callback<void(I2CTransaction *)> callback) {
+    if (transaction->isPending() || numBytes > I2C_ASYNC_WRITE_BUFFER_SIZE) {
+        return I2C_ERROR;
+    }
+
+    // register address and data are sent in a single transfer
+    transaction->slaveAddress = slaveAddress;
+    transaction->registerAddress = registerAddress;
+    transaction->txBuffer[0] = registerAddress;
+    memcpy(transaction->txBuffer + 1, data, numBytes);
+    transaction->txData = transaction->txBuffer;
+    transaction->txLength = numBytes + 1;
+    transaction->rxData = nullptr;
+    transaction->rxLength = 0;
+
+    return enqueue(transaction, callback);
+}
+
+i2c_return_code I2CAsync::transfer(I2CTransaction * transaction, uint8_t slaveAddress, const uint8_t * txData, size_t txLength, uint8_t * rxData, size_t rxLength, Callback<void(I2CTransaction *)> callback) {
+    if (transaction->isPending()) {
+        return I2C_ERROR;
+    }
+
+    transaction->slaveAddress = slaveAddress;
+    transaction->registerAddress = txLength > 0 ? txData[0] : 0;
+    transaction->txData = txData;
+    transaction->txLength = txLength;
+    transaction->rxData = rxData;
+    transaction->rxLength = rxLength;
+
+    return enqueue(transaction, callback);
+}
+
+i2c_return_code I2CAsync::enqueue(I2CTransaction * transaction, Callback<void(I2CTransaction *)> callback) {
+    transaction->callback = callback;
+    transaction->event = 0;
+    transaction->next = nullptr;
+    transaction->status = I2C_TRANSACTION_QUEUED;
+
+    core_util_critical_section_enter();
+    if (tail) {
+        tail->next = transaction;
+    } else {
+        head = transaction;
+    }
+    tail = transaction;
+    numPending++;
+
+    bool idle = active == nullptr;
+    core_util_critical_section_exit();
+
+    if (idle) {
+        requestStart();
+    }
+
+    return I2C_OK;
+}
+
+void I2CAsync::requestStart() {
+#if MBED_CONF_RTOS_PRESENT
+    if (core_util_is_isr_active()) {
+        // I2C::transfer() locks the mutex of the bus, which is a fatal error in interrupt context
+        core_util_critical_section_enter();
+        bool post = !startDeferred && head != nullptr;
+        if (post) {
+            startDeferred = true;
+        }
+        core_util_critical_section_exit();
+
+        if (post) {
+            IsrUtil * starter = dispatcher ? dispatcher : IsrUtil::global();
+            // parentheses prevent the expansion of the runLater macro, which would use the global instance
+            (starter->runLater)(callback(this, &I2CAsync::deferredStart));
+        }
+        return;
+    }
+#endif
+
+    startNext();
+}
+
+void I2CAsync::deferredStart() {
+    startDeferred = false;
+    startNext();
+}
+
+void I2CAsync::startNext() {
+    while (true) {
+        // take the next transaction from the queue
+        core_util_critical_section_enter();
+        if (active != nullptr || head == nullptr) {
+            core_util_critical_section_exit();
+            return;
+        }
+
+        I2CTransaction * next = head;
+        head = next->next;
+        if (head == nullptr) {
+            tail = nullptr;
+        }
+        active = next;
+        core_util_critical_section_exit();
+
+        next->status = I2C_TRANSACTION_RUNNING;
+#if MBED_EXT_I2C_STATS
+        activeStart = us_ticker_read();
+#endif
+        int started = i2c->transfer(I2C_ADDR_8BIT(next->slaveAddress), (const char *)next->txData, next->txLength,
+                                    (char *)next->rxData, next->rxLength, callback(this, &I2CAsync::onTransferDone), I2C_EVENT_ALL);
+
+        if (started == 0) {
+            return;
+        }
+
+        // the transfer could not be started, report and continue with the next one
+        active = nullptr;
+        finish(next, I2C_EVENT_ERROR);
+    }
+}
+
+void I2CAsync::onTransferDone(int event) {
+    I2CTransaction * transaction = active;
+    active = nullptr;
+
+    if (transaction) {
+        finish(transaction, event);
+    }
+
+    // keep the bus busy
+    requestStart();
+}
+
+void I2CAsync::finish(I2CTransaction * transaction, int event) {
+    transaction->event = event;
+    if (event & (I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK)) {
+        transaction->status = I2C_TRANSACTION_FAILED;
+        numFailed++;
+    } else {
+        transaction->status = I2C_TRANSACTION_DONE;
+        numCompleted++;
+    }
+
+#if MBED_EXT_I2C_STATS
+    // the register address is not counted as data
+    size_t numBytes = transaction->txLength + transaction->rxLength - (transaction->txLength > 0);
+    i2c_stats_result_t result = !(event & (I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK)) ? I2C_STATS_OK
+                              : (event & (I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK)) ? I2C_STATS_NACK : I2C_STATS_ERROR;
+    I2CStats::record(transaction->slaveAddress, transaction->registerAddress, numBytes, result, us_ticker_read() - activeStart);
+#endif
+
+    core_util_critical_section_enter();
+    numPending--;
+    core_util_critical_section_exit();
+
+    if (transaction->deferred && dispatcher) {
+        // parentheses prevent the expansion of the runLater macro, which would use the global instance
+        (dispatcher->runLater)(callback(transaction, &I2CTransaction::notify));
+    } else {
+        transaction->notify();
+    }
+}
+
+#endif
@@ -0,0 +1,240 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_I2C_ASYNC_H_
+#define _MBED_EXT_I2C_ASYNC_H_
+
+#include <mbed.h>
+#include <I2CUtil.h>
+#include <IsrUtil.h>
+
+#if DEVICE_I2C_ASYNCH
+
+/**
+ * Maximum number of data bytes of a register write that is copied into the transaction
+ */
+#ifndef I2C_ASYNC_WRITE_BUFFER_SIZE
+#define I2C_ASYNC_WRITE_BUFFER_SIZE 16
+#endif
+
+/**
+ * State of an asynchronous I2C transaction
+ */
+typedef enum i2c_transaction_status {
+    /* Not submitted yet */
+    I2C_TRANSACTION_IDLE,
+    /* Waiting in the queue of the bus */
+    I2C_TRANSACTION_QUEUED,
+    /* Currently transferred */
+    I2C_TRANSACTION_RUNNING,
+    /* Finished successfully */
+    I2C_TRANSACTION_DONE,
+    /* Finished with an error, e.g. the slave did not acknowledge */
+    I2C_TRANSACTION_FAILED
+}i2c_transaction_status_t;
+
+class I2CAsync;
+
+/**
+ * A single asynchronous transfer. The transaction object and its data buffers are owned by the caller
+ * and must stay valid until the transaction has finished.
+ */
+class I2CTransaction
+{
+    friend class I2CAsync;
+public:
+    /**
+     * Constructor
+     */
+    I2CTransaction() : status(I2C_TRANSACTION_IDLE), event(0), deferred(true), next(nullptr) {};
+
+    /**
+     * Gets the current state of the transaction
+     * @return the state
+     */
+    i2c_transaction_status_t getStatus() {return status;};
+
+    /**
+     * Gets whether the transaction is queued or running
+     * @return true if the transaction has not finished yet
+     */
+    bool isPending() {return status == I2C_TRANSACTION_QUEUED || status == I2C_TRANSACTION_RUNNING;};
+
+    /**
+     * Gets the result of a finished transaction
+     * @return I2C_OK when the transfer was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code result() {return status == I2C_TRANSACTION_DONE ? I2C_OK : I2C_ERROR;};
+
+    /**
+     * Gets the raw mbed I2C event flags of the finished transfer (I2C_EVENT_*)
+     * @return the event flags
+     */
+    int getEvent() {return event;};
+
+    /**
+     * Sets whether the callback is executed in the main loop via IsrUtil (default) or directly in interrupt context
+     * @param deferToMainLoop true to defer the callback, false to call it from the interrupt
+     */
+    void setDeferred(bool deferToMainLoop) {deferred = deferToMainLoop;};
+
+    /**
+     * The 7-bit address of the slave
+     */
+    uint8_t slaveAddress;
+
+    /**
+     * The register the transaction starts at
+     */
+    uint8_t registerAddress;
+private:
+    volatile i2c_transaction_status_t status;
+    int event;
+    bool deferred;
+    const uint8_t * txData;
+    size_t txLength;
+    uint8_t * rxData;
+    size_t rxLength;
+    uint8_t txBuffer[I2C_ASYNC_WRITE_BUFFER_SIZE + 1];
+    Callback<void(I2CTransaction *)> callback;
+    I2CTransaction * next;
+
+    void notify();
+};
+
+/**
+ * Runs register reads and writes on an I2C bus without blocking the CPU. Transactions are queued and
+ * transferred back to back. On bare metal builds the next transfer is started directly from the completion
+ * interrupt. With an RTOS, I2C::transfer() locks the mutex of the bus, which is not allowed in interrupt context,
+ * so transfers that are queued or become due in interrupt context are started by the dispatcher instead:
+ * the main loop has to execute it (runAllFromIsr()) even if all callbacks are called in interrupt context.
+ * The blocking static methods of I2CUtil can still be used for the same bus as long as no transaction is pending.
+ *
+ * @code
+ * I2CAsync bus(&i2c);
+ * I2CTransaction accelRead;
+ * uint8_t accel[6];
+ *
+ * bus.read(&accelRead, MPU6050_ADDRESS, MPU6050_RA_ACCEL_XOUT_H, accel, 6, [](I2CTransaction * t) {
+ *     // executed in the main loop by IsrUtil
+ * });
+ * @endcode
+ */
+class I2CAsync
+{
+public:
+    /**
+     * Constructor
+     * @param i2c the I2C bus to use
+     * @param dispatcher the IsrUtil instance deferred callbacks and, with an RTOS, transfer starts are queued in.
+     *                   nullptr to always call the callbacks in interrupt context, transfers are then started by IsrUtil::global()
+     */
+    I2CAsync(I2C * i2c, IsrUtil * dispatcher = IsrUtil::global());
+
+    /**
+     * Queues a register read
+     * @param transaction the transaction object to use, must not be pending
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the register to read
+     * @param data pointer to the location the read bytes are stored
+     * @param numBytes the number of bytes to read
+     * @param callback function called when the transaction has finished
+     * @return I2C_OK when the transaction was queued, I2C_ERROR otherwise
+     */
+    i2c_return_code read(I2CTransaction * transaction, uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, size_t numBytes, Callback<void(I2CTransaction *)> callback = nullptr);
+
+    /**
+     * Queues a register write. The data is copied, so the buffer may be reused immediately
+     * @param transaction the transaction object to use, must not be pending
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the register to write
+     * @param data the data to write
+     * @param numBytes the number of bytes to write (at most I2C_ASYNC_WRITE_BUFFER_SIZE)
+     * @param callback function called when the transaction has finished
+     * @return I2C_OK when the transaction was queued, I2C_ERROR otherwise
+     */
+    i2c_return_code write(I2CTransaction * transaction, uint8_t slaveAddress, uint8_t registerAddress, const uint8_t * data, size_t numBytes, Callback<void(I2CTransaction *)> callback = nullptr);
+
+    /**
+     * Queues a raw transfer: txLength bytes are written, followed by a repeated start and rxLength read bytes.
+     * The buffers are not copied
+     * @param transaction the transaction object to use, must not be pending
+     * @param slaveAddress the 7-bit address of the slave
+     * @param txData the bytes to write, usually starting with the register address
+     * @param txLength the number of bytes to write
+     * @param rxData pointer to the location the read bytes are stored
+     * @param rxLength the number of bytes to read
+     * @param callback function called when the transaction has finished
+     * @return I2C_OK when the transaction was queued, I2C_ERROR otherwise
+     */
+    i2c_return_code transfer(I2CTransaction * transaction, uint8_t slaveAddress, const uint8_t * txData, size_t txLength, uint8_t * rxData, size_t rxLength, Callback<void(I2CTransaction *)> callback = nullptr);
+
+    /**
+     * Gets whether a transfer is currently running
+     * @return true if the bus is busy
+     */
+    bool isBusy() {return active != nullptr;};
+
+    /**
+     * Gets the number of transactions that are queued or running
+     * @return the number of pending transactions
+     */
+    int pending() {return numPending;};
+
+    /**
+     * Gets the number of transactions that finished successfully
+     * @return the number of successful transactions
+     */
+    uint32_t getCompletedCount() {return numCompleted;};
+
+    /**
+     * Gets the number of transactions that failed
+     * @return the number of failed transactions
+     */
+    uint32_t getFailedCount() {return numFailed;};
+private:
+    I2C * i2c;
+    IsrUtil * dispatcher;
+    I2CTransaction * head;
+    I2CTransaction * tail;
+    I2CTransaction * volatile active;
+    volatile bool startDeferred;
+    volatile int numPending;
+    uint32_t numCompleted;
+    uint32_t numFailed;
+#if MBED_EXT_I2C_STATS
+    uint32_t activeStart;
+#endif
+
+    i2c_return_code enqueue(I2CTransaction * transaction, Callback<void(I2CTransaction *)> callback);
+    void requestStart();
+    void deferredStart();
+    void startNext();
+    void finish(I2CTransaction * transaction, int event);
+    void onTransferDone(int event);
+};
+
+#endif
+
+#endif
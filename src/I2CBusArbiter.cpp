@@ -0,0 +1,126 @@
+#include <I2CBusArbiter.h>
+
+#if MBED_CONF_RTOS_PRESENT
+
+I2CBusArbiter::I2CBusArbiter(I2C * i2c) : i2c(i2c), busy(false), head(nullptr), queueDepth(0), grantedAt(0) {
+    resetStats();
+}
+
+I2C * I2CBusArbiter::acquire(i2c_priority_t priority) {
+    uint32_t requested = us_ticker_read();
+
+    mutex.lock();
+    if (!busy) {
+        // fast path, the bus is free
+        busy = true;
+        mutex.unlock();
+    } else {
+        // queue behind all waiters with the same or a higher priority
+        waiter self(priority);
+        waiter ** position = &head;
+        while (*position != nullptr && (*position)->priority >= priority) {
+            position = &(*position)->next;
+        }
+        self.next = *position;
+        *position = &self;
+
+        queueDepth++;
+        stats.contended++;
+        if (queueDepth > stats.maxQueueDepth) {
+            stats.maxQueueDepth = queueDepth;
+        }
+        mutex.unlock();
+
+        // the bus is handed over by release(), busy stays set
+        self.granted.acquire();
+    }
+
+    // only the holder of the bus updates the statistics
+    grantedAt = us_ticker_read();
+    uint32_t waited = grantedAt - requested;
+    stats.totalWaitUs += waited;
+    if (waited > stats.maxWaitUs) {
+        stats.maxWaitUs = waited;
+    }
+
+    return i2c;
+}
+
+void I2CBusArbiter::release() {
+    stats.accesses++;
+    stats.busyUs += us_ticker_read() - grantedAt;
+
+    mutex.lock();
+    waiter * next = head;
+    if (next != nullptr) {
+        head = next->next;
+        queueDepth--;
+    } else {
+        busy = false;
+    }
+    mutex.unlock();
+
+    if (next != nullptr) {
+        next->granted.release();
+    }
+}
+
+i2c_return_code I2CBusArbiter::readByte(uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, i2c_priority_t priority) {
+    return readBytes(slaveAddress, registerAddress, data, 1, priority);
+}
+
+i2c_return_code I2CBusArbiter::writeByte(uint8_t slaveAddress, uint8_t registerAddress, uint8_t data, i2c_priority_t priority) {
+    return writeBytes(slaveAddress, registerAddress, &data, 1, priority);
+}
+
+i2c_return_code I2CBusArbiter::readBytes(uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, size_t numBytes, i2c_priority_t priority) {
+    I2C * bus = acquire(priority);
+    i2c_return_code result = I2CUtil::readBytes(bus, slaveAddress, registerAddress, data, numBytes);
+    release();
+
+    return result;
+}
+
+i2c_return_code I2CBusArbiter::writeBytes(uint8_t slaveAddress, uint8_t registerAddress, const uint8_t * data, size_t numBytes, i2c_priority_t priority) {
+    I2C * bus = acquire(priority);
+    i2c_return_code result = I2CUtil::writeBytes(bus, slaveAddress, registerAddress, data, numBytes);
+    release();
+
+    return result;
+}
+
+i2c_return_code I2CBusArbiter::readInt16s(uint8_t slaveAddress, uint8_t registerAddress, int16_t * data, size_t count, byte_order_t order, i2c_priority_t priority) {
+    I2C * bus = acquire(priority);
+    i2c_return_code result = I2CUtil::readInt16s(bus, slaveAddress, registerAddress, data, count, order);
+    release();
+
+    return result;
+}
+
+i2c_return_code I2CBusArbiter::writeBits(uint8_t slaveAddress, uint8_t registerAddress, uint8_t registerMask, uint8_t data, i2c_priority_t priority) {
+    I2C * bus = acquire(priority);
+    i2c_return_code result = I2CUtil::writeBits(bus, slaveAddress, registerAddress, registerMask, data);
+    release();
+
+    return result;
+}
+
+i2c_return_code I2CBusArbiter::execute(Callback<i2c_return_code(I2C *)> sequence, i2c_priority_t priority) {
+    I2C * bus = acquire(priority);
+    i2c_return_code result = sequence(bus);
+    release();
+
+    return result;
+}
+
+float I2CBusArbiter::getUtilization() {
+    uint32_t elapsed = us_ticker_read() - statsStart;
+    return elapsed > 0 ? (float)stats.busyUs / elapsed : 0.0f;
+}
+
+void I2CBusArbiter::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+    statsStart = us_ticker_read();
+}
+
+#endif
@@ -0,0 +1,223 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_I2C_BUS_ARBITER_H_
+#define _MBED_EXT_I2C_BUS_ARBITER_H_
+
+#include <mbed.h>
+#include <I2CUtil.h>
+
+#if MBED_CONF_RTOS_PRESENT
+
+/**
+ * Priority of a bus access. Waiting accesses with a higher priority are served first,
+ * accesses with the same priority in the order they were requested
+ */
+typedef enum i2c_priority {
+    I2C_PRIORITY_LOW = 0,
+    I2C_PRIORITY_NORMAL = 1,
+    I2C_PRIORITY_HIGH = 2,
+    I2C_PRIORITY_REALTIME = 3
+}i2c_priority_t;
+
+/**
+ * Usage statistics of a bus
+ */
+typedef struct i2c_arbiter_stats {
+    /* Number of atomic accesses */
+    uint32_t accesses;
+    /* Number of accesses that had to wait for another thread */
+    uint32_t contended;
+    /* Time the bus was held in us */
+    uint64_t busyUs;
+    /* Sum of the waiting times of all accesses in us */
+    uint64_t totalWaitUs;
+    /* Longest waiting time in us */
+    uint32_t maxWaitUs;
+    /* Largest number of threads waiting at the same time */
+    uint32_t maxQueueDepth;
+}i2c_arbiter_stats_t;
+
+/**
+ * Shares an I2C bus between threads. Every access is atomic, so a register select and the following read
+ * can not be interleaved with an access of another thread. While the bus is in use, other threads wait in a
+ * queue ordered by priority and the bus is handed directly to the next one when the access is finished.
+ * The accesses are executed by the calling thread, so no additional thread or stack is needed.
+ *
+ * Once a bus is shared, all accesses have to go through the arbiter. The methods must not be called from
+ * interrupt context.
+ *
+ * @code
+ * I2CBusArbiter bus(&i2c);
+ *
+ * // any thread
+ * bus.readBytes(MPU6050_ADDRESS, MPU6050_RA_ACCEL_XOUT_H, data, 6, I2C_PRIORITY_HIGH);
+ * @endcode
+ */
+class I2CBusArbiter
+{
+public:
+    /**
+     * Constructor
+     * @param i2c the bus that is shared
+     */
+    I2CBusArbiter(I2C * i2c);
+
+    /**
+     * Atomically reads a single byte, see I2CUtil::readByte
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the register to read
+     * @param data pointer to the location the read byte is stored
+     * @param priority the priority of the access
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code readByte(uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, i2c_priority_t priority = I2C_PRIORITY_NORMAL);
+
+    /**
+     * Atomically writes a single byte, see I2CUtil::writeByte
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the register to write
+     * @param data the byte to write
+     * @param priority the priority of the access
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code writeByte(uint8_t slaveAddress, uint8_t registerAddress, uint8_t data, i2c_priority_t priority = I2C_PRIORITY_NORMAL);
+
+    /**
+     * Atomically reads multiple bytes, see I2CUtil::readBytes
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the first register to read
+     * @param data pointer to the location the read bytes are stored
+     * @param numBytes the number of bytes to read
+     * @param priority the priority of the access
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code readBytes(uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, size_t numBytes, i2c_priority_t priority = I2C_PRIORITY_NORMAL);
+
+    /**
+     * Atomically writes multiple bytes, see I2CUtil::writeBytes
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the first register to write
+     * @param data the data to write
+     * @param numBytes the number of bytes to write
+     * @param priority the priority of the access
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code writeBytes(uint8_t slaveAddress, uint8_t registerAddress, const uint8_t * data, size_t numBytes, i2c_priority_t priority = I2C_PRIORITY_NORMAL);
+
+    /**
+     * Atomically reads multiple 16-bit values, see I2CUtil::readInt16s
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the first register to read
+     * @param data pointer to the location the read values are stored
+     * @param count the number of 16-bit values to read
+     * @param order the byte order in which the device transmits the values
+     * @param priority the priority of the access
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code readInt16s(uint8_t slaveAddress, uint8_t registerAddress, int16_t * data, size_t count, byte_order_t order = MSB_FIRST, i2c_priority_t priority = I2C_PRIORITY_NORMAL);
+
+    /**
+     * Atomically writes bits of a register. No other thread can access the bus between the read and the write
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the register to write
+     * @param registerMask the bits to write
+     * @param data the value of the bits
+     * @param priority the priority of the access
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code writeBits(uint8_t slaveAddress, uint8_t registerAddress, uint8_t registerMask, uint8_t data, i2c_priority_t priority = I2C_PRIORITY_NORMAL);
+
+    /**
+     * Atomically executes an arbitrary sequence of transfers. The sequence must use the passed bus and
+     * must not call methods of the arbiter
+     * @param sequence the function executing the transfers
+     * @param priority the priority of the access
+     * @return the result of the sequence
+     */
+    i2c_return_code execute(Callback<i2c_return_code(I2C *)> sequence, i2c_priority_t priority = I2C_PRIORITY_NORMAL);
+
+    /**
+     * Waits until the bus is available and reserves it for the calling thread. Every acquire() must be
+     * followed by a release(), prefer the other methods where possible
+     * @param priority the priority of the access
+     * @return the bus to use until release() is called
+     */
+    I2C * acquire(i2c_priority_t priority = I2C_PRIORITY_NORMAL);
+
+    /**
+     * Releases the bus and hands it to the next waiting thread
+     */
+    void release();
+
+    /**
+     * Gets the number of threads currently waiting for the bus
+     * @return the number of waiting threads
+     */
+    uint32_t getQueueDepth() {return queueDepth;};
+
+    /**
+     * Gets the usage statistics
+     * @return the statistics
+     */
+    const i2c_arbiter_stats_t & getStats() {return stats;};
+
+    /**
+     * Gets the fraction of time the bus was held since the last reset of the statistics
+     * @return the utilization between 0 and 1
+     */
+    float getUtilization();
+
+    /**
+     * Gets the average time an access waited for the bus
+     * @return the average waiting time in us
+     */
+    uint32_t getAverageWaitUs() {return stats.accesses > 0 ? stats.totalWaitUs / stats.accesses : 0;};
+
+    /**
+     * Resets the statistics
+     */
+    void resetStats();
+private:
+    struct waiter {
+        i2c_priority_t priority;
+        rtos::Semaphore granted;
+        waiter * next;
+
+        waiter(i2c_priority_t priority) : priority(priority), granted(0, 1), next(nullptr) {};
+    };
+
+    I2C * i2c;
+    rtos::Mutex mutex;
+    bool busy;
+    waiter * head;
+    uint32_t queueDepth;
+    uint32_t grantedAt;
+    uint32_t statsStart;
+    i2c_arbiter_stats_t stats;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,130 @@
+#include <I2CDeviceRegistry.h>
+
+I2CDeviceRegistry::I2CDeviceRegistry(I2C * i2c, IsrUtil * dispatcher) : i2c(i2c), dispatcher(dispatcher) {
+    dispatchPending = false;
+    firstAddress = 0x08;
+    lastAddress = 0x77;
+    probesPerPoll = DEFAULT_REGISTRY_PROBES_PER_POLL;
+    checkInterval = DEFAULT_REGISTRY_CHECK_INTERVAL;
+    rescanInterval = DEFAULT_REGISTRY_RESCAN_INTERVAL;
+
+    checkCursor = 128;
+    checkActive = false;
+    lastCheck = 0;
+    scanCursor = firstAddress;
+    scanActive = true;
+    scanComplete = false;
+    lastScan = 0;
+    numProbes = 0;
+
+    timer.start();
+}
+
+void I2CDeviceRegistry::registerDevice(uint8_t address) {
+    if (address >= 128) {
+        return;
+    }
+
+    registered.set(address);
+
+    // check the new device with the next poll
+    if (!checkActive) {
+        checkActive = true;
+        checkCursor = registered.findFirst();
+    } else if (address < checkCursor) {
+        checkCursor = address;
+    }
+}
+
+void I2CDeviceRegistry::unregisterDevice(uint8_t address) {
+    if (address < 128) {
+        registered.reset(address);
+    }
+}
+
+void I2CDeviceRegistry::setScanRange(uint8_t firstAddress, uint8_t lastAddress) {
+    this->firstAddress = firstAddress;
+    this->lastAddress = lastAddress < 128 ? lastAddress : 127;
+    scanCursor = firstAddress;
+}
+
+void I2CDeviceRegistry::poll() {
+    uint32_t now = timer.read_ms();
+    uint8_t budget = probesPerPoll;
+
+    // registered devices first, they are what the application waits for
+    if (!checkActive && now - lastCheck >= checkInterval) {
+        checkActive = true;
+        checkCursor = registered.findFirst();
+    }
+
+    while (checkActive && budget > 0) {
+        if (checkCursor >= 128) {
+            // all registered devices checked
+            checkActive = false;
+            lastCheck = now;
+            break;
+        }
+
+        probe(checkCursor);
+        budget--;
+        checkCursor = registered.findNext(checkCursor);
+    }
+
+    // the background scan uses the remaining probes
+    if (!scanActive && rescanInterval > 0 && now - lastScan >= rescanInterval) {
+        scanActive = true;
+        scanCursor = firstAddress;
+    }
+
+    while (scanActive && budget > 0) {
+        if (scanCursor > lastAddress) {
+            scanActive = false;
+            scanComplete = true;
+            lastScan = now;
+            break;
+        }
+
+        // registered devices are covered by the checks
+        if (!registered.test(scanCursor)) {
+            probe(scanCursor);
+            budget--;
+        }
+        scanCursor++;
+    }
+}
+
+void I2CDeviceRegistry::probe(uint8_t address) {
+    numProbes++;
+    bool responded = I2CUtil::probeAddress(i2c, address);
+
+    if (responded == present.test(address)) {
+        return;
+    }
+
+    present.set(address, responded);
+    changed.set(address);
+
+    // all changes found until the dispatcher runs are reported at once
+    if (!dispatchPending) {
+        dispatchPending = true;
+        if (dispatcher) {
+            // parentheses prevent the expansion of the runLater macro, which would use the global instance
+            (dispatcher->runLater)(callback(this, &I2CDeviceRegistry::dispatchChanges));
+        } else {
+            dispatchChanges();
+        }
+    }
+}
+
+void I2CDeviceRegistry::dispatchChanges() {
+    Bitset<128> pending = changed;
+    changed.resetAll();
+    dispatchPending = false;
+
+    if (onChangeHandler) {
+        for (size_t address : pending) {
+            onChangeHandler(address, present.test(address));
+        }
+    }
+}
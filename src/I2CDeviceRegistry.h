@@ -0,0 +1,168 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_I2C_DEVICE_REGISTRY_H_
+#define _MBED_EXT_I2C_DEVICE_REGISTRY_H_
+
+#include <mbed.h>
+#include <I2CUtil.h>
+#include <IsrUtil.h>
+#include <Bitset.h>
+
+#define DEFAULT_REGISTRY_PROBES_PER_POLL 4
+#define DEFAULT_REGISTRY_CHECK_INTERVAL 1000
+#define DEFAULT_REGISTRY_RESCAN_INTERVAL 5000
+
+/**
+ * Keeps track of the devices on an I2C bus without blocking the bus. Instead of probing all addresses at once,
+ * poll() is called in the main loop and probes a few addresses per call. Registered devices, i.e. the ones the
+ * application expects, are probed first and then checked periodically; the background scan only probes the other
+ * addresses to find hot-plugged devices. Changes of the presence of a device are reported via IsrUtil.
+ *
+ * @code
+ * I2CDeviceRegistry registry(&i2c);
+ * registry.registerDevice(MPU6050_ADDRESS);
+ * registry.onChange([](uint8_t address, bool present) {
+ *     serial.printf("0x%02X %s\n", address, present ? "connected" : "removed");
+ * });
+ *
+ * while (true) {
+ *     registry.poll();
+ *     runAllFromIsr();
+ * }
+ * @endcode
+ */
+class I2CDeviceRegistry
+{
+public:
+    /**
+     * Constructor
+     * @param i2c the bus to scan
+     * @param dispatcher the IsrUtil instance the change events are delivered with
+     */
+    I2CDeviceRegistry(I2C * i2c, IsrUtil * dispatcher = IsrUtil::global());
+
+    /**
+     * Registers a device that is checked periodically. Its presence is checked with the next poll()
+     * @param address the 7-bit address of the device
+     */
+    void registerDevice(uint8_t address);
+
+    /**
+     * Unregisters a device, it is then only found by the background scan
+     * @param address the 7-bit address of the device
+     */
+    void unregisterDevice(uint8_t address);
+
+    /**
+     * Sets the function that is called when a device is connected or removed
+     * @param changeHandler the function receiving the address and the new state
+     */
+    void onChange(Callback<void(uint8_t address, bool present)> changeHandler) {onChangeHandler = changeHandler;};
+
+    /**
+     * Sets the range of addresses of the background scan. The default are the non-reserved addresses 0x08 - 0x77
+     * @param firstAddress the first address to probe
+     * @param lastAddress the last address to probe
+     */
+    void setScanRange(uint8_t firstAddress, uint8_t lastAddress);
+
+    /**
+     * Sets the maximum number of addresses probed per poll()
+     * @param probes the number of probes
+     */
+    void setProbesPerPoll(uint8_t probes) {probesPerPoll = probes;};
+
+    /**
+     * Sets how often the registered devices are checked
+     * @param ms the interval in milliseconds
+     */
+    void setCheckInterval(uint32_t ms) {checkInterval = ms;};
+
+    /**
+     * Sets how long the background scan pauses between two passes over all addresses
+     * @param ms the interval in milliseconds, 0 to scan only once
+     */
+    void setRescanInterval(uint32_t ms) {rescanInterval = ms;};
+
+    /**
+     * Probes the next addresses. Call this method in the main loop
+     */
+    void poll();
+
+    /**
+     * Gets whether a device is present
+     * @param address the 7-bit address of the device
+     * @return true if the device responded to the last probe
+     */
+    bool isPresent(uint8_t address) {return address < 128 && present.test(address);};
+
+    /**
+     * Gets all present devices
+     * @return the set of addresses that responded
+     */
+    const Bitset<128> & getPresent() {return present;};
+
+    /**
+     * Gets whether all addresses were probed at least once
+     * @return true after the first pass of the background scan
+     */
+    bool isScanComplete() {return scanComplete;};
+
+    /**
+     * Gets the number of probes sent
+     * @return the number of probes
+     */
+    uint32_t getProbeCount() {return numProbes;};
+private:
+    I2C * i2c;
+    IsrUtil * dispatcher;
+    Callback<void(uint8_t, bool)> onChangeHandler;
+    LowPowerTimer timer;
+
+    Bitset<128> registered;
+    Bitset<128> present;
+    Bitset<128> changed;
+    bool dispatchPending;
+
+    uint8_t firstAddress;
+    uint8_t lastAddress;
+    uint8_t probesPerPoll;
+    uint32_t checkInterval;
+    uint32_t rescanInterval;
+
+    size_t checkCursor;
+    bool checkActive;
+    uint32_t lastCheck;
+    size_t scanCursor;
+    bool scanActive;
+    bool scanComplete;
+    uint32_t lastScan;
+    uint32_t numProbes;
+
+    void probe(uint8_t address);
+    void dispatchChanges();
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include <I2CPoller.h>
+
+#if DEVICE_I2C_ASYNCH
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+I2CPoller::I2CPoller(I2CAsync * bus) : bus(bus), numSensors(0), tickUs(0), running(false) {
+}
+
+int I2CPoller::addSensor(uint8_t slaveAddress, uint8_t registerAddress, uint8_t numBytes, uint16_t rateHz, RingBuffer<i2c_poll_sample_t> * queue) {
+    if (running || numSensors >= I2C_POLL_MAX_SENSORS || numBytes == 0 || numBytes > I2C_POLL_MAX_BYTES || rateHz == 0) {
+        return -1;
+    }
+
+    sensor & s = sensors[numSensors];
+    s.slaveAddress = slaveAddress;
+    s.registerAddress = registerAddress;
+    s.numBytes = numBytes;
+    s.requestedPeriodUs = 1000000 / rateHz;
+    s.queue = queue;
+    memset(&s.stats, 0, sizeof(s.stats));
+
+    // samples are handled in interrupt context
+    s.transaction.setDeferred(false);
+
+    return numSensors++;
+}
+
+bool I2CPoller::start() {
+    if (numSensors == 0) {
+        return false;
+    }
+
+    stop();
+    computeSchedule();
+
+    running = true;
+    ticker.attach_us(callback(this, &I2CPoller::onTick), tickUs);
+
+    return true;
+}
+
+void I2CPoller::stop() {
+    ticker.detach();
+    running = false;
+}
+
+void I2CPoller::computeSchedule() {
+    // the tick is the greatest common divisor of all periods, so all of them are exact, unless it gets too short
+    uint32_t divisor = 0;
+    for (uint8_t i = 0; i < numSensors; i++) {
+        divisor = gcd(divisor, sensors[i].requestedPeriodUs);
+    }
+    tickUs = divisor < I2C_POLL_MIN_TICK_US ? I2C_POLL_MIN_TICK_US : divisor;
+
+    uint8_t order[I2C_POLL_MAX_SENSORS];
+    for (uint8_t i = 0; i < numSensors; i++) {
+        sensor & s = sensors[i];
+        s.periodTicks = (s.requestedPeriodUs + tickUs / 2) / tickUs;
+        if (s.periodTicks == 0) {
+            s.periodTicks = 1;
+        }
+
+        // sort by period, sensors with short periods have the fewest choices and are placed first
+        uint8_t j = i;
+        while (j > 0 && sensors[order[j - 1]].periodTicks > s.periodTicks) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    for (uint8_t i = 0; i < numSensors; i++) {
+        sensor & s = sensors[order[i]];
+        uint32_t bestPhase = 0;
+        uint32_t bestCost = UINT32_MAX;
+
+        for (uint32_t phase = 0; phase < s.periodTicks && bestCost > 0; phase++) {
+            // two sensors fall into the same ticks if their phases are equal modulo the gcd of their periods
+            uint32_t cost = 0;
+            for (uint8_t j = 0; j < i; j++) {
+                sensor & placed = sensors[order[j]];
+                uint32_t common = gcd(s.periodTicks, placed.periodTicks);
+                if (phase % common == placed.phaseTicks % common) {
+                    // bytes on the bus: address, register, address and data
+                    cost += placed.numBytes + 3;
+                }
+            }
+
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestPhase = phase;
+            }
+        }
+
+        s.phaseTicks = bestPhase;
+        s.countdown = bestPhase;
+    }
+}
+
+void I2CPoller::onTick() {
+    for (uint8_t i = 0; i < numSensors; i++) {
+        sensor & s = sensors[i];
+
+        if (s.countdown > 0) {
+            s.countdown--;
+            continue;
+        }
+        s.countdown = s.periodTicks - 1;
+
+        if (s.transaction.isPending()) {
+            // the bus can not keep up
+            s.stats.skipped++;
+            continue;
+        }
+
+        // all reads due in this tick are queued back to back
+        if (bus->read(&s.transaction, s.slaveAddress, s.registerAddress, s.data, s.numBytes, callback(this, &I2CPoller::onRead)) != I2C_OK) {
+            s.stats.errors++;
+        }
+    }
+}
+
+void I2CPoller::onRead(I2CTransaction * transaction) {
+    uint32_t now = us_ticker_read();
+
+    uint8_t id = 0;
+    while (id < numSensors && &sensors[id].transaction != transaction) {
+        id++;
+    }
+    if (id == numSensors) {
+        return;
+    }
+
+    sensor & s = sensors[id];
+    if (transaction->result() != I2C_OK) {
+        s.stats.errors++;
+        return;
+    }
+
+    if (s.stats.samples > 0) {
+        int32_t deviation = (int32_t)(now - s.stats.lastTimestamp) - (int32_t)(s.periodTicks * tickUs);
+        uint32_t jitter = deviation < 0 ? -deviation : deviation;
+
+        s.stats.sumJitterUs += jitter;
+        if (jitter > s.stats.maxJitterUs) {
+            s.stats.maxJitterUs = jitter;
+        }
+    } else {
+        s.stats.firstTimestamp = now;
+    }
+    s.stats.samples++;
+    s.stats.lastTimestamp = now;
+
+    i2c_poll_sample_t sample;
+    sample.timestamp = now;
+    sample.sensor = id;
+    sample.length = s.numBytes;
+    memcpy(sample.data, s.data, s.numBytes);
+
+    if (!s.queue->push(sample)) {
+        s.stats.dropped++;
+    }
+}
+
+float I2CPoller::getAchievedRate(int sensor) {
+    const i2c_poll_stats_t & stats = sensors[sensor].stats;
+    uint32_t elapsed = stats.lastTimestamp - stats.firstTimestamp;
+
+    return stats.samples > 1 && elapsed > 0 ? (stats.samples - 1) * 1000000.0f / elapsed : 0.0f;
+}
+
+uint32_t I2CPoller::getMeanJitterUs(int sensor) {
+    const i2c_poll_stats_t & stats = sensors[sensor].stats;
+    return stats.samples > 1 ? stats.sumJitterUs / (stats.samples - 1) : 0;
+}
+
+void I2CPoller::resetStats() {
+    core_util_critical_section_enter();
+    for (uint8_t i = 0; i < numSensors; i++) {
+        memset(&sensors[i].stats, 0, sizeof(i2c_poll_stats_t));
+    }
+    core_util_critical_section_exit();
+}
+
+#endif
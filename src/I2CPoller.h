@@ -0,0 +1,215 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_I2C_POLLER_H_
+#define _MBED_EXT_I2C_POLLER_H_
+
+#include <mbed.h>
+#include <I2CAsync.h>
+#include <RingBuffer.h>
+
+#if DEVICE_I2C_ASYNCH
+
+/**
+ * Maximum number of sensors of a poller
+ */
+#ifndef I2C_POLL_MAX_SENSORS
+#define I2C_POLL_MAX_SENSORS 16
+#endif
+
+/**
+ * Maximum number of bytes read per sample
+ */
+#ifndef I2C_POLL_MAX_BYTES
+#define I2C_POLL_MAX_BYTES 14
+#endif
+
+/**
+ * Shortest period of the scheduler tick in us. Periods that are no multiple of the tick are rounded
+ */
+#ifndef I2C_POLL_MIN_TICK_US
+#define I2C_POLL_MIN_TICK_US 250
+#endif
+
+/**
+ * A sample read by the poller
+ */
+typedef struct i2c_poll_sample {
+    /* Time the read finished, in us (us_ticker_read()) */
+    uint32_t timestamp;
+    /* Id of the sensor, as returned by I2CPoller::addSensor */
+    uint8_t sensor;
+    /* Number of valid bytes in data */
+    uint8_t length;
+    /* The register values */
+    uint8_t data[I2C_POLL_MAX_BYTES];
+}i2c_poll_sample_t;
+
+/**
+ * Statistics of a polled sensor
+ */
+typedef struct i2c_poll_stats {
+    /* Number of samples read */
+    uint32_t samples;
+    /* Number of reads that were skipped, because the previous read of the sensor was not finished */
+    uint32_t skipped;
+    /* Number of failed reads */
+    uint32_t errors;
+    /* Number of samples lost, because the queue of the consumer was full */
+    uint32_t dropped;
+    /* Timestamp of the first and the last sample */
+    uint32_t firstTimestamp;
+    uint32_t lastTimestamp;
+    /* Largest deviation of the time between two samples from the period in us */
+    uint32_t maxJitterUs;
+    /* Sum of the deviations of the time between two samples from the period in us */
+    uint64_t sumJitterUs;
+}i2c_poll_stats_t;
+
+/**
+ * Polls multiple sensors at different rates using a single Ticker. All periods are multiples of a common tick,
+ * and every sensor gets a phase offset inside its period, so reads of different sensors fall into different
+ * ticks whenever possible. Reads that are due in the same tick are queued back to back on the bus using I2CAsync.
+ * The samples are pushed into a RingBuffer of the consumer directly from interrupt context. With an RTOS, I2CAsync
+ * starts the reads from the main loop, so the latency of the main loop until it executes IsrUtil adds to the jitter.
+ *
+ * @code
+ * StaticRingBuffer<i2c_poll_sample_t, 16> accelSamples;
+ * I2CPoller poller(&bus);
+ *
+ * int accel = poller.addSensor(MPU6050_ADDRESS, MPU6050_RA_ACCEL_XOUT_H, 6, 400, &accelSamples);
+ * poller.start();
+ *
+ * i2c_poll_sample_t sample;
+ * while (accelSamples.pop(&sample)) {
+ *     // process
+ * }
+ * @endcode
+ */
+class I2CPoller
+{
+public:
+    /**
+     * Constructor
+     * @param bus the asynchronous bus the sensors are connected to
+     */
+    I2CPoller(I2CAsync * bus);
+
+    /**
+     * Registers a sensor. Sensors can only be added while the poller is stopped
+     * @param slaveAddress the 7-bit address of the sensor
+     * @param registerAddress the first register to read
+     * @param numBytes the number of bytes to read (at most I2C_POLL_MAX_BYTES)
+     * @param rateHz the number of reads per second
+     * @param queue the queue the samples are pushed to, may be shared by multiple sensors
+     * @return the id of the sensor or -1 if no sensor can be added
+     */
+    int addSensor(uint8_t slaveAddress, uint8_t registerAddress, uint8_t numBytes, uint16_t rateHz, RingBuffer<i2c_poll_sample_t> * queue);
+
+    /**
+     * Computes the schedule and starts polling
+     * @return true if polling was started, false if no sensor was added
+     */
+    bool start();
+
+    /**
+     * Stops polling. Reads that are already queued are finished
+     */
+    void stop();
+
+    /**
+     * Gets the period of the scheduler tick, valid after start()
+     * @return the tick in us
+     */
+    uint32_t getTickUs() {return tickUs;};
+
+    /**
+     * Gets the scheduled period of a sensor, which may differ from the requested one due to the tick
+     * @param sensor the id of the sensor
+     * @return the period in us
+     */
+    uint32_t getPeriodUs(int sensor) {return sensors[sensor].periodTicks * tickUs;};
+
+    /**
+     * Gets the phase offset of a sensor inside its period
+     * @param sensor the id of the sensor
+     * @return the offset in us
+     */
+    uint32_t getPhaseUs(int sensor) {return sensors[sensor].phaseTicks * tickUs;};
+
+    /**
+     * Gets the statistics of a sensor
+     * @param sensor the id of the sensor
+     * @return the statistics
+     */
+    const i2c_poll_stats_t & getStats(int sensor) {return sensors[sensor].stats;};
+
+    /**
+     * Gets the achieved sample rate of a sensor
+     * @param sensor the id of the sensor
+     * @return the number of samples per second
+     */
+    float getAchievedRate(int sensor);
+
+    /**
+     * Gets the average deviation of the time between two samples from the period
+     * @param sensor the id of the sensor
+     * @return the jitter in us
+     */
+    uint32_t getMeanJitterUs(int sensor);
+
+    /**
+     * Resets the statistics of all sensors
+     */
+    void resetStats();
+private:
+    struct sensor {
+        I2CTransaction transaction;
+        uint8_t slaveAddress;
+        uint8_t registerAddress;
+        uint8_t numBytes;
+        uint32_t requestedPeriodUs;
+        uint32_t periodTicks;
+        uint32_t phaseTicks;
+        uint32_t countdown;
+        RingBuffer<i2c_poll_sample_t> * queue;
+        uint8_t data[I2C_POLL_MAX_BYTES];
+        i2c_poll_stats_t stats;
+    };
+
+    I2CAsync * bus;
+    Ticker ticker;
+    sensor sensors[I2C_POLL_MAX_SENSORS];
+    uint8_t numSensors;
+    uint32_t tickUs;
+    bool running;
+
+    void computeSchedule();
+    void onTick();
+    void onRead(I2CTransaction * transaction);
+};
+
+#endif
+
+#endif
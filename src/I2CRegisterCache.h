@@ -0,0 +1,409 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_I2C_REGISTER_CACHE_H_
+#define _MBED_EXT_I2C_REGISTER_CACHE_H_
+
+#include <mbed.h>
+#include <I2CUtil.h>
+#include <Bitset.h>
+
+/**
+ * When register writes reach the device
+ */
+typedef enum i2c_cache_write_policy {
+    /* Every write is sent to the device immediately, unless the register already holds the value */
+    WRITE_THROUGH,
+    /* Writes to cacheable registers are only stored in the cache and sent on flush() */
+    WRITE_BACK
+}i2c_cache_write_policy_t;
+
+/**
+ * Bus usage counters of a register cache
+ */
+typedef struct i2c_cache_stats {
+    /* Number of register reads sent to the device */
+    uint32_t busReads;
+    /* Number of register writes sent to the device */
+    uint32_t busWrites;
+    /* Number of data bytes transferred, excluding address and register bytes */
+    uint32_t busBytes;
+    /* Number of reads served from the cache */
+    uint32_t cacheHits;
+    /* Number of writes that did not need a bus transfer */
+    uint32_t writesSaved;
+}i2c_cache_stats_t;
+
+template<size_t NumRegisters = 128>
+/**
+ * Keeps a shadow copy of the registers of a single I2C device, so bit manipulations do not need to read
+ * the register first and unchanged values are not written again.
+ *
+ * Only registers marked as cacheable are cached. Registers that may change on the device side, e.g. status
+ * or data registers, must not be marked as cacheable. Registers with an address of NumRegisters or above
+ * are never cached.
+ *
+ * @code
+ * I2CRegisterCache<> mpu(&i2c, MPU6050_ADDRESS);
+ * mpu.setCacheableRange(MPU6050_RA_SMPLRT_DIV, MPU6050_RA_ACCEL_CONFIG);
+ * mpu.writeBits(MPU6050_RA_GYRO_CONFIG, 0x18, 0x08); // one read, one write
+ * mpu.writeBit(MPU6050_RA_GYRO_CONFIG, 7, true);    // one write
+ * @endcode
+ */
+class I2CRegisterCache
+{
+public:
+    /**
+     * Constructor. Initially no register is cacheable
+     * @param i2c the I2C device to use
+     * @param slaveAddress the 7-bit address of the slave
+     * @param policy when writes are sent to the device
+     */
+    I2CRegisterCache(I2C * i2c, uint8_t slaveAddress, i2c_cache_write_policy_t policy = WRITE_THROUGH) : i2c(i2c), slaveAddress(slaveAddress), policy(policy) {
+        burstWrites = false;
+        resetStats();
+    };
+
+    /**
+     * Sets whether a register may be cached
+     * @param registerAddress the address of the register
+     * @param cacheable true if the register only changes when written by the host
+     */
+    void setCacheable(uint8_t registerAddress, bool cacheable = true) {
+        if (registerAddress >= NumRegisters) {
+            return;
+        }
+
+        cached.set(registerAddress, cacheable);
+        if (!cacheable) {
+            valid.reset(registerAddress);
+            dirty.reset(registerAddress);
+        }
+    };
+
+    /**
+     * Marks a range of registers as cacheable
+     * @param firstRegister the address of the first register
+     * @param lastRegister the address of the last register (inclusive)
+     */
+    void setCacheableRange(uint8_t firstRegister, uint8_t lastRegister) {
+        for (uint16_t reg = firstRegister; reg <= lastRegister; reg++) {
+            setCacheable(reg, true);
+        }
+    };
+
+    /**
+     * Stores the value of a cacheable register without accessing the bus, e.g. the reset value of
+     * a register or the value of a write-only register
+     * @param registerAddress the address of the register
+     * @param value the current value of the register on the device
+     */
+    void setKnownValue(uint8_t registerAddress, uint8_t value) {
+        if (isCacheable(registerAddress)) {
+            values[registerAddress] = value;
+            valid.set(registerAddress);
+        }
+    };
+
+    /**
+     * Gets the value of a register if it is cached, without accessing the bus
+     * @param registerAddress the address of the register
+     * @param value pointer to the location the value is stored, only modified if the value is known
+     * @return true if the value is known, false otherwise
+     */
+    bool getKnownValue(uint8_t registerAddress, uint8_t * value) {
+        if (!isCacheable(registerAddress) || !valid.test(registerAddress)) {
+            return false;
+        }
+
+        *value = values[registerAddress];
+        return true;
+    };
+
+    /**
+     * Sets whether flush() may write consecutive dirty registers in a single burst. Only enable this if
+     * the device increments the register address automatically
+     * @param enabled true to combine writes to consecutive registers
+     */
+    void setBurstWrites(bool enabled) {burstWrites = enabled;};
+
+    /**
+     * Gets whether a register is cached
+     * @param registerAddress the address of the register
+     * @return true if the register is cacheable
+     */
+    bool isCacheable(uint8_t registerAddress) {
+        return registerAddress < NumRegisters && cached.test(registerAddress);
+    };
+
+    /**
+     * Reads a single byte. Served from the cache if the value is known
+     * @param registerAddress the address of the register to read
+     * @param data pointer to the location the read byte is stored
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code readByte(uint8_t registerAddress, uint8_t * data) {
+        if (isCacheable(registerAddress) && valid.test(registerAddress)) {
+            stats.cacheHits++;
+            *data = values[registerAddress];
+            return I2C_OK;
+        }
+
+        return readBytes(registerAddress, data, 1);
+    };
+
+    /**
+     * Reads multiple bytes from the device. The cache is bypassed but updated with the read values
+     * @param registerAddress the address of the first register to read
+     * @param data pointer to the location the read bytes are stored
+     * @param numBytes the number of bytes to read
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code readBytes(uint8_t registerAddress, uint8_t * data, size_t numBytes) {
+        stats.busReads++;
+        if (I2CUtil::readBytes(i2c, slaveAddress, registerAddress, data, numBytes) != I2C_OK) {
+            return I2C_ERROR;
+        }
+        stats.busBytes += numBytes;
+
+        for (size_t i = 0; i < numBytes; i++) {
+            size_t reg = registerAddress + i;
+            // pending writes win over the value on the device
+            if (reg < NumRegisters && cached.test(reg) && !dirty.test(reg)) {
+                values[reg] = data[i];
+                valid.set(reg);
+            }
+        }
+
+        return I2C_OK;
+    };
+
+    /**
+     * Writes a single byte. Writes of the value the register already holds are skipped
+     * @param registerAddress the address of the register to write
+     * @param data the byte to write
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code writeByte(uint8_t registerAddress, uint8_t data) {
+        if (isCacheable(registerAddress)) {
+            if (valid.test(registerAddress) && values[registerAddress] == data) {
+                stats.writesSaved++;
+                return I2C_OK;
+            }
+
+            if (policy == WRITE_BACK) {
+                if (dirty.test(registerAddress)) {
+                    // overwrites a pending write
+                    stats.writesSaved++;
+                }
+                values[registerAddress] = data;
+                valid.set(registerAddress);
+                dirty.set(registerAddress);
+                return I2C_OK;
+            }
+        }
+
+        return writeBytes(registerAddress, &data, 1);
+    };
+
+    /**
+     * Writes multiple bytes to the device immediately and updates the cache
+     * @param registerAddress the address of the first register to write
+     * @param data the data to write
+     * @param numBytes the number of bytes to write
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code writeBytes(uint8_t registerAddress, const uint8_t * data, size_t numBytes) {
+        stats.busWrites++;
+        if (I2CUtil::writeBytes(i2c, slaveAddress, registerAddress, data, numBytes) != I2C_OK) {
+            // the state of the device is unknown now
+            for (size_t reg = registerAddress; reg < registerAddress + numBytes && reg < NumRegisters; reg++) {
+                valid.reset(reg);
+                dirty.reset(reg);
+            }
+            return I2C_ERROR;
+        }
+        stats.busBytes += numBytes;
+
+        for (size_t i = 0; i < numBytes; i++) {
+            size_t reg = registerAddress + i;
+            if (reg < NumRegisters && cached.test(reg)) {
+                values[reg] = data[i];
+                valid.set(reg);
+                dirty.reset(reg);
+            }
+        }
+
+        return I2C_OK;
+    };
+
+    /**
+     * Reads a single bit from a register
+     * @param registerAddress the address of the register to read
+     * @param bitPos the position of the bit (0 = LSB)
+     * @param value pointer to the location the read bit is stored
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code readBit(uint8_t registerAddress, uint8_t bitPos, bool * value) {
+        uint8_t byte;
+        if (readByte(registerAddress, &byte) != I2C_OK) {
+            return I2C_ERROR;
+        }
+
+        *value = bitRead(byte, bitPos);
+        return I2C_OK;
+    };
+
+    /**
+     * Writes a single bit to a register. The register is only read if its value is not cached
+     * @param registerAddress the address of the register to write
+     * @param bitPos the position of the bit (0 = LSB)
+     * @param value the bit value to write
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code writeBit(uint8_t registerAddress, uint8_t bitPos, bool value) {
+        return modify(registerAddress, FieldValue<uint8_t>(1 << bitPos, value << bitPos));
+    };
+
+    /**
+     * Read multiple bits from a register
+     * @param registerAddress the address of the register to read
+     * @param registerMask mask for the bits to read
+     * @param data pointer to the location the read bits are stored
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code readBits(uint8_t registerAddress, uint8_t registerMask, uint8_t * data) {
+        uint8_t byte;
+        if (readByte(registerAddress, &byte) != I2C_OK) {
+            return I2C_ERROR;
+        }
+
+        *data = byte & registerMask;
+        return I2C_OK;
+    };
+
+    /**
+     * Writes multiple bits to a register. The register is only read if its value is not cached
+     * @param registerAddress the address of the register to write
+     * @param registerMask mask for the bits to write
+     * @param data the bits to write
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code writeBits(uint8_t registerAddress, uint8_t registerMask, uint8_t data) {
+        return modify(registerAddress, FieldValue<uint8_t>(registerMask, data));
+    };
+
+    /**
+     * Applies field values to a register in a single read-modify-write. The read is skipped if the
+     * register value is cached or all bits are replaced
+     * @param registerAddress the address of the register to write
+     * @param values the field values, see BitField
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code modify(uint8_t registerAddress, FieldValue<uint8_t> values) {
+        uint8_t byte = 0;
+
+        if (values.mask != 0xFF && readByte(registerAddress, &byte) != I2C_OK) {
+            return I2C_ERROR;
+        }
+
+        return writeByte(registerAddress, values.apply(byte));
+    };
+
+    /**
+     * Forgets the cached value of a register, so the next access reads it from the device.
+     * A pending write to the register is discarded
+     * @param registerAddress the address of the register
+     */
+    void invalidate(uint8_t registerAddress) {
+        if (registerAddress < NumRegisters) {
+            valid.reset(registerAddress);
+            dirty.reset(registerAddress);
+        }
+    };
+
+    /**
+     * Forgets all cached values, e.g. after a reset of the device. Pending writes are discarded
+     */
+    void invalidateAll() {
+        valid.resetAll();
+        dirty.resetAll();
+    };
+
+    /**
+     * Sends all pending writes to the device. With burst writes enabled, consecutive registers are
+     * written in a single transfer
+     * @return I2C_OK when all writes succeeded, I2C_ERROR otherwise
+     */
+    i2c_return_code flush() {
+        i2c_return_code result = I2C_OK;
+        size_t reg = dirty.findFirst();
+
+        while (reg < NumRegisters) {
+            size_t length = 1;
+            if (burstWrites) {
+                while (reg + length < NumRegisters && length < I2C_WRITE_BUFFER_SIZE && dirty.test(reg + length)) {
+                    length++;
+                }
+            }
+
+            if (writeBytes(reg, &values[reg], length) != I2C_OK) {
+                result = I2C_ERROR;
+            }
+
+            reg = dirty.findNext(reg + length - 1);
+        }
+
+        return result;
+    };
+
+    /**
+     * Gets whether there are writes that have not been sent to the device yet
+     * @return true if flush() has something to write
+     */
+    bool hasPendingWrites() {return dirty.any();};
+
+    /**
+     * Gets the bus usage counters
+     * @return the counters
+     */
+    const i2c_cache_stats_t & getStats() {return stats;};
+
+    /**
+     * Resets the bus usage counters to zero
+     */
+    void resetStats() {memset(&stats, 0, sizeof(stats));};
+private:
+    I2C * i2c;
+    uint8_t slaveAddress;
+    i2c_cache_write_policy_t policy;
+    bool burstWrites;
+    uint8_t values[NumRegisters];
+    Bitset<NumRegisters> cached;
+    Bitset<NumRegisters> valid;
+    Bitset<NumRegisters> dirty;
+    i2c_cache_stats_t stats;
+};
+
+#endif
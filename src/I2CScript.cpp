@@ -0,0 +1,113 @@
+#include <I2CScript.h>
+
+I2CScript::I2CScript(const i2c_script_op_t * ops, size_t numOps) : ops(ops), numOps(numOps) {
+    autoIncrement = true;
+    autoIncrementFlag = 0;
+    burstLength = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+void I2CScript::setAutoIncrement(bool enabled, uint8_t registerFlag) {
+    autoIncrement = enabled;
+    autoIncrementFlag = registerFlag;
+}
+
+i2c_return_code I2CScript::run(I2C * i2c, uint8_t slaveAddress) {
+    memset(&stats, 0, sizeof(stats));
+    burstLength = 0;
+
+    for (size_t i = 0; i < numOps; i++) {
+        const i2c_script_op_t & op = ops[i];
+
+        if (op.type == I2C_SCRIPT_DELAY) {
+            // everything before the delay has to be written first
+            if (writeBurst(i2c, slaveAddress) != I2C_OK) {
+                return I2C_ERROR;
+            }
+
+            if (op.value > 0) {
+                wait_us(op.value * 1000);
+            }
+            continue;
+        }
+
+        // a full write costs one transaction, a masked write a read (select + read) and a write
+        stats.naiveTransactions += op.mask == 0xFF ? 1 : 3;
+
+        if (burstLength > 0) {
+            uint8_t lastRegister = burstStart + burstLength - 1;
+            bool sameRegister = op.registerAddress == lastRegister;
+            bool nextRegister = autoIncrement && op.registerAddress == lastRegister + 1 && burstLength < I2C_WRITE_BUFFER_SIZE;
+
+            if (!sameRegister && !nextRegister) {
+                if (writeBurst(i2c, slaveAddress) != I2C_OK) {
+                    return I2C_ERROR;
+                }
+            }
+        }
+
+        addToBurst(op);
+    }
+
+    return writeBurst(i2c, slaveAddress);
+}
+
+void I2CScript::addToBurst(const i2c_script_op_t & op) {
+    if (burstLength > 0 && op.registerAddress == burstStart + burstLength - 1) {
+        // merge with the previous write to the same register
+        uint8_t last = burstLength - 1;
+        burstValues[last] = (burstValues[last] & ~op.mask) | op.value;
+        burstMasks[last] |= op.mask;
+        return;
+    }
+
+    if (burstLength == 0) {
+        burstStart = op.registerAddress;
+    }
+
+    burstValues[burstLength] = op.value;
+    burstMasks[burstLength] = op.mask;
+    burstLength++;
+}
+
+i2c_return_code I2CScript::writeBurst(I2C * i2c, uint8_t slaveAddress) {
+    if (burstLength == 0) {
+        return I2C_OK;
+    }
+
+    uint8_t length = burstLength;
+    burstLength = 0;
+
+    uint8_t burstFlag = length > 1 ? autoIncrementFlag : 0;
+
+    // find the registers whose current value is needed
+    int firstPartial = -1;
+    int lastPartial = -1;
+    for (int i = 0; i < length; i++) {
+        if (burstMasks[i] != 0xFF) {
+            if (firstPartial < 0) {
+                firstPartial = i;
+            }
+            lastPartial = i;
+        }
+    }
+
+    if (firstPartial >= 0) {
+        // read all of them at once
+        uint8_t current[I2C_WRITE_BUFFER_SIZE];
+        uint8_t span = lastPartial - firstPartial + 1;
+        uint8_t readFlag = span > 1 ? autoIncrementFlag : 0;
+
+        stats.transactions += 2;
+        if (I2CUtil::readBytes(i2c, slaveAddress, (burstStart + firstPartial) | readFlag, current, span) != I2C_OK) {
+            return I2C_ERROR;
+        }
+
+        for (int i = firstPartial; i <= lastPartial; i++) {
+            burstValues[i] = (current[i - firstPartial] & ~burstMasks[i]) | burstValues[i];
+        }
+    }
+
+    stats.transactions += 1;
+    return I2CUtil::writeBytes(i2c, slaveAddress, burstStart | burstFlag, burstValues, length);
+}
@@ -0,0 +1,186 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_I2C_SCRIPT_H_
+#define _MBED_EXT_I2C_SCRIPT_H_
+
+#include <mbed.h>
+#include <I2CUtil.h>
+
+/**
+ * Type of a script operation
+ */
+typedef enum i2c_script_op_type {
+    /* Write (some bits of) a register */
+    I2C_SCRIPT_WRITE,
+    /* Wait before executing the next operation. Also prevents merging across this point */
+    I2C_SCRIPT_DELAY
+}i2c_script_op_type_t;
+
+/**
+ * A single operation of a register script. Use the scriptWrite / scriptWriteBits / scriptModify /
+ * scriptDelay functions to create operations
+ */
+typedef struct i2c_script_op {
+    /* The type of the operation */
+    uint8_t type;
+    /* The register to write */
+    uint8_t registerAddress;
+    /* The bits of the register that are written, 0xFF for the whole register */
+    uint8_t mask;
+    /* The value to write, or the delay in milliseconds */
+    uint8_t value;
+}i2c_script_op_t;
+
+/**
+ * Transaction counts of an executed script
+ */
+typedef struct i2c_script_stats {
+    /* Bus transactions needed when every operation is executed on its own (read-modify-write for masked writes) */
+    uint32_t naiveTransactions;
+    /* Bus transactions that were actually used */
+    uint32_t transactions;
+}i2c_script_stats_t;
+
+/**
+ * Creates an operation that writes a whole register
+ * @param registerAddress the register to write
+ * @param value the value to write
+ * @return the operation
+ */
+constexpr i2c_script_op_t scriptWrite(uint8_t registerAddress, uint8_t value) {
+    return {I2C_SCRIPT_WRITE, registerAddress, 0xFF, value};
+}
+
+/**
+ * Creates an operation that writes some bits of a register
+ * @param registerAddress the register to write
+ * @param mask the bits to write
+ * @param value the value of the bits
+ * @return the operation
+ */
+constexpr i2c_script_op_t scriptWriteBits(uint8_t registerAddress, uint8_t mask, uint8_t value) {
+    return {I2C_SCRIPT_WRITE, registerAddress, mask, (uint8_t)(value & mask)};
+}
+
+/**
+ * Creates an operation that writes register fields, see BitField
+ * @param registerAddress the register to write
+ * @param values the field values
+ * @return the operation
+ */
+constexpr i2c_script_op_t scriptModify(uint8_t registerAddress, FieldValue<uint8_t> values) {
+    return {I2C_SCRIPT_WRITE, registerAddress, values.mask, values.bits};
+}
+
+/**
+ * Creates an operation that waits before the next operation is executed
+ * @param ms the time to wait in milliseconds. 0 only separates the operations before and after from each other
+ * @return the operation
+ */
+constexpr i2c_script_op_t scriptDelay(uint8_t ms) {
+    return {I2C_SCRIPT_DELAY, 0, 0, ms};
+}
+
+/**
+ * Executes a table of register writes, e.g. the initialization sequence of a sensor, using as few bus
+ * transactions as possible:
+ * - consecutive writes to the same register are merged into one write
+ * - writes to ascending consecutive registers are sent as a single auto-increment burst
+ * - masked writes inside a burst share a single burst read of the current register values
+ *
+ * The order of the operations is kept. Writes are only merged if they are next to each other in the
+ * table and no delay is between them. Use scriptDelay(0) to keep writes apart that must not be merged,
+ * e.g. a write that resets the device.
+ *
+ * @code
+ * constexpr i2c_script_op_t MPU6050_INIT[] = {
+ *     scriptWrite(MPU6050_RA_PWR_MGMT_1, 0x80),  // reset
+ *     scriptDelay(100),
+ *     scriptWrite(MPU6050_RA_PWR_MGMT_1, 0x01),
+ *     scriptWrite(MPU6050_RA_SMPLRT_DIV, 0x07),  // 0x19 to 0x1C are sent in a single burst
+ *     scriptWrite(MPU6050_RA_CONFIG, 0x03),
+ *     scriptWriteBits(MPU6050_RA_GYRO_CONFIG, 0x18, 0x08),
+ *     scriptWriteBits(MPU6050_RA_ACCEL_CONFIG, 0x18, 0x10),
+ * };
+ *
+ * I2CScript init(MPU6050_INIT);
+ * init.run(&i2c, MPU6050_ADDRESS);
+ * @endcode
+ */
+class I2CScript
+{
+public:
+    /**
+     * Constructor
+     * @param ops the operations, usually a constexpr table in flash
+     * @param numOps the number of operations
+     */
+    I2CScript(const i2c_script_op_t * ops, size_t numOps);
+
+    /**
+     * Constructor
+     * @param ops the operations, usually a constexpr table in flash
+     */
+    template<size_t N>
+    I2CScript(const i2c_script_op_t (&ops)[N]) : I2CScript(ops, N) {};
+
+    /**
+     * Configures burst transfers. Enabled by default
+     * @param enabled true if the device increments the register address automatically
+     * @param registerFlag bits that are set in the register address to request auto-increment, e.g. 0x80 for many ST sensors
+     */
+    void setAutoIncrement(bool enabled, uint8_t registerFlag = 0);
+
+    /**
+     * Executes the script. Execution stops at the first failed transfer
+     * @param i2c the I2C device to use
+     * @param slaveAddress the 7-bit address of the slave
+     * @return I2C_OK when all operations were successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code run(I2C * i2c, uint8_t slaveAddress);
+
+    /**
+     * Gets the transaction counts of the last run
+     * @return the transaction counts
+     */
+    const i2c_script_stats_t & getStats() {return stats;};
+private:
+    const i2c_script_op_t * ops;
+    size_t numOps;
+    bool autoIncrement;
+    uint8_t autoIncrementFlag;
+    i2c_script_stats_t stats;
+
+    // registers that are written together
+    uint8_t burstStart;
+    uint8_t burstLength;
+    uint8_t burstValues[I2C_WRITE_BUFFER_SIZE];
+    uint8_t burstMasks[I2C_WRITE_BUFFER_SIZE];
+
+    void addToBurst(const i2c_script_op_t & op);
+    i2c_return_code writeBurst(I2C * i2c, uint8_t slaveAddress);
+};
+
+#endif
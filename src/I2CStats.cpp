@@ -0,0 +1,147 @@
+#include <I2CStats.h>
+
+#if MBED_EXT_I2C_STATS
+
+#include <BitStream.h>
+
+static_assert((I2C_STATS_MAX_ENTRIES & (I2C_STATS_MAX_ENTRIES - 1)) == 0, "I2C_STATS_MAX_ENTRIES must be a power of two");
+
+i2c_stats_entry_t I2CStats::entries[I2C_STATS_MAX_ENTRIES];
+bool I2CStats::slotUsed[I2C_STATS_MAX_ENTRIES];
+size_t I2CStats::used = 0;
+uint32_t I2CStats::dropped = 0;
+
+i2c_stats_entry_t * I2CStats::lookup(uint8_t slaveAddress, uint8_t registerAddress, bool create) {
+    // open addressing with linear probing, entries are never removed except by reset()
+    size_t slot = (slaveAddress * 31u + registerAddress) & (I2C_STATS_MAX_ENTRIES - 1);
+
+    for (size_t i = 0; i < I2C_STATS_MAX_ENTRIES; i++) {
+        i2c_stats_entry_t * entry = &entries[slot];
+
+        if (!slotUsed[slot]) {
+            if (!create) {
+                return nullptr;
+            }
+
+            memset(entry, 0, sizeof(i2c_stats_entry_t));
+            entry->slaveAddress = slaveAddress;
+            entry->registerAddress = registerAddress;
+            slotUsed[slot] = true;
+            used++;
+            return entry;
+        }
+
+        if (entry->slaveAddress == slaveAddress && entry->registerAddress == registerAddress) {
+            return entry;
+        }
+
+        slot = (slot + 1) & (I2C_STATS_MAX_ENTRIES - 1);
+    }
+
+    return nullptr;
+}
+
+void I2CStats::record(uint8_t slaveAddress, uint8_t registerAddress, size_t numBytes, i2c_stats_result_t result, uint32_t latencyUs) {
+    uint8_t bucket = latencyBucket(latencyUs);
+
+    core_util_critical_section_enter();
+    i2c_stats_entry_t * entry = lookup(slaveAddress, registerAddress, true);
+
+    if (entry == nullptr) {
+        dropped++;
+    } else {
+        entry->transactions++;
+
+        if (result == I2C_STATS_OK) {
+            entry->bytes += numBytes;
+        } else if (result == I2C_STATS_NACK) {
+            entry->nacks += entry->nacks < UINT16_MAX;
+        } else {
+            entry->errors += entry->errors < UINT16_MAX;
+        }
+
+        entry->latency[bucket] += entry->latency[bucket] < UINT16_MAX;
+    }
+    core_util_critical_section_exit();
+}
+
+void I2CStats::recordError(uint8_t slaveAddress, uint8_t registerAddress) {
+    core_util_critical_section_enter();
+    i2c_stats_entry_t * entry = lookup(slaveAddress, registerAddress, true);
+
+    if (entry == nullptr) {
+        dropped++;
+    } else {
+        entry->errors += entry->errors < UINT16_MAX;
+    }
+    core_util_critical_section_exit();
+}
+
+const i2c_stats_entry_t * I2CStats::find(uint8_t slaveAddress, uint8_t registerAddress) {
+    return lookup(slaveAddress, registerAddress, false);
+}
+
+const i2c_stats_entry_t * I2CStats::entry(size_t index) {
+    return index < I2C_STATS_MAX_ENTRIES && slotUsed[index] ? &entries[index] : nullptr;
+}
+
+void I2CStats::reset() {
+    core_util_critical_section_enter();
+    memset(slotUsed, 0, sizeof(slotUsed));
+    used = 0;
+    dropped = 0;
+    core_util_critical_section_exit();
+}
+
+size_t I2CStats::snapshot(uint8_t * buffer, size_t size) {
+    BitWriter writer(buffer, size);
+
+    core_util_critical_section_enter();
+    size_t numSnapshot = used;
+    uint32_t numDropped = dropped;
+    core_util_critical_section_exit();
+
+    writer.write(I2C_STATS_SNAPSHOT_VERSION, 8);
+    writer.writeVarint(numSnapshot);
+    writer.writeVarint(numDropped);
+
+    for (size_t slot = 0, written = 0; slot < I2C_STATS_MAX_ENTRIES && written < numSnapshot; slot++) {
+        // copy a single entry, so the critical section stays short
+        i2c_stats_entry_t entry;
+
+        core_util_critical_section_enter();
+        bool valid = slotUsed[slot];
+        entry = entries[slot];
+        core_util_critical_section_exit();
+
+        if (!valid) {
+            continue;
+        }
+        written++;
+
+        writer.write(entry.slaveAddress, 7);
+        writer.write(entry.registerAddress, 8);
+        writer.writeVarint(entry.transactions);
+        writer.writeVarint(entry.bytes);
+        writer.writeVarint(entry.nacks);
+        writer.writeVarint(entry.errors);
+
+        // most transactions fall into a few buckets, only send the non-empty ones
+        uint16_t bucketMask = 0;
+        for (uint8_t bucket = 0; bucket < I2C_STATS_LATENCY_BUCKETS; bucket++) {
+            bucketMask |= (entry.latency[bucket] != 0) << bucket;
+        }
+
+        writer.write(bucketMask, I2C_STATS_LATENCY_BUCKETS);
+        for (uint8_t bucket = 0; bucket < I2C_STATS_LATENCY_BUCKETS; bucket++) {
+            if (entry.latency[bucket] != 0) {
+                writer.writeVarint(entry.latency[bucket]);
+            }
+        }
+    }
+
+    size_t length = writer.flush();
+    return writer.hasOverflowed() ? 0 : length;
+}
+
+#endif
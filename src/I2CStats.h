@@ -0,0 +1,196 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_I2C_STATS_H_
+#define _MBED_EXT_I2C_STATS_H_
+
+#include <mbed.h>
+
+/**
+ * Instrumentation of I2C transactions. Disabled by default, enable it by defining MBED_EXT_I2C_STATS=1,
+ * e.g. in the macros section of mbed_app.json. When disabled, the hooks compile to nothing and no memory is used.
+ */
+#ifndef MBED_EXT_I2C_STATS
+#define MBED_EXT_I2C_STATS 0
+#endif
+
+/**
+ * Maximum number of distinct (slave, register) pairs that are tracked, must be a power of two
+ */
+#ifndef I2C_STATS_MAX_ENTRIES
+#define I2C_STATS_MAX_ENTRIES 16
+#endif
+
+/**
+ * Number of latency buckets. Bucket i counts transactions that took [2^i, 2^(i+1)) us, the first bucket
+ * also contains faster ones and the last bucket everything slower.
+ */
+#define I2C_STATS_LATENCY_BUCKETS 16
+
+/**
+ * Version of the binary snapshot format
+ */
+#define I2C_STATS_SNAPSHOT_VERSION 1
+
+/**
+ * Outcome of an instrumented transaction
+ */
+typedef enum i2c_stats_result {
+    /* Transferred successfully */
+    I2C_STATS_OK,
+    /* The slave did not acknowledge */
+    I2C_STATS_NACK,
+    /* Any other error, e.g. a bus timeout or a wrong checksum */
+    I2C_STATS_ERROR
+}i2c_stats_result_t;
+
+#if MBED_EXT_I2C_STATS
+
+/**
+ * Statistics of all transactions to a single register of a slave
+ */
+typedef struct i2c_stats_entry {
+    /* 7-bit address of the slave */
+    uint8_t slaveAddress;
+    /* Address of the (first) register of the transactions */
+    uint8_t registerAddress;
+    /* Number of transactions */
+    uint32_t transactions;
+    /* Number of data bytes transferred, excluding addresses */
+    uint32_t bytes;
+    /* Number of transactions the slave did not acknowledge */
+    uint16_t nacks;
+    /* Number of transactions that failed otherwise */
+    uint16_t errors;
+    /* Latency histogram, the counters saturate */
+    uint16_t latency[I2C_STATS_LATENCY_BUCKETS];
+}i2c_stats_entry_t;
+
+/**
+ * Collects per slave and register statistics of the I2C transactions made by I2CUtil and I2CAsync, and
+ * therefore also of everything built on top of them.
+ */
+class I2CStats
+{
+public:
+    /**
+     * Records a transaction
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the (first) register
+     * @param numBytes the number of data bytes
+     * @param result the outcome of the transaction
+     * @param latencyUs the duration of the transaction in us
+     */
+    static void record(uint8_t slaveAddress, uint8_t registerAddress, size_t numBytes, i2c_stats_result_t result, uint32_t latencyUs);
+
+    /**
+     * Records an error that was detected after a successful transaction, e.g. a wrong checksum
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the (first) register
+     */
+    static void recordError(uint8_t slaveAddress, uint8_t registerAddress);
+
+    /**
+     * Looks up the statistics of a register
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the register
+     * @return the statistics or nullptr if there was no transaction yet
+     */
+    static const i2c_stats_entry_t * find(uint8_t slaveAddress, uint8_t registerAddress);
+
+    /**
+     * Returns the entry at the given index of the table, in no particular order
+     * @param index the index (< I2C_STATS_MAX_ENTRIES)
+     * @return the entry or nullptr if the slot is unused
+     */
+    static const i2c_stats_entry_t * entry(size_t index);
+
+    /**
+     * Returns the number of tracked registers
+     * @return the number of used entries
+     */
+    static size_t numEntries() {return used;};
+
+    /**
+     * Returns the number of transactions that were not recorded because the table was full
+     * @return the number of dropped transactions
+     */
+    static uint32_t getDropped() {return dropped;};
+
+    /**
+     * Clears all statistics
+     */
+    static void reset();
+
+    /**
+     * Serializes all statistics into a compact binary snapshot, e.g. to dump them over serial. The format is
+     * little endian and bit packed: version (8 bits), number of entries and dropped transactions (varints), then for
+     * every entry the slave address (7 bits), register address (8 bits), transactions, bytes, NACKs and errors (varints),
+     * a 16-bit mask of the non-empty latency buckets and a varint count for each of them.
+     * @param buffer the buffer to write to
+     * @param size the size of the buffer, snapshotSize() is always sufficient
+     * @return the number of bytes written or 0 if the buffer is too small
+     */
+    static size_t snapshot(uint8_t * buffer, size_t size);
+
+    /**
+     * Returns an upper bound of the size of a snapshot
+     * @return the maximum size in bytes
+     */
+    static constexpr size_t snapshotSize() {
+        return 1 + 5 + 5 + I2C_STATS_MAX_ENTRIES * (2 + 4 * 5 + 2 + I2C_STATS_LATENCY_BUCKETS * 3) + 4;
+    };
+
+    /**
+     * Returns the latency bucket of a duration
+     * @param latencyUs the duration in us
+     * @return the bucket index
+     */
+    static uint8_t latencyBucket(uint32_t latencyUs) {
+        uint8_t bucket = latencyUs < 2 ? 0 : 31 - __builtin_clz(latencyUs);
+        return bucket < I2C_STATS_LATENCY_BUCKETS ? bucket : I2C_STATS_LATENCY_BUCKETS - 1;
+    };
+private:
+    static i2c_stats_entry_t * lookup(uint8_t slaveAddress, uint8_t registerAddress, bool create);
+
+    static i2c_stats_entry_t entries[I2C_STATS_MAX_ENTRIES];
+    static bool slotUsed[I2C_STATS_MAX_ENTRIES];
+    static size_t used;
+    static uint32_t dropped;
+};
+
+/* Hooks used by the instrumented drivers */
+#define I2C_STATS_BEGIN() uint32_t i2cStatsStart = us_ticker_read()
+#define I2C_STATS_END(slaveAddress, registerAddress, numBytes, result) I2CStats::record(slaveAddress, registerAddress, numBytes, result, us_ticker_read() - i2cStatsStart)
+#define I2C_STATS_RECORD_ERROR(slaveAddress, registerAddress) I2CStats::recordError(slaveAddress, registerAddress)
+
+#else
+
+#define I2C_STATS_BEGIN()
+#define I2C_STATS_END(slaveAddress, registerAddress, numBytes, result)
+#define I2C_STATS_RECORD_ERROR(slaveAddress, registerAddress)
+
+#endif
+
+#endif
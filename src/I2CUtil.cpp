@@ -9,29 +9,113 @@ i2c_return_code I2CUtil::writeByte(I2C * i2c, uint8_t slaveAddress, uint8_t regi
 }
 
 i2c_return_code I2CUtil::readBytes(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, size_t numBytes) {
-    // select register
-    I2C_SELECT_REG(i2c, I2C_ADDR_8BIT(slaveAddress), registerAddress);
+    I2C_STATS_BEGIN();
 
-    // read desired data
-    if (i2c->read(I2C_ADDR_8BIT(slaveAddress), (char *)data, numBytes) != 0){
+    // select register, then read desired data
+    bool acked = i2c->write(I2C_ADDR_8BIT(slaveAddress), (const char *)&registerAddress, 1, true) == 0
+              && i2c->read(I2C_ADDR_8BIT(slaveAddress), (char *)data, numBytes) == 0;
+
+    I2C_STATS_END(slaveAddress, registerAddress, numBytes, acked ? I2C_STATS_OK : I2C_STATS_NACK);
+
+    return acked ? I2C_OK : I2C_ERROR;
+}
+
+i2c_return_code I2CUtil::readInt16s(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, int16_t * data, size_t count, byte_order_t order) {
+    uint8_t * raw = (uint8_t *)data;
+
+    if (readBytes(i2c, slaveAddress, registerAddress, raw, count * sizeof(int16_t)) != I2C_OK) {
         return I2C_ERROR;
-    };
+    }
+
+    // convert to host byte order in place
+    unpackInt16(raw, data, count, order);
 
     return I2C_OK;
 }
 
 i2c_return_code I2CUtil::writeBytes(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, const uint8_t * data, size_t numBytes) {
-    // select register
-    I2C_SELECT_REG(i2c, I2C_ADDR_8BIT(slaveAddress), registerAddress);
+    I2C_STATS_BEGIN();
+
+    if (numBytes <= I2C_WRITE_BUFFER_SIZE) {
+        // register address and data have to be sent in a single transfer
+        uint8_t buffer[I2C_WRITE_BUFFER_SIZE + 1];
+        buffer[0] = registerAddress;
+        memcpy(buffer + 1, data, numBytes);
+
+        bool acked = i2c->write(I2C_ADDR_8BIT(slaveAddress), (const char *)buffer, numBytes + 1) == 0;
+
+        I2C_STATS_END(slaveAddress, registerAddress, numBytes, acked ? I2C_STATS_OK : I2C_STATS_NACK);
+
+        return acked ? I2C_OK : I2C_ERROR;
+    }
+
+    // too large for the buffer, send byte by byte. write returns 1 on ACK, 0 on NACK and 2 on timeout
+    i2c->start();
+    int ack = i2c->write(I2C_ADDR_8BIT(slaveAddress));
+    if (ack == 1) {
+        ack = i2c->write(registerAddress);
+    }
+    for (size_t i = 0; ack == 1 && i < numBytes; i++) {
+        ack = i2c->write(data[i]);
+    }
+    i2c->stop();
+
+    I2C_STATS_END(slaveAddress, registerAddress, numBytes, ack == 1 ? I2C_STATS_OK : ack == 0 ? I2C_STATS_NACK : I2C_STATS_ERROR);
+
+    return ack == 1 ? I2C_OK : I2C_ERROR;
+}
+
+i2c_return_code I2CUtil::readBytesPec(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, size_t numBytes) {
+    uint8_t buffer[I2C_PEC_MAX_LENGTH + 1];
+
+    if (numBytes > I2C_PEC_MAX_LENGTH) {
+        return I2C_ERROR;
+    }
+
+    // read data and PEC at once
+    if (readBytes(i2c, slaveAddress, registerAddress, buffer, numBytes + 1) != I2C_OK) {
+        return I2C_ERROR;
+    }
+
+    // the PEC covers the write address, the register, the read address and the data
+    const uint8_t header[] = {(uint8_t)I2C_ADDR_8BIT(slaveAddress), registerAddress, (uint8_t)(I2C_ADDR_8BIT(slaveAddress) | 0x01)};
+    uint8_t crc = Crc8Smbus::update(Crc8Smbus::initial, header, sizeof(header));
+    crc = Crc8Smbus::finalize(Crc8Smbus::update(crc, buffer, numBytes));
 
-    // write desired data
-    if (i2c->write(I2C_ADDR_8BIT(slaveAddress), (const char *)data, numBytes) != 0) {
+    if (crc != buffer[numBytes]) {
+        I2C_STATS_RECORD_ERROR(slaveAddress, registerAddress);
         return I2C_ERROR;
     }
 
+    memcpy(data, buffer, numBytes);
     return I2C_OK;
 }
 
+i2c_return_code I2CUtil::writeBytesPec(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, const uint8_t * data, size_t numBytes) {
+    uint8_t buffer[I2C_PEC_MAX_LENGTH + 2];
+
+    if (numBytes > I2C_PEC_MAX_LENGTH) {
+        return I2C_ERROR;
+    }
+
+    // register, data and PEC are sent in a single transfer
+    buffer[0] = registerAddress;
+    memcpy(buffer + 1, data, numBytes);
+
+    // the PEC covers the write address, the register and the data
+    const uint8_t address = I2C_ADDR_8BIT(slaveAddress);
+    uint8_t crc = Crc8Smbus::update(Crc8Smbus::initial, &address, 1);
+    buffer[numBytes + 1] = Crc8Smbus::finalize(Crc8Smbus::update(crc, buffer, numBytes + 1));
+
+    I2C_STATS_BEGIN();
+
+    bool acked = i2c->write(I2C_ADDR_8BIT(slaveAddress), (const char *)buffer, numBytes + 2) == 0;
+
+    I2C_STATS_END(slaveAddress, registerAddress, numBytes, acked ? I2C_STATS_OK : I2C_STATS_NACK);
+
+    return acked ? I2C_OK : I2C_ERROR;
+}
+
 i2c_return_code I2CUtil::readBit(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, uint8_t bitPos, bool * value) {
     uint8_t byte;
 
@@ -42,7 +126,7 @@ i2c_return_code I2CUtil::readBit(I2C * i2c, uint8_t slaveAddress, uint8_t regist
 
     // read bit from byte
     
-    *value = bit_read(byte, bitPos);
+    *value = bitRead(byte, bitPos);
 
     return I2C_OK;
 }
@@ -56,7 +140,7 @@ i2c_return_code I2CUtil::writeBit(I2C * i2c, uint8_t slaveAddress, uint8_t regis
     }
 
     // set the bit value in the read byte
-    byte = bit_write(byte, bitPos, value);
+    byte = bitWrite(byte, bitPos, value);
 
     // write modified byte back via i2c
     return writeByte(i2c, slaveAddress, registerAddress, byte);
@@ -66,6 +150,18 @@ bool I2CUtil::probeAddress(I2C * i2c, uint8_t slaveAddress) {
     return !i2c->write(I2C_ADDR_8BIT(slaveAddress), nullptr, 0);
 }
 
+size_t I2CUtil::scanAddresses(I2C * i2c, Bitset<128> * present, uint8_t firstAddress, uint8_t lastAddress) {
+    present->resetAll();
+
+    for (uint16_t address = firstAddress; address <= lastAddress && address < 128; address++) {
+        if (probeAddress(i2c, address)) {
+            present->set(address);
+        }
+    }
+
+    return present->count();
+}
+
 i2c_return_code I2CUtil::readBits(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, uint8_t registerMask, uint8_t * data) {
     uint8_t byte;
 
@@ -89,7 +185,7 @@ i2c_return_code I2CUtil::writeBits(I2C * i2c, uint8_t slaveAddress, uint8_t regi
         return I2C_ERROR;
     }
 
-    byte = (byte & (0xff ^ registerMask)) | (data & registerMask);
+    byte = FieldValue<uint8_t>(registerMask, data).apply(byte);
 
     return writeByte(i2c, slaveAddress, registerAddress, byte);
 }
\ No newline at end of file
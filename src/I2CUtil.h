@@ -27,6 +27,11 @@ SOFTWARE.
 
 #include <mbed.h>
 #include <Bytes.h>
+#include <BitField.h>
+#include <ByteOrder.h>
+#include <Crc.h>
+#include <Bitset.h>
+#include <I2CStats.h>
 
 /**
  * Selects a register via I2C without terminating the transmission
@@ -43,6 +48,19 @@ SOFTWARE.
  */
 #define I2C_ADDR_8BIT(addr7bit) (addr7bit << 1)
 
+/**
+ * Number of data bytes up to which I2CUtil::writeBytes sends register address and data from a stack buffer.
+ * Larger writes fall back to the byte-wise I2C API
+ */
+#ifndef I2C_WRITE_BUFFER_SIZE
+#define I2C_WRITE_BUFFER_SIZE 32
+#endif
+
+/**
+ * Maximum number of data bytes of a single transfer with packet error checking (SMBus block size)
+ */
+#define I2C_PEC_MAX_LENGTH 32
+
 /**
  * Return codes for I2C operations
  */
@@ -95,6 +113,19 @@ public:
      */
     static i2c_return_code readBytes(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, size_t numBytes);
 
+    /**
+     * Reads multiple consecutive 16-bit values starting by a given register, e.g. the output registers of a sensor.
+     * The raw bytes are read into data and decoded in place.
+     * @param i2c the I2C device to use
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the first register to read
+     * @param data pointer to the location the read values are stored
+     * @param count the number of 16-bit values to read
+     * @param order the byte order in which the device transmits the values
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    static i2c_return_code readInt16s(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, int16_t * data, size_t count, byte_order_t order = MSB_FIRST);
+
     /**
      * Writes multiple bytes
      * @param i2c the I2C device to use
@@ -106,6 +137,29 @@ public:
      */
     static i2c_return_code writeBytes(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, const uint8_t * data, size_t numBytes);
 
+    /**
+     * Reads multiple bytes followed by an SMBus packet error code (PEC) and verifies the PEC.
+     * The PEC is a CRC-8 over all bytes on the bus, including the address bytes.
+     * @param i2c the I2C device to use
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the register (SMBus command) to read
+     * @param data pointer to the location the read bytes are stored. Only modified if the PEC is valid
+     * @param numBytes the number of bytes to read, excluding the PEC (at most I2C_PEC_MAX_LENGTH)
+     * @return I2C_OK when the operation was successfull and the PEC matches, I2C_ERROR otherwise
+     */
+    static i2c_return_code readBytesPec(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, uint8_t * data, size_t numBytes);
+
+    /**
+     * Writes multiple bytes followed by an SMBus packet error code (PEC)
+     * @param i2c the I2C device to use
+     * @param slaveAddress the 7-bit address of the slave
+     * @param registerAddress the address of the register (SMBus command) to write
+     * @param data the data to write
+     * @param numBytes the number of bytes to write, excluding the PEC (at most I2C_PEC_MAX_LENGTH)
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    static i2c_return_code writeBytesPec(I2C * i2c, uint8_t slaveAddress, uint8_t registerAddress, const uint8_t * data, size_t numBytes);
+
     /**
      * Reads a single bit from a register
      * @param i2c the I2C device to use
@@ -157,6 +211,16 @@ public:
      * @return true if there is a device available at the address, false if there is no device available or an I2C error occurred
      */
     static bool probeAddress(I2C * i2c, uint8_t slaveAddress);
+
+    /**
+     * Probes a range of I2C addresses and records which devices responded
+     * @param i2c the I2C device to use
+     * @param present set in which the bit of every responding 7-bit address is set. Bits of other addresses are cleared
+     * @param firstAddress the first address to probe
+     * @param lastAddress the last address to probe
+     * @return the number of devices found
+     */
+    static size_t scanAddresses(I2C * i2c, Bitset<128> * present, uint8_t firstAddress = 0x08, uint8_t lastAddress = 0x77);
 private:
     I2CUtil () {};
 };
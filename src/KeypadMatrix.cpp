@@ -0,0 +1,197 @@
+#include <KeypadMatrix.h>
+
+KeypadMatrix::KeypadMatrix(PortName rowPort, int rowMask, PortName columnPort, int columnMask, uint32_t scanUs)
+    : columns(columnPort, columnMask), eventQueue(nullptr), columnMask(columnMask),
+      scanUs(scanUs), settleUs(DEFAULT_KEYPAD_SETTLE_US), numWakeupInputs(0), firstIndex(0), hasDiodes(false), sleeping(false) {
+    rowShift = __builtin_ctz(rowMask);
+    columnShift = __builtin_ctz(this->columnMask);
+    numRows = __builtin_popcount(rowMask);
+    numColumns = __builtin_popcount(this->columnMask);
+    if (numRows > KEYPAD_MAX_ROWS) {
+        numRows = KEYPAD_MAX_ROWS;
+    }
+
+    memset(state, 0, sizeof(state));
+    memset(count0, 0, sizeof(count0));
+    memset(count1, 0, sizeof(count1));
+    memset(&stats, 0, sizeof(stats));
+
+    columns.mode(PullUp);
+    // no row selected: all rows are floating inputs, which drive low once they are switched to output
+    for (uint8_t row = 0; row < numRows; row++) {
+        gpio_init_inout(&rows[row], port_pin(rowPort, rowShift + row), PIN_INPUT, PullNone, 0);
+    }
+    start();
+}
+
+void KeypadMatrix::onKey(Callback<void(int key, bool pressed)> handler) {
+    keyHandler = handler;
+}
+
+bool KeypadMatrix::setEventQueue(ButtonEventQueue * queue, uint8_t firstIndex) {
+    if (queue && (firstIndex < queue->getNumButtons() || firstIndex + numRows * numColumns > 256)) {
+        // the events would be dispatched to a button, or the indices don't fit into an event
+        return false;
+    }
+
+    eventQueue = queue;
+    this->firstIndex = firstIndex;
+    return true;
+}
+
+bool KeypadMatrix::attachWakeup(InterruptIn * column) {
+    if (numWakeupInputs >= KEYPAD_MAX_WAKEUP_INPUTS) {
+        return false;
+    }
+
+    wakeupInputs[numWakeupInputs++] = column;
+    return true;
+}
+
+bool KeypadMatrix::isPressed(int key) {
+    return (state[key / numColumns] >> (key % numColumns)) & 1;
+}
+
+keypad_stats_t KeypadMatrix::getStats() {
+    core_util_critical_section_enter();
+    keypad_stats_t copy = stats;
+    core_util_critical_section_exit();
+    return copy;
+}
+
+void KeypadMatrix::start() {
+    ticker.attach_us(callback(this, &KeypadMatrix::scan), scanUs);
+}
+
+void KeypadMatrix::stop() {
+    ticker.detach();
+}
+
+void KeypadMatrix::scan() {
+    uint32_t start = us_ticker_read();
+    uint32_t raw[KEYPAD_MAX_ROWS];
+    uint8_t rowsWithKeys = 0;
+
+    for (uint8_t row = 0; row < numRows; row++) {
+        // drive only this row low, pressed keys pull their column low
+        if (row > 0) {
+            gpio_dir(&rows[row - 1], PIN_INPUT);
+        }
+        gpio_dir(&rows[row], PIN_OUTPUT);
+        if (settleUs) {
+            wait_us(settleUs);
+        }
+        raw[row] = (~columns.read() & columnMask) >> columnShift;
+        if (raw[row]) {
+            rowsWithKeys++;
+        }
+    }
+    gpio_dir(&rows[numRows - 1], PIN_INPUT);
+
+    if (!hasDiodes && rowsWithKeys >= 2) {
+        // two rows that share two or more columns form a rectangle, one of its corners may be a ghost
+        uint32_t ghost[KEYPAD_MAX_ROWS] = {0};
+        bool ghosting = false;
+
+        for (uint8_t a = 0; a < numRows; a++) {
+            for (uint8_t b = a + 1; b < numRows; b++) {
+                uint32_t common = raw[a] & raw[b];
+                if (common & (common - 1)) {
+                    ghost[a] |= common;
+                    ghost[b] |= common;
+                    ghosting = true;
+                }
+            }
+        }
+
+        if (ghosting) {
+            stats.ghostFrames++;
+            for (uint8_t row = 0; row < numRows; row++) {
+                // ambiguous keys keep their state, i.e. can't become pressed
+                raw[row] &= ~ghost[row] | state[row];
+            }
+        }
+    }
+
+    for (uint8_t row = 0; row < numRows; row++) {
+        // 2-bit vertical counters, see PortDebouncer
+        uint32_t delta = raw[row] ^ state[row];
+        count1[row] = (count1[row] ^ count0[row]) & delta;
+        count0[row] = ~count0[row] & delta;
+        uint32_t changed = delta & ~(count0[row] | count1[row]);
+
+        if (changed) {
+            state[row] ^= changed;
+            for (uint32_t keys = changed; keys; keys &= keys - 1) {
+                int column = __builtin_ctz(keys);
+                keyChanged(row * numColumns + column, (state[row] >> column) & 1);
+            }
+        }
+    }
+
+    uint32_t duration = us_ticker_read() - start;
+    stats.frames++;
+    stats.lastFrameUs = duration;
+    if (duration > stats.maxFrameUs) {
+        stats.maxFrameUs = duration;
+    }
+
+    if (numWakeupInputs && isIdle()) {
+        sleep();
+    }
+}
+
+void KeypadMatrix::keyChanged(int key, bool pressed) {
+    if (keyHandler) {
+        keyHandler(key, pressed);
+    }
+    if (eventQueue) {
+        eventQueue->post(firstIndex + key, pressed ? BUTTON_DOWN : BUTTON_UP);
+    }
+}
+
+void KeypadMatrix::selectAll(bool selected) {
+    for (uint8_t row = 0; row < numRows; row++) {
+        gpio_dir(&rows[row], selected ? PIN_OUTPUT : PIN_INPUT);
+    }
+}
+
+bool KeypadMatrix::isIdle() {
+    for (uint8_t row = 0; row < numRows; row++) {
+        if (state[row] | count0[row] | count1[row]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void KeypadMatrix::sleep() {
+    ticker.detach();
+    sleeping = true;
+
+    // select all rows, any key press pulls its column low
+    selectAll(true);
+    for (uint8_t i = 0; i < numWakeupInputs; i++) {
+        wakeupInputs[i]->fall(callback(this, &KeypadMatrix::onWakeup));
+    }
+
+    if ((~columns.read() & columnMask) != 0) {
+        // a key was pressed in the meantime
+        onWakeup();
+    }
+}
+
+void KeypadMatrix::onWakeup() {
+    if (!sleeping) {
+        return;
+    }
+
+    sleeping = false;
+    for (uint8_t i = 0; i < numWakeupInputs; i++) {
+        wakeupInputs[i]->fall(nullptr);
+    }
+    selectAll(false);
+    stats.wakeups++;
+
+    start();
+}
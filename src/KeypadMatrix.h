@@ -0,0 +1,215 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_KEYPAD_MATRIX_H_
+#define _MBED_EXT_KEYPAD_MATRIX_H_
+
+#include <mbed.h>
+#include <ButtonEventQueue.h>
+
+#define DEFAULT_KEYPAD_SCAN_US 5000
+#define DEFAULT_KEYPAD_SETTLE_US 1
+
+#ifndef KEYPAD_MAX_ROWS
+#define KEYPAD_MAX_ROWS 8
+#endif
+
+#ifndef KEYPAD_MAX_WAKEUP_INPUTS
+#define KEYPAD_MAX_WAKEUP_INPUTS 8
+#endif
+
+/**
+ * Scan statistics of a KeypadMatrix
+ */
+typedef struct keypad_stats {
+    /* Scanned frames */
+    uint32_t frames;
+    /* Frames in which ghosting was detected */
+    uint32_t ghostFrames;
+    /* Duration of the last frame in us */
+    uint32_t lastFrameUs;
+    /* Longest frame in us */
+    uint32_t maxFrameUs;
+    /* Number of times the scanning was resumed by a key press */
+    uint32_t wakeups;
+}keypad_stats_t;
+
+/**
+ * Scans a key matrix. The rows are selected one at a time (active low) and the columns are read through
+ * a PortIn with pull ups, so a row is read with a single port load. Every key is debounced with 2-bit
+ * vertical counters (4 frames), all keys of a row in parallel.
+ *
+ * The rows emulate open drain outputs, since not every target supports OpenDrain on a port: the selected
+ * row is an output driven low and the other rows are inputs, so they float. Two pressed keys in the same
+ * column connect the selected row to an unselected one, which would short a high and a low output with
+ * push-pull rows in a matrix without diodes. Every row needs a gpio_t (20 - 28 bytes on most targets) to
+ * switch its direction.
+ *
+ * Without diodes in the matrix, three pressed keys that form the corners of a rectangle make the fourth
+ * key look pressed (ghosting). Such frames are detected and the ambiguous keys can't become pressed until
+ * the ambiguity is gone. This is the default, with setDiodes(true) every key is reported and any number of
+ * keys can be pressed at the same time (n-key rollover).
+ *
+ * Optionally the scanning stops when all keys are released: all rows are then driven low and an
+ * interrupt on the column pins resumes the scanning with the next key press.
+ *
+ * The row pins and the column pins each have to be consecutive pins of their port.
+ *
+ * @code
+ * // rows on PA_0 - PA_3, columns on PB_4 - PB_7
+ * KeypadMatrix keypad(PortA, 0x000F, PortB, 0x00F0);
+ * keypad.onKey([](int key, bool pressed) {
+ *     // executed in an ISR, key = row * columns + column
+ * });
+ * @endcode
+ */
+class KeypadMatrix
+{
+public:
+    /**
+     * Constructor. Scanning is started immediately
+     * @param rowPort the port of the row pins
+     * @param rowMask the row pins (up to KEYPAD_MAX_ROWS)
+     * @param columnPort the port of the column pins
+     * @param columnMask the column pins (up to 32)
+     * @param scanUs the interval between two frames in us
+     */
+    KeypadMatrix(PortName rowPort, int rowMask, PortName columnPort, int columnMask, uint32_t scanUs = DEFAULT_KEYPAD_SCAN_US);
+
+    /**
+     * Registers for debounced key changes
+     * @param handler the function that is called with the key and whether it was pressed or released. Note that this is executed in an ISR
+     */
+    void onKey(Callback<void(int key, bool pressed)> handler);
+
+    /**
+     * Posts BUTTON_DOWN / BUTTON_UP events of the keys to a queue, the button of an event is firstIndex + key.
+     * The events are dispatched to the event handler of the queue. The indices of buttons attached to the queue
+     * are reserved, so attach them before and use an index behind them, e.g. queue->getNumButtons()
+     * @param queue the queue, nullptr to stop posting
+     * @param firstIndex the button index of the first key
+     * @return true if the events are posted, false if the indices of the keys overlap with attached buttons or exceed 255
+     */
+    bool setEventQueue(ButtonEventQueue * queue, uint8_t firstIndex);
+
+    /**
+     * Adds an interrupt input on a column pin that resumes the scanning. Once an input is added, the scanning
+     * stops while all keys are released
+     * @param column the input
+     * @return true if the input was added, false if the maximum number of inputs is reached
+     */
+    bool attachWakeup(InterruptIn * column);
+
+    /**
+     * Sets whether the matrix has a diode per key. Without diodes (the default) ghosting is detected and
+     * ambiguous keys are not reported. With diodes there is no ghosting, so every pressed key is reported
+     * @param hasDiodes true if every key has a diode
+     */
+    void setDiodes(bool hasDiodes) {this->hasDiodes = hasDiodes;};
+
+    /**
+     * Sets the time a row needs to settle after it was driven
+     * @param us the settle time in us
+     */
+    void setSettleTime(uint32_t us) {settleUs = us;};
+
+    /**
+     * Returns whether a key is pressed (debounced)
+     * @param key the key, row * columns + column
+     * @return true when the key is pressed, false otherwise
+     */
+    bool isPressed(int key);
+
+    /**
+     * Gets the debounced keys of a row
+     * @param row the row
+     * @return bit i is set when the key in column i is pressed
+     */
+    uint32_t getRow(int row) {return state[row];};
+
+    /**
+     * Gets the number of rows
+     * @return the number of rows
+     */
+    int getRows() {return numRows;};
+
+    /**
+     * Gets the number of columns
+     * @return the number of columns
+     */
+    int getColumns() {return numColumns;};
+
+    /**
+     * Gets the scan statistics
+     * @return a copy of the statistics
+     */
+    keypad_stats_t getStats();
+
+    /**
+     * Starts scanning
+     */
+    void start();
+
+    /**
+     * Stops scanning, the debounced state is kept
+     */
+    void stop();
+
+    /**
+     * Scans and debounces all rows once. Called by the ticker, can also be called manually when the ticker is stopped
+     */
+    void scan();
+private:
+    gpio_t rows[KEYPAD_MAX_ROWS];
+    PortIn columns;
+    Ticker ticker;
+    Callback<void(int, bool)> keyHandler;
+    ButtonEventQueue * eventQueue;
+    InterruptIn * wakeupInputs[KEYPAD_MAX_WAKEUP_INPUTS];
+    keypad_stats_t stats;
+    uint32_t columnMask;
+    uint32_t scanUs;
+    uint32_t settleUs;
+    uint32_t state[KEYPAD_MAX_ROWS];
+    uint32_t count0[KEYPAD_MAX_ROWS];
+    uint32_t count1[KEYPAD_MAX_ROWS];
+    uint8_t rowShift;
+    uint8_t columnShift;
+    uint8_t numRows;
+    uint8_t numColumns;
+    uint8_t numWakeupInputs;
+    uint8_t firstIndex;
+    bool hasDiodes;
+    bool sleeping;
+
+    void selectAll(bool selected);
+    bool isIdle();
+    void sleep();
+    void keyChanged(int key, bool pressed);
+
+    /* ISR handlers */
+    void onWakeup();
+};
+
+#endif
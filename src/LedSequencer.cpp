@@ -0,0 +1,216 @@
+#include <LedSequencer.h>
+
+/**
+ * Gamma correction table that is computed by the compiler. pow() isn't constexpr, so x^g is computed as
+ * exp(g * ln(x)) with short series after range reduction
+ */
+struct LedGammaTable {
+    uint8_t values[256];
+
+    static constexpr double ln(double x) {
+        // x = m * 2^e with m in [0.5, 1), ln(m) = 2 * atanh((m - 1) / (m + 1))
+        int e = 0;
+        while (x < 0.5) {
+            x *= 2;
+            e--;
+        }
+        double y = (x - 1) / (x + 1);
+        double y2 = y * y;
+        double term = y;
+        double sum = 0;
+        for (int k = 1; k < 40; k += 2) {
+            sum += term / k;
+            term *= y2;
+        }
+        return 2 * sum + e * 0.69314718055994531;
+    }
+
+    static constexpr double exp(double x) {
+        // exp(x) = exp(x / 16)^16
+        x /= 16;
+        double term = 1;
+        double sum = 1;
+        for (int k = 1; k < 20; k++) {
+            term *= x / k;
+            sum += term;
+        }
+        for (int i = 0; i < 4; i++) {
+            sum *= sum;
+        }
+        return sum;
+    }
+
+    constexpr LedGammaTable(double gamma) : values() {
+        values[0] = 0;
+        for (int i = 1; i < 256; i++) {
+            values[i] = (uint8_t)(exp(gamma * ln(i / 255.0)) * 255 + 0.5);
+        }
+    }
+};
+
+static constexpr LedGammaTable gammaTable(LED_GAMMA);
+
+static constexpr led_step_t blinkSteps[] = {ledSet(255, 500), ledSet(0, 500)};
+static constexpr led_step_t heartbeatSteps[] = {ledFade(255, 70), ledFade(0, 130), ledFade(160, 70), ledFade(0, 200), ledSet(0, 530)};
+static constexpr led_step_t breatheSteps[] = {ledFade(255, 1500), ledFade(0, 1500)};
+static constexpr led_step_t flashSteps[] = {ledSet(255, 100), ledSet(0, 0)};
+static constexpr led_step_t errorCodeSteps[] = {ledSet(255, 200), ledSet(0, 300), ledLoop(0, 0), ledSet(0, 1500)};
+
+const led_pattern_t LED_PATTERN_BLINK = LED_PATTERN(blinkSteps, 0);
+const led_pattern_t LED_PATTERN_HEARTBEAT = LED_PATTERN(heartbeatSteps, 0);
+const led_pattern_t LED_PATTERN_BREATHE = LED_PATTERN(breatheSteps, 0);
+const led_pattern_t LED_PATTERN_FLASH = LED_PATTERN(flashSteps, 1);
+const led_pattern_t LED_PATTERN_ERROR_CODE = LED_PATTERN(errorCodeSteps, 0);
+
+LedSequencer::LedSequencer(uint32_t tickMs) : tickMs(tickMs), numLeds(0), running(false) {
+    memset(leds, 0, sizeof(leds));
+}
+
+uint8_t LedSequencer::gamma(uint8_t level) {
+    return gammaTable.values[level];
+}
+
+int LedSequencer::add(Led * led) {
+    if (led->isBlinking()) {
+        led->stopBlinking();
+    }
+    return addLed(led, nullptr, 0);
+}
+
+int LedSequencer::add(SoftPwm * pwm, int channel) {
+    return addLed(nullptr, pwm, channel);
+}
+
+int LedSequencer::addLed(Led * led, SoftPwm * pwm, int channel) {
+    if (numLeds >= LED_SEQUENCER_MAX_LEDS) {
+        return -1;
+    }
+
+    LedState * state = &leds[numLeds];
+    state->led = led;
+    state->pwm = pwm;
+    state->channel = channel;
+    write(state);
+    return numLeds++;
+}
+
+void LedSequencer::play(int index, const led_pattern_t * pattern, uint8_t argument) {
+    LedState * state = &leds[index];
+
+    if (!pattern) {
+        stop(index);
+        return;
+    }
+
+    core_util_critical_section_enter();
+    state->pattern = pattern;
+    state->argument = argument;
+    state->repeats = 0;
+    state->loops = 0;
+    enterStep(state, 0);
+    write(state);
+    core_util_critical_section_exit();
+
+    // the pattern may already have finished if none of its steps has a duration
+    if (state->pattern && !running) {
+        running = true;
+        ticker.attach_us(callback(this, &LedSequencer::tick), tickMs * 1000);
+    }
+}
+
+void LedSequencer::stop(int index) {
+    LedState * state = &leds[index];
+
+    core_util_critical_section_enter();
+    state->pattern = nullptr;
+    state->level = 0;
+    write(state);
+    core_util_critical_section_exit();
+}
+
+void LedSequencer::tick() {
+    bool playing = false;
+
+    for (uint8_t i = 0; i < numLeds; i++) {
+        LedState * state = &leds[i];
+        if (!state->pattern) {
+            continue;
+        }
+
+        const led_step_t * step = &state->pattern->steps[state->step];
+        uint8_t previous = state->level;
+        uint32_t elapsed = state->elapsedMs + tickMs;
+        if (elapsed >= step->durationMs) {
+            state->level = step->level;
+            enterStep(state, state->step + 1);
+        }else{
+            state->elapsedMs = elapsed;
+            if (step->mode == LED_STEP_FADE) {
+                state->level = state->from + ((int32_t)step->level - state->from) * (int32_t)elapsed / step->durationMs;
+            }
+        }
+
+        if (state->level != previous) {
+            write(state);
+        }
+        playing |= state->pattern != nullptr;
+    }
+
+    if (!playing) {
+        running = false;
+        ticker.detach();
+    }
+}
+
+void LedSequencer::enterStep(LedState * state, uint8_t next) {
+    const led_pattern_t * pattern = state->pattern;
+
+    // steps without duration and loops are passed at once, the limit stops patterns that would never wait
+    for (uint16_t n = 0; n < 4 * pattern->numSteps + 2; n++) {
+        if (next >= pattern->numSteps) {
+            state->repeats++;
+            if (pattern->repeat && state->repeats >= pattern->repeat) {
+                state->pattern = nullptr;
+                return;
+            }
+            next = 0;
+        }
+
+        const led_step_t * step = &pattern->steps[next];
+        if (step->mode == LED_STEP_LOOP) {
+            uint16_t count = step->durationMs ? step->durationMs : state->argument;
+            if (++state->loops < count) {
+                next = step->level;
+            }else{
+                state->loops = 0;
+                next++;
+            }
+            continue;
+        }
+
+        state->step = next;
+        state->elapsedMs = 0;
+        state->from = state->level;
+        if (step->mode == LED_STEP_SET || step->durationMs == 0) {
+            state->level = step->level;
+        }
+        if (step->durationMs > 0) {
+            return;
+        }
+        next++;
+    }
+
+    state->pattern = nullptr;
+}
+
+void LedSequencer::write(LedState * state) {
+    if (state->pwm) {
+        state->pwm->setBrightness(state->channel, gammaTable.values[state->level]);
+    }else if (state->led) {
+        if (state->level >= 128) {
+            state->led->on();
+        }else{
+            state->led->off();
+        }
+    }
+}
@@ -0,0 +1,233 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_LED_SEQUENCER_H_
+#define _MBED_EXT_LED_SEQUENCER_H_
+
+#include <mbed.h>
+#include <Led.h>
+#include <SoftPwm.h>
+
+#define DEFAULT_LED_SEQUENCER_TICK_MS 10
+
+#ifndef LED_SEQUENCER_MAX_LEDS
+#define LED_SEQUENCER_MAX_LEDS 16
+#endif
+
+#ifndef LED_GAMMA
+#define LED_GAMMA 2.2
+#endif
+
+/**
+ * Types of pattern steps
+ */
+typedef enum led_step_mode {
+    /* Set the level at the start of the step and hold it */
+    LED_STEP_SET = 0,
+    /* Fade linearly from the current level to the level of the step */
+    LED_STEP_FADE,
+    /* Jump back to a previous step, see led_step_t */
+    LED_STEP_LOOP
+}led_step_mode_t;
+
+/**
+ * A step of an LED pattern
+ */
+typedef struct led_step {
+    /* Level at the end of the step (0 - 255). For LED_STEP_LOOP the index of the step to jump back to */
+    uint8_t level;
+    /* Type of the step, see led_step_mode_t */
+    uint8_t mode;
+    /* Duration of the step in ms. For LED_STEP_LOOP the number of times the steps are played (at least once), 0 for the argument of play() */
+    uint16_t durationMs;
+}led_step_t;
+
+/**
+ * An LED pattern, a sequence of steps. Patterns and their steps are constant, so they can be declared
+ * constexpr and stay in flash
+ */
+typedef struct led_pattern {
+    /* The steps */
+    const led_step_t * steps;
+    /* Number of steps */
+    uint8_t numSteps;
+    /* Number of times the pattern is played, 0 = forever */
+    uint8_t repeat;
+}led_pattern_t;
+
+/**
+ * Creates a step that sets a level and holds it
+ * @param level the level (0 - 255)
+ * @param durationMs the time to hold the level in ms
+ * @return the step
+ */
+constexpr led_step_t ledSet(uint8_t level, uint16_t durationMs) {return {level, LED_STEP_SET, durationMs};}
+
+/**
+ * Creates a step that fades to a level
+ * @param level the level at the end of the fade (0 - 255)
+ * @param durationMs the duration of the fade in ms
+ * @return the step
+ */
+constexpr led_step_t ledFade(uint8_t level, uint16_t durationMs) {return {level, LED_STEP_FADE, durationMs};}
+
+/**
+ * Creates a step that repeats the previous steps. All loop steps of a pattern share one counter, so loops
+ * can follow each other but can't be nested
+ * @param step the index of the first step to repeat
+ * @param count the number of times the steps are played, 0 for the argument of play(). The steps are played
+ *              at least once, so an argument of 0 plays them once like 1
+ * @return the step
+ */
+constexpr led_step_t ledLoop(uint8_t step, uint16_t count) {return {step, LED_STEP_LOOP, count};}
+
+/**
+ * Creates a pattern from an array of steps
+ * @param steps the array of steps
+ * @param repeat the number of times the pattern is played, 0 = forever
+ */
+#define LED_PATTERN(steps, repeat) {steps, sizeof(steps) / sizeof(steps[0]), repeat}
+
+/* Predefined patterns */
+
+/* On and off, 1Hz */
+extern const led_pattern_t LED_PATTERN_BLINK;
+/* Double pulse like a heart beat, once per second */
+extern const led_pattern_t LED_PATTERN_HEARTBEAT;
+/* Slow fade in and out, 3 seconds */
+extern const led_pattern_t LED_PATTERN_BREATHE;
+/* A single short flash */
+extern const led_pattern_t LED_PATTERN_FLASH;
+/* N blinks followed by a pause, N is the argument of play(). 0 gives one blink like 1 */
+extern const led_pattern_t LED_PATTERN_ERROR_CODE;
+
+/**
+ * Plays patterns on many LEDs from a single Ticker. A pattern is a constant table of steps that set or
+ * fade the level of an LED, so patterns like heart beats, breathing or error codes don't need tickers
+ * or code in the application. LEDs are either SoftPwm channels, whose brightness is gamma corrected with
+ * a table computed at compile time, or Led instances, which are on for levels from 128. An LED needs
+ * 24 bytes of RAM, and the ticker only runs while a pattern is playing.
+ *
+ * @code
+ * static constexpr led_step_t doubleFlashSteps[] = {ledSet(255, 50), ledSet(0, 100), ledSet(255, 50), ledSet(0, 800)};
+ * static constexpr led_pattern_t doubleFlash = LED_PATTERN(doubleFlashSteps, 0);
+ *
+ * LedSequencer leds;
+ * int status = leds.add(&statusLed);
+ * int error = leds.add(&pwm, redChannel);
+ * leds.play(status, &doubleFlash);
+ * leds.play(error, &LED_PATTERN_ERROR_CODE, 3);
+ * @endcode
+ */
+class LedSequencer
+{
+public:
+    /**
+     * Constructor
+     * @param tickMs the update interval in ms, determines the smoothness of fades
+     */
+    LedSequencer(uint32_t tickMs = DEFAULT_LED_SEQUENCER_TICK_MS);
+
+    /**
+     * Adds an LED that is switched on and off. Blinking of the LED is stopped
+     * @param led the LED
+     * @return the index of the LED, or -1 if no more LEDs can be added
+     */
+    int add(Led * led);
+
+    /**
+     * Adds an LED with brightness control
+     * @param pwm the PWM engine
+     * @param channel the channel of the LED
+     * @return the index of the LED, or -1 if no more LEDs can be added
+     */
+    int add(SoftPwm * pwm, int channel);
+
+    /**
+     * Plays a pattern on an LED, a pattern that is playing on the LED is replaced
+     * @param index the index of the LED
+     * @param pattern the pattern, must stay valid while it is playing. nullptr stops the LED like stop()
+     * @param argument the argument of the pattern, e.g. the number of blinks of LED_PATTERN_ERROR_CODE. Loops that
+     *                 use the argument play their steps at least once, so 0 is the same as 1
+     */
+    void play(int index, const led_pattern_t * pattern, uint8_t argument = 0);
+
+    /**
+     * Stops the pattern of an LED and switches it off
+     * @param index the index of the LED
+     */
+    void stop(int index);
+
+    /**
+     * Returns whether a pattern is playing on an LED
+     * @param index the index of the LED
+     * @return true when a pattern is playing, false if it finished or was stopped
+     */
+    bool isPlaying(int index) {return leds[index].pattern != nullptr;};
+
+    /**
+     * Gets the current level of an LED
+     * @param index the index of the LED
+     * @return the level (0 - 255) before gamma correction
+     */
+    uint8_t getLevel(int index) {return leds[index].level;};
+
+    /**
+     * Advances all patterns by one tick. Called by the ticker
+     */
+    void tick();
+
+    /**
+     * Gets the gamma corrected brightness of a level (LED_GAMMA)
+     * @param level the perceived level (0 - 255)
+     * @return the PWM brightness (0 - 255)
+     */
+    static uint8_t gamma(uint8_t level);
+private:
+    struct LedState {
+        const led_pattern_t * pattern;
+        Led * led;
+        SoftPwm * pwm;
+        uint16_t elapsedMs;
+        uint16_t loops;
+        uint8_t channel;
+        uint8_t step;
+        uint8_t repeats;
+        uint8_t argument;
+        uint8_t from;
+        uint8_t level;
+    };
+
+    Ticker ticker;
+    LedState leds[LED_SEQUENCER_MAX_LEDS];
+    uint32_t tickMs;
+    uint8_t numLeds;
+    bool running;
+
+    int addLed(Led * led, SoftPwm * pwm, int channel);
+    void enterStep(LedState * state, uint8_t next);
+    void write(LedState * state);
+};
+
+#endif
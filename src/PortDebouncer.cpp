@@ -0,0 +1,64 @@
+#include <PortDebouncer.h>
+
+PortDebouncer::PortDebouncer(PortName port, int mask, PinMode mode, uint32_t tickUs)
+    : port(port, mask), tickUs(tickUs), count0(0), count1(0) {
+    this->port.mode(mode);
+    state = this->port.read();
+    start();
+}
+
+void PortDebouncer::onChange(Callback<void(int pin, bool state)> handler) {
+    changeHandler = handler;
+}
+
+void PortDebouncer::onPortChange(Callback<void(uint32_t changed, uint32_t state)> handler) {
+    portChangeHandler = handler;
+}
+
+uint32_t PortDebouncer::read() {
+    return state;
+}
+
+int PortDebouncer::read(int pin) {
+    return (state >> pin) & 1;
+}
+
+void PortDebouncer::start() {
+    ticker.attach_us(callback(this, &PortDebouncer::onTick), tickUs);
+}
+
+void PortDebouncer::stop() {
+    ticker.detach();
+}
+
+uint32_t PortDebouncer::update(uint32_t sample) {
+    // bits that differ from the debounced state count up, all others are reset to 0
+    uint32_t delta = sample ^ state;
+    count1 = (count1 ^ count0) & delta;
+    count0 = ~count0 & delta;
+
+    // a bit toggles when its counter wraps around to 0 after 4 samples
+    uint32_t changed = delta & ~(count0 | count1);
+    state ^= changed;
+
+    return changed;
+}
+
+void PortDebouncer::onTick() {
+    uint32_t changed = update(port.read());
+
+    if (!changed) {
+        return;
+    }
+
+    if (portChangeHandler) {
+        portChangeHandler(changed, state);
+    }
+
+    if (changeHandler) {
+        for (uint32_t pins = changed; pins; pins &= pins - 1) {
+            int pin = __builtin_ctz(pins);
+            changeHandler(pin, (state >> pin) & 1);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_PORT_DEBOUNCER_H_
+#define _MBED_EXT_PORT_DEBOUNCER_H_
+
+#include <mbed.h>
+
+#define DEFAULT_PORT_DEBOUNCE_TICK_US 2500
+
+/**
+ * Debounces all pins of a port at once. Every tick the whole port is read with a single load and each bit
+ * is fed into a 2-bit vertical counter: the counters of all 32 bits are stored bit-sliced in two words, so
+ * they are updated in parallel with a few bitwise operations. A bit changes its debounced state after it
+ * differed from it for 4 consecutive samples, which makes the debounce time 4 * tickUs.
+ *
+ * @code
+ * PortDebouncer keys(PortA, 0x00FF, PullUp);
+ * keys.onChange([](int pin, bool state) {
+ *     // executed in an ISR for every pin that changed
+ * });
+ * @endcode
+ */
+class PortDebouncer
+{
+public:
+    /**
+     * Constructor. Sampling is started immediately
+     * @param port the port to read
+     * @param mask the pins of the port to debounce
+     * @param mode pull up / pull down mode for the pins
+     * @param tickUs the sample interval in us
+     */
+    PortDebouncer(PortName port, int mask = 0xFFFFFFFF, PinMode mode = PullNone, uint32_t tickUs = DEFAULT_PORT_DEBOUNCE_TICK_US);
+
+    /**
+     * Registers for debounced edges. The handler is called once for every pin that changed during a tick
+     * @param handler the function that is called with the pin number within the port and the new state. Note that this is executed in an ISR
+     */
+    void onChange(Callback<void(int pin, bool state)> handler);
+
+    /**
+     * Registers for debounced edges of the whole port. The handler is called once per tick in which pins changed
+     * @param handler the function that is called with the mask of the changed pins and the debounced port value. Note that this is executed in an ISR
+     */
+    void onPortChange(Callback<void(uint32_t changed, uint32_t state)> handler);
+
+    /**
+     * Reads the debounced port value
+     * @return the debounced value of all pins
+     */
+    uint32_t read();
+
+    /**
+     * Reads the debounced value of a pin
+     * @param pin the pin number within the port
+     * @return the debounced value of the pin
+     */
+    int read(int pin);
+
+    /**
+     * Starts sampling
+     */
+    void start();
+
+    /**
+     * Stops sampling, the debounced state is kept
+     */
+    void stop();
+
+    /**
+     * Feeds one sample into the vertical counters
+     * @param sample the raw port value
+     * @return the mask of the pins whose debounced state changed
+     */
+    uint32_t update(uint32_t sample);
+private:
+    PortIn port;
+    Ticker ticker;
+    Callback<void(int, bool)> changeHandler;
+    Callback<void(uint32_t, uint32_t)> portChangeHandler;
+    uint32_t tickUs;
+    volatile uint32_t state;
+    uint32_t count0;
+    uint32_t count1;
+
+    /* ISR handlers */
+    void onTick();
+};
+
+#endif
@@ -0,0 +1,340 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_REGISTER_MAP_H_
+#define _MBED_EXT_REGISTER_MAP_H_
+
+#include <mbed.h>
+#include <type_traits>
+#include <BitField.h>
+#include <I2CUtil.h>
+#include <I2CRegisterCache.h>
+#include <I2CScript.h>
+
+/**
+ * How a register may be accessed
+ */
+typedef enum register_access {
+    /* The register can be read and written */
+    REG_READ_WRITE,
+    /* Writes are not allowed, e.g. status or output registers */
+    REG_READ_ONLY,
+    /* Reads are not allowed, e.g. command registers. Bits that are not written are taken from the reset value */
+    REG_WRITE_ONLY
+}register_access_t;
+
+/**
+ * Declares an 8-bit register of a device. Devices are described by deriving a struct per register
+ * that also declares the fields of the register:
+ *
+ * @code
+ * struct CONFIG : RegisterDef<0x1A> {
+ *     typedef RegField<CONFIG, 0, 3> DLPF_CFG;
+ *     typedef RegField<CONFIG, 3, 3> EXT_SYNC_SET;
+ * };
+ * @endcode
+ */
+template<uint8_t Address, register_access_t Access = REG_READ_WRITE, uint8_t ResetValue = 0x00>
+struct RegisterDef {
+    typedef uint8_t value_type;
+
+    /**
+     * Address of the register
+     */
+    static constexpr uint8_t address = Address;
+
+    /**
+     * Access mode of the register
+     */
+    static constexpr register_access_t access = Access;
+
+    /**
+     * Value of the register after a reset of the device
+     */
+    static constexpr uint8_t resetValue = ResetValue;
+
+    /**
+     * Whether the register may be read
+     */
+    static constexpr bool readable = Access != REG_WRITE_ONLY;
+
+    /**
+     * Whether the register may be written
+     */
+    static constexpr bool writable = Access != REG_READ_ONLY;
+};
+
+/**
+ * Field values that belong to register Reg. Values of different registers cannot be combined
+ */
+template<typename Reg>
+struct RegisterValue : FieldValue<uint8_t> {
+    typedef Reg register_type;
+
+    /**
+     * Constructor
+     * @param mask the bits that are modified
+     * @param bits the new values of the modified bits
+     */
+    constexpr RegisterValue(uint8_t mask, uint8_t bits) : FieldValue<uint8_t>(mask, bits) {}
+
+    /**
+     * Combines two field values of the same register. If both modify the same bits, the right hand side wins
+     * @param other the field values to add
+     * @return the combined field values
+     */
+    template<typename OtherReg>
+    constexpr RegisterValue operator|(RegisterValue<OtherReg> other) const {
+        static_assert(std::is_same<Reg, OtherReg>::value, "fields of different registers cannot be combined");
+        return RegisterValue(static_cast<uint8_t>(mask | other.mask), static_cast<uint8_t>((bits & ~other.mask) | other.bits));
+    }
+
+    /**
+     * Gets the value written to the register if its current value is not known, i.e. the uncovered bits are taken from the reset value
+     * @return the register value
+     */
+    constexpr uint8_t fromReset() const {
+        return apply(Reg::resetValue);
+    }
+};
+
+/**
+ * Declares a field of Width bits starting at bit Offset of register Reg. Fields are BitFields, so they can
+ * also be grouped with Register to check that they do not overlap.
+ */
+template<typename Reg, uint8_t Offset, uint8_t Width = 1>
+struct RegField : BitField<Offset, Width, uint8_t> {
+    typedef Reg register_type;
+
+    /**
+     * Creates a field value that can be combined with other field values of the same register
+     * @param value the new field value. Bits that do not fit into the field are discarded
+     * @return the field value
+     */
+    static constexpr RegisterValue<Reg> of(uint8_t value) {
+        return RegisterValue<Reg>(BitField<Offset, Width, uint8_t>::mask, static_cast<uint8_t>(value << Offset));
+    }
+};
+
+/**
+ * Gets whether R is a field (true) or a whole register (false)
+ */
+template<typename R, typename = void>
+struct IsRegisterField : std::false_type {};
+
+template<typename R>
+struct IsRegisterField<R, std::void_t<typename R::register_type>> : std::true_type {};
+
+/**
+ * Gets whether the backend B of a RegisterMap knows register values without accessing the bus, i.e. has
+ * bool getKnownValue(uint8_t registerAddress, uint8_t * value) like I2CRegisterCache
+ */
+template<typename B, typename = void>
+struct HasKnownValues : std::false_type {};
+
+template<typename B>
+struct HasKnownValues<B, std::void_t<decltype(std::declval<B &>().getKnownValue(uint8_t(), (uint8_t *)nullptr))>> : std::true_type {};
+
+/**
+ * Register access of a device using I2CUtil, without caching
+ */
+class I2CRegisterIO
+{
+public:
+    /**
+     * Constructor
+     * @param i2c the I2C bus the device is connected to
+     * @param slaveAddress the 7-bit address of the device
+     */
+    I2CRegisterIO(I2C * i2c, uint8_t slaveAddress) : i2c(i2c), slaveAddress(slaveAddress) {};
+
+    /**
+     * Reads a single register
+     * @param registerAddress the address of the register to read
+     * @param data pointer to the location the read byte is stored
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code readByte(uint8_t registerAddress, uint8_t * data) {
+        return I2CUtil::readByte(i2c, slaveAddress, registerAddress, data);
+    };
+
+    /**
+     * Reads multiple consecutive registers
+     * @param registerAddress the address of the first register to read
+     * @param data pointer to the location the read bytes are stored
+     * @param numBytes the number of bytes to read
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code readBytes(uint8_t registerAddress, uint8_t * data, size_t numBytes) {
+        return I2CUtil::readBytes(i2c, slaveAddress, registerAddress, data, numBytes);
+    };
+
+    /**
+     * Writes a single register
+     * @param registerAddress the address of the register to write
+     * @param data the byte to write
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code writeByte(uint8_t registerAddress, uint8_t data) {
+        return I2CUtil::writeByte(i2c, slaveAddress, registerAddress, data);
+    };
+
+    /**
+     * Writes multiple consecutive registers
+     * @param registerAddress the address of the first register to write
+     * @param data the data to write
+     * @param numBytes the number of bytes to write
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code writeBytes(uint8_t registerAddress, const uint8_t * data, size_t numBytes) {
+        return I2CUtil::writeBytes(i2c, slaveAddress, registerAddress, data, numBytes);
+    };
+
+    /**
+     * Applies field values to a register in a single read-modify-write. The read is skipped if all bits are replaced
+     * @param registerAddress the address of the register to write
+     * @param values the field values, see BitField
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    i2c_return_code modify(uint8_t registerAddress, FieldValue<uint8_t> values) {
+        uint8_t byte = 0;
+
+        if (values.mask != 0xFF && readByte(registerAddress, &byte) != I2C_OK) {
+            return I2C_ERROR;
+        }
+
+        return writeByte(registerAddress, values.apply(byte));
+    };
+private:
+    I2C * i2c;
+    uint8_t slaveAddress;
+};
+
+/**
+ * Typed access to the registers of a device declared with RegisterDef and RegField. Addresses, masks and shifts
+ * are resolved at compile time and access modes are checked at compile time. Field values of the same register that
+ * are combined with | are written in a single read-modify-write.
+ *
+ * The backend performs the byte access and its methods stay available: I2CRegisterIO accesses the device
+ * directly, I2CRegisterCache<> adds the shadow cache, so e.g. flush() can be called on the map.
+ *
+ * @code
+ * RegisterMap<I2CRegisterCache<>> mpu(&i2c, MPU6050_ADDRESS, WRITE_BACK);
+ * mpu.write(CONFIG::DLPF_CFG::of(3) | CONFIG::EXT_SYNC_SET::of(0));
+ * mpu.read<WHO_AM_I>(&id);
+ * mpu.flush();
+ * @endcode
+ */
+template<typename Backend = I2CRegisterIO>
+class RegisterMap : public Backend
+{
+public:
+    using Backend::Backend;
+
+    /**
+     * Reads a register or a single field
+     * @param value pointer to the location the register value or field value is stored
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    template<typename R>
+    i2c_return_code read(uint8_t * value) {
+        if constexpr (IsRegisterField<R>::value) {
+            typedef typename R::register_type Reg;
+            static_assert(Reg::readable, "the register is write-only");
+
+            uint8_t byte;
+            if (this->readByte(Reg::address, &byte) != I2C_OK) {
+                return I2C_ERROR;
+            }
+
+            *value = R::get(byte);
+            return I2C_OK;
+        } else {
+            static_assert(R::readable, "the register is write-only");
+            return this->readByte(R::address, value);
+        }
+    };
+
+    /**
+     * Writes a whole register
+     * @param value the new register value
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    template<typename Reg>
+    i2c_return_code write(uint8_t value) {
+        static_assert(!IsRegisterField<Reg>::value, "use Field::of() to write a single field");
+        static_assert(Reg::writable, "the register is read-only");
+        return this->writeByte(Reg::address, value);
+    };
+
+    /**
+     * Writes fields of a register. The register is only read if it is readable and not all bits are written,
+     * fields that are not written keep their value. For write-only registers they keep the value known to the
+     * backend (e.g. a cacheable register of I2CRegisterCache), otherwise they are set to the reset value
+     * @param values the field values, combined with the | operator
+     * @return I2C_OK when the operation was successfull, I2C_ERROR otherwise
+     */
+    template<typename Reg>
+    i2c_return_code write(RegisterValue<Reg> values) {
+        static_assert(Reg::writable, "the register is read-only");
+
+        if (!Reg::readable || values.mask == 0xFF) {
+            if constexpr (HasKnownValues<Backend>::value) {
+                uint8_t known;
+                if (values.mask != 0xFF && this->getKnownValue(Reg::address, &known)) {
+                    return this->writeByte(Reg::address, values.apply(known));
+                }
+            }
+            return this->writeByte(Reg::address, values.fromReset());
+        }
+
+        return this->modify(Reg::address, values);
+    };
+};
+
+/**
+ * Creates a script operation that writes a whole register, see I2CScript
+ * @param value the value to write
+ * @return the operation
+ */
+template<typename Reg>
+constexpr i2c_script_op_t scriptWrite(uint8_t value) {
+    static_assert(!IsRegisterField<Reg>::value, "use scriptModify(Field::of()) to write a single field");
+    static_assert(Reg::writable, "the register is read-only");
+    return scriptWrite(Reg::address, value);
+}
+
+/**
+ * Creates a script operation that writes fields of a register, see I2CScript. Fields of write-only
+ * registers that are not written are set to the reset value
+ * @param values the field values, combined with the | operator
+ * @return the operation
+ */
+template<typename Reg>
+constexpr i2c_script_op_t scriptModify(RegisterValue<Reg> values) {
+    static_assert(Reg::writable, "the register is read-only");
+    return Reg::readable ? scriptModify(Reg::address, values) : scriptWrite(Reg::address, values.fromReset());
+}
+
+#endif
@@ -0,0 +1,160 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_RING_BUFFER_H_
+#define _MBED_EXT_RING_BUFFER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+template<typename T>
+/**
+ * A lock-free FIFO for exactly one producer and one consumer, e.g. an interrupt handler and the main loop.
+ * The elements are copied into a fixed storage whose capacity is a power of two, nothing is allocated.
+ * Only aligned loads and stores of the indices are used, so it also works on cores without atomic
+ * read-modify-write instructions.
+ */
+class RingBuffer {
+public:
+    /**
+     * Constructor
+     * @param storage the storage of the elements
+     * @param capacity the number of elements of the storage, must be a power of two
+     */
+    RingBuffer(T * storage, size_t capacity) : storage(storage), mask(capacity - 1), head(0), tail(0) {};
+
+    /**
+     * Appends an element. Must only be called by the producer
+     * @param elem the element to append
+     * @return true if the element was appended, false if the buffer is full
+     */
+    bool push(const T & elem) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+
+        storage[t & mask] = elem;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    };
+
+    /**
+     * Removes the oldest element. Must only be called by the consumer
+     * @param elem pointer to the location the element is copied to
+     * @return true if an element was removed, false if the buffer is empty
+     */
+    bool pop(T * elem) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        *elem = storage[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    };
+
+    /**
+     * Removes up to count of the oldest elements at once. Must only be called by the consumer
+     * @param elems pointer to the location the elements are copied to
+     * @param count the maximum number of elements to remove
+     * @return the number of removed elements
+     */
+    size_t pop(T * elems, size_t count) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t available = tail.load(std::memory_order_acquire) - h;
+        if (count > available) {
+            count = available;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            elems[i] = storage[(h + i) & mask];
+        }
+        head.store(h + count, std::memory_order_release);
+        return count;
+    };
+
+    /**
+     * Gets the oldest element without removing it. Must only be called by the consumer
+     * @return pointer to the element or nullptr if the buffer is empty
+     */
+    const T * peek() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        return h == tail.load(std::memory_order_acquire) ? nullptr : &storage[h & mask];
+    };
+
+    /**
+     * Removes all elements. Must only be called by the consumer
+     */
+    void clear() {head.store(tail.load(std::memory_order_acquire), std::memory_order_release);};
+
+    /**
+     * Gets the number of elements
+     * @return the number of elements in the buffer
+     */
+    size_t size() {return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);};
+
+    /**
+     * Gets whether the buffer is empty
+     * @return true if there are no elements
+     */
+    bool isEmpty() {return size() == 0;};
+
+    /**
+     * Gets whether the buffer is full
+     * @return true if no element can be appended
+     */
+    bool isFull() {return size() > mask;};
+
+    /**
+     * Gets the maximum number of elements
+     * @return the capacity
+     */
+    size_t getCapacity() {return mask + 1;};
+private:
+    T * storage;
+    uint32_t mask;
+    // free running indices, the difference is the number of elements
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+};
+
+template<typename T, size_t N>
+/**
+ * A RingBuffer that contains its storage
+ */
+class StaticRingBuffer : public RingBuffer<T> {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "the capacity must be a power of two");
+public:
+    /**
+     * Constructor
+     */
+    StaticRingBuffer() : RingBuffer<T>(elements, N) {};
+private:
+    T elements[N];
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include <SoftPwm.h>
+
+SoftPwm::SoftPwm(uint32_t unitUs) : unitUs(unitUs), deadline(0), dirty(false), slot(0), numPorts(0), numChannels(0), running(false) {
+    memset(planes, 0, sizeof(planes));
+    memset(activePlanes, 0, sizeof(activePlanes));
+}
+
+int SoftPwm::add(PortName port, uint8_t pin, uint8_t brightness) {
+    if (numChannels >= SOFT_PWM_MAX_CHANNELS || pin >= 32) {
+        return -1;
+    }
+
+    uint8_t p = 0;
+    while (p < numPorts && portNames[p] != port) {
+        p++;
+    }
+    if (p == numPorts) {
+        if (numPorts >= SOFT_PWM_MAX_PORTS) {
+            return -1;
+        }
+        portNames[p] = port;
+        portMasks[p] = 0;
+        numPorts++;
+    }
+
+    core_util_critical_section_enter();
+    portMasks[p] |= 1UL << pin;
+    port_init(&ports[p], port, portMasks[p], PIN_OUTPUT);
+    core_util_critical_section_exit();
+
+    Channel * channel = &channels[numChannels];
+    channel->port = p;
+    channel->pin = pin;
+    channel->brightness = 0;
+    setBrightness(numChannels, brightness);
+
+    if (!running) {
+        start();
+    }
+
+    return numChannels++;
+}
+
+void SoftPwm::setBrightness(int channel, uint8_t brightness) {
+    Channel * c = &channels[channel];
+    uint32_t * portPlanes = planes[c->port];
+    uint32_t bit = 1UL << c->pin;
+
+    core_util_critical_section_enter();
+    for (uint8_t b = 0; b < SOFT_PWM_BITS; b++) {
+        if (brightness & (1 << b)) {
+            portPlanes[b] |= bit;
+        }else{
+            portPlanes[b] &= ~bit;
+        }
+    }
+    c->brightness = brightness;
+    dirty = true;
+    core_util_critical_section_exit();
+}
+
+void SoftPwm::start() {
+    running = true;
+    slot = 0;
+    deadline = us_ticker_read();
+    onSlot();
+}
+
+void SoftPwm::stop() {
+    slotTimeout.detach();
+    running = false;
+
+    for (uint8_t p = 0; p < numPorts; p++) {
+        port_write(&ports[p], 0);
+    }
+}
+
+void SoftPwm::onSlot() {
+    if (slot == 0 && dirty) {
+        // apply new brightness values between two frames
+        memcpy(activePlanes, planes, numPorts * sizeof(planes[0]));
+        dirty = false;
+    }
+
+    for (uint8_t p = 0; p < numPorts; p++) {
+        port_write(&ports[p], activePlanes[p][slot]);
+    }
+
+    // slot b lasts 2^b units from its deadline, not from now, so the interrupt latency doesn't add up
+    deadline += unitUs << slot;
+    int32_t delay = (int32_t)(deadline - us_ticker_read());
+    slotTimeout.attach_us(callback(this, &SoftPwm::onSlot), delay > 0 ? delay : 0);
+    slot = (slot + 1) & (SOFT_PWM_BITS - 1);
+}
@@ -0,0 +1,145 @@
+/*
+MIT License
+
+Copyright (c) 2020 Steffen S.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef _MBED_EXT_SOFT_PWM_H_
+#define _MBED_EXT_SOFT_PWM_H_
+
+#include <mbed.h>
+
+#define DEFAULT_SOFT_PWM_UNIT_US 10
+#define SOFT_PWM_BITS 8
+
+#ifndef SOFT_PWM_MAX_PORTS
+#define SOFT_PWM_MAX_PORTS 4
+#endif
+
+#ifndef SOFT_PWM_MAX_CHANNELS
+#define SOFT_PWM_MAX_CHANNELS 32
+#endif
+
+/**
+ * Software PWM for many outputs, e.g. LEDs, with 8-bit brightness per channel. It uses binary code
+ * modulation: a frame consists of 8 slots with the lengths 1, 2, 4, ... 128 units, and in slot b every
+ * channel is on if bit b of its brightness is set. The channels of a port are precomputed into one
+ * value per slot, so a slot is a single write per port. The interrupt load is 8 interrupts per frame
+ * and one port write per port and slot, no matter how many channels there are.
+ *
+ * Brightness changes are applied at the start of the next frame, so a frame never mixes two values.
+ *
+ * The slots are scheduled from absolute deadlines that are counted from the start of the frame, so the
+ * interrupt latency delays every slot by the same time and neither shortens nor lengthens the slots or the
+ * frame. The unit has to be longer than the interrupt latency plus the time of the slot ISR (a few us on a
+ * Cortex-M), a slot that starts too late is shortened and the frame keeps its length.
+ *
+ * @code
+ * SoftPwm pwm;
+ * int red = pwm.add(PortA, 5);
+ * int green = pwm.add(PortA, 6);
+ * pwm.setBrightness(red, 128);
+ * @endcode
+ */
+class SoftPwm
+{
+public:
+    /**
+     * Constructor
+     * @param unitUs the length of the shortest slot in us, a frame is 255 units long. Must be longer than the interrupt latency plus the slot ISR
+     */
+    SoftPwm(uint32_t unitUs = DEFAULT_SOFT_PWM_UNIT_US);
+
+    /**
+     * Adds a channel. The PWM is started with the first channel. The other pins of the port must not be
+     * written while the PWM is running, since the port is written as a whole
+     * @param port the port of the output
+     * @param pin the number of the pin within the port
+     * @param brightness the initial brightness
+     * @return the channel, or -1 if no more channels or ports can be added
+     */
+    int add(PortName port, uint8_t pin, uint8_t brightness = 0);
+
+    /**
+     * Sets the brightness of a channel
+     * @param channel the channel
+     * @param brightness the brightness, 0 is off and 255 is on
+     */
+    void setBrightness(int channel, uint8_t brightness);
+
+    /**
+     * Gets the brightness of a channel
+     * @param channel the channel
+     * @return the brightness
+     */
+    uint8_t getBrightness(int channel) {return channels[channel].brightness;};
+
+    /**
+     * Gets the number of channels
+     * @return the number of added channels
+     */
+    int size() {return numChannels;};
+
+    /**
+     * Gets the length of a frame
+     * @return the length of a frame in us
+     */
+    uint32_t getFrameUs() {return unitUs * ((1 << SOFT_PWM_BITS) - 1);};
+
+    /**
+     * Starts the PWM
+     */
+    void start();
+
+    /**
+     * Stops the PWM and switches all channels off. The brightness values are kept
+     */
+    void stop();
+private:
+    struct Channel {
+        uint8_t port;
+        uint8_t pin;
+        uint8_t brightness;
+    };
+
+    Timeout slotTimeout;
+    port_t ports[SOFT_PWM_MAX_PORTS];
+    PortName portNames[SOFT_PWM_MAX_PORTS];
+    uint32_t portMasks[SOFT_PWM_MAX_PORTS];
+    /* port values of the slots, written by setBrightness */
+    uint32_t planes[SOFT_PWM_MAX_PORTS][SOFT_PWM_BITS];
+    /* port values of the slots of the current frame */
+    uint32_t activePlanes[SOFT_PWM_MAX_PORTS][SOFT_PWM_BITS];
+    Channel channels[SOFT_PWM_MAX_CHANNELS];
+    uint32_t unitUs;
+    /* us_ticker_read() time at which the next slot starts */
+    uint32_t deadline;
+    volatile bool dirty;
+    uint8_t slot;
+    uint8_t numPorts;
+    uint8_t numChannels;
+    bool running;
+
+    /* ISR handlers */
+    void onSlot();
+};
+
+#endif
@@ -28,6 +28,7 @@ SOFTWARE.
 #include <mbed.h>
 #include <Vector.h>
 #include <Bytes.h>
+#include <BitField.h>
 #include <ExtMacros.h>
 #include <IsrUtil.h>
 